@@ -0,0 +1,88 @@
+#ifndef DETECTEDFILESMODEL_H
+#define DETECTEDFILESMODEL_H
+
+#include <QAbstractTableModel>
+#include <QSortFilterProxyModel>
+#include <QBitArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include "ExecSearchIndex.h"
+
+// One detected file as shown in the Executable Monitor table.
+struct ExecFileRow {
+    int id = 0;
+    qint64 seq = 0; // backend change counter; higher is newer
+    QString name;
+    QString path;
+    QString status; // Safe / Suspicious / Error / Analyzing
+    QString when;
+    bool cached = false; // verdict reused from an earlier copy of the same content
+    bool allowlisted = false; // known-good hash, not analysed
+    bool summary = false; // listed from history without the bulky details
+    QJsonObject record; // backend record for the details panel
+    QString searchKey;  // folded name, path, extension and SHA-256
+
+    // Pure data conversion; safe to run on a worker thread.
+    static ExecFileRow fromRecord(const QJsonObject &obj);
+    static QString statusForType(const QString &type); // backend "type" -> status column
+    void updateSearchKey();
+};
+
+// Table model backing the detected-files view. Rows are keyed by backend id
+// so an update touches only the rows that changed; the view only asks for
+// the cells it is painting. A summary never replaces a full record of the
+// same or a later change, so an older page cannot undo a streamed update.
+// Rows are kept newest first (by id) as they are inserted, so the view
+// needs no sorting proxy: files live in stable slots, in arrival order,
+// and a row -> slot list gives the display order.
+class DetectedFilesModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    enum Column { NameColumn, StatusColumn, WhenColumn, ColumnCount };
+    enum Role { FileIdRole = Qt::UserRole + 1 };
+
+    explicit DetectedFilesModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void upsertRows(const QList<ExecFileRow> &rows);
+    void clear();
+    const ExecFileRow *fileById(int id) const;
+    int slotAt(int row) const { return order.at(row); }
+    const ExecSearchIndex &searchIndex() const { return textIndex; } // keyed by slot
+
+private:
+    int rowOfId(int id) const; // row holding id, or where it would be inserted
+
+    QList<ExecFileRow> files; // by slot
+    QList<int> order;         // row -> slot, ids descending
+    QHash<int, int> slotById;
+    ExecSearchIndex textIndex;
+};
+
+// Filter proxy that answers queries from the model's search index. A new
+// query is resolved to a slot bitmap once; rows inserted or changed later
+// are checked individually against the same query.
+class DetectedFilesFilter : public QSortFilterProxyModel {
+    Q_OBJECT
+public:
+    explicit DetectedFilesFilter(QObject *parent = nullptr);
+
+    void setFilesModel(DetectedFilesModel *model);
+    void setQuery(const QString &text);
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    DetectedFilesModel *filesModel;
+    QString foldedQuery;
+    QBitArray bulkMatches; // by slot; only valid while a new query is being applied
+};
+
+#endif // DETECTEDFILESMODEL_H
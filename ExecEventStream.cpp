@@ -0,0 +1,253 @@
+#include "ExecEventStream.h"
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+#include <QUrlQuery>
+
+namespace {
+const int kInitialRetryMs = 500;
+const int kMaxRetryMs = 10000;
+}
+
+ExecEventStream::ExecEventStream(const QUrl &baseUrl, QObject *parent)
+    : QObject(parent), manager(new QNetworkAccessManager(this)), snapshotReply(nullptr), pageReply(nullptr),
+      reply(nullptr), reconnectTimer(new QTimer(this)), baseUrl(baseUrl), active(false),
+      retryDelayMs(kInitialRetryMs)
+{
+    reconnectTimer->setSingleShot(true);
+    connect(reconnectTimer, &QTimer::timeout, this, &ExecEventStream::connectFeed);
+}
+
+void ExecEventStream::start() {
+    if (active) return;
+    active = true;
+    retryDelayMs = kInitialRetryMs;
+    connectFeed();
+}
+
+void ExecEventStream::stop() {
+    active = false;
+    reconnectTimer->stop();
+    // finished() fires synchronously and cleans up
+    if (snapshotReply) snapshotReply->abort();
+    if (pageReply) pageReply->abort();
+    if (reply) reply->abort();
+}
+
+void ExecEventStream::connectFeed() {
+    if (!active || snapshotReply || reply) return;
+
+    const qsizetype colon = lastEventId.indexOf(':');
+    if (colon <= 0) {
+        // Nothing to resume: start from the newest page of history
+        snapshotReply = requestPage(QByteArray());
+        connect(snapshotReply, &QNetworkReply::finished, this, &ExecEventStream::onSnapshotFinished);
+        return;
+    }
+
+    // Catch up in one compact request instead of replaying event by event
+    QUrl url = baseUrl.resolved(QUrl("/api/files"));
+    QUrlQuery query;
+    query.addQueryItem("epoch", QString::fromLatin1(lastEventId.left(colon)));
+    query.addQueryItem("since", QString::fromLatin1(lastEventId.mid(colon + 1)));
+    query.addQueryItem("limit", QString::number(kCatchUpLimit));
+    url.setQuery(query);
+
+    QNetworkRequest req(url);
+    req.setRawHeader("Accept", "application/cbor, application/json;q=0.9");
+    req.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+    snapshotReply = manager->get(req);
+    connect(snapshotReply, &QNetworkReply::finished, this, &ExecEventStream::onSnapshotFinished);
+}
+
+void ExecEventStream::onSnapshotFinished() {
+    QNetworkReply *finished = snapshotReply;
+    snapshotReply = nullptr;
+    if (!finished) return;
+    finished->deleteLater();
+    if (!active) return;
+    if (finished->error() != QNetworkReply::NoError) {
+        scheduleReconnect();
+        return;
+    }
+
+    if (finished->rawHeader("X-Feed-Reset") == "1") {
+        // Restarted backend, or too far behind: drop everything and load
+        // the first page again
+        emit resetRequested();
+        lastEventId.clear();
+        nextPage.clear();
+        connectFeed();
+        return;
+    }
+
+    // Feed position travels in headers so the CBOR body can be a bare array
+    const QByteArray epoch = finished->rawHeader("X-Feed-Epoch");
+    const QByteArray cursor = finished->rawHeader("X-Feed-Cursor");
+    const bool cbor = finished->header(QNetworkRequest::ContentTypeHeader).toString()
+                          .startsWith("application/cbor");
+    if (finished->hasRawHeader("X-Page-Next")) nextPage = finished->rawHeader("X-Page-Next");
+    emit snapshotReceived(finished->readAll(), cbor);
+    if (!epoch.isEmpty() && !cursor.isEmpty()) lastEventId = epoch + ':' + cursor;
+
+    openStream();
+}
+
+QNetworkReply *ExecEventStream::requestPage(const QByteArray &cursor) {
+    QUrl url = baseUrl.resolved(QUrl("/api/files/page"));
+    QUrlQuery query;
+    query.addQueryItem("limit", QString::number(kPageSize));
+    if (!cursor.isEmpty()) query.addQueryItem("cursor", QString::fromLatin1(cursor));
+    url.setQuery(query);
+
+    QNetworkRequest req(url);
+    req.setRawHeader("Accept", "application/cbor, application/json;q=0.9");
+    req.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+    return manager->get(req);
+}
+
+void ExecEventStream::loadMore() {
+    if (!active || nextPage.isEmpty() || pageReply || snapshotReply) return;
+    pageReply = requestPage(nextPage);
+    connect(pageReply, &QNetworkReply::finished, this, &ExecEventStream::onPageFinished);
+}
+
+void ExecEventStream::reloadFirstPage() {
+    // The stream stays open and keeps the page current
+    if (pageReply) pageReply->abort();
+    nextPage.clear();
+    pageReply = requestPage(QByteArray());
+    connect(pageReply, &QNetworkReply::finished, this, &ExecEventStream::onPageFinished);
+}
+
+void ExecEventStream::onPageFinished() {
+    QNetworkReply *finished = pageReply;
+    pageReply = nullptr;
+    if (!finished) return;
+    finished->deleteLater();
+    // A failed page is asked for again on the next scroll
+    if (!active || finished->error() != QNetworkReply::NoError) return;
+    nextPage = finished->rawHeader("X-Page-Next");
+    emit snapshotReceived(finished->readAll(),
+                          finished->header(QNetworkRequest::ContentTypeHeader).toString().startsWith("application/cbor"));
+}
+
+void ExecEventStream::fetchRecord(int id) {
+    QNetworkRequest req(baseUrl.resolved(QUrl(QStringLiteral("/api/files/%1").arg(id))));
+    req.setRawHeader("Accept", "application/json");
+    req.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+    QNetworkReply *recordReply = manager->get(req);
+    connect(recordReply, &QNetworkReply::finished, this, [this, recordReply]() {
+        recordReply->deleteLater();
+        if (recordReply->error() != QNetworkReply::NoError) return;
+        const QJsonObject record = QJsonDocument::fromJson(recordReply->readAll()).object();
+        if (!record.isEmpty()) emit recordReceived(record);
+    });
+}
+
+void ExecEventStream::openStream() {
+    if (!active || reply) return;
+    // With limit, a reset replays nothing; the first page is loaded instead
+    QUrl url = baseUrl.resolved(QUrl("/api/events"));
+    url.setQuery(QStringLiteral("limit=%1").arg(kCatchUpLimit));
+    QNetworkRequest req(url);
+    req.setRawHeader("Accept", "text/event-stream");
+    req.setRawHeader("Cache-Control", "no-cache");
+    req.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+    // Resume where we left off; the server replays everything after this id
+    if (!lastEventId.isEmpty()) req.setRawHeader("Last-Event-ID", lastEventId);
+
+    buffer.clear();
+    eventName.clear();
+    eventData.clear();
+    pendingId.clear();
+
+    reply = manager->get(req);
+    connect(reply, &QNetworkReply::readyRead, this, &ExecEventStream::onReadyRead);
+    connect(reply, &QNetworkReply::finished, this, &ExecEventStream::onFinished);
+}
+
+void ExecEventStream::scheduleReconnect() {
+    reconnectTimer->start(retryDelayMs);
+    retryDelayMs = qMin(retryDelayMs * 2, kMaxRetryMs);
+}
+
+void ExecEventStream::onReadyRead() {
+    if (!reply) return;
+    buffer.append(reply->readAll());
+    qsizetype start = 0;
+    qsizetype nl;
+    while ((nl = buffer.indexOf('\n', start)) >= 0) {
+        QByteArray line = buffer.mid(start, nl - start);
+        if (line.endsWith('\r')) line.chop(1);
+        handleLine(line);
+        start = nl + 1;
+    }
+    buffer.remove(0, start);
+
+    // Hand everything parsed from this read over as a single batch
+    if (!batch.isEmpty()) {
+        const QList<QByteArray> payloads = batch;
+        batch.clear();
+        emit fileEventsReceived(payloads);
+    }
+}
+
+void ExecEventStream::onFinished() {
+    QNetworkReply *finished = reply;
+    reply = nullptr;
+    if (finished) finished->deleteLater();
+    if (active) scheduleReconnect();
+}
+
+void ExecEventStream::handleLine(const QByteArray &line) {
+    if (line.isEmpty()) {
+        dispatchEvent();
+        return;
+    }
+    if (line.startsWith(':')) return; // keepalive comment
+
+    const qsizetype colon = line.indexOf(':');
+    const QByteArray field = colon < 0 ? line : line.left(colon);
+    QByteArray value = colon < 0 ? QByteArray() : line.mid(colon + 1);
+    if (value.startsWith(' ')) value.remove(0, 1);
+
+    if (field == "event") eventName = value;
+    else if (field == "data") eventData.append(value).append('\n');
+    else if (field == "id") pendingId = value;
+}
+
+void ExecEventStream::dispatchEvent() {
+    if (!pendingId.isEmpty()) lastEventId = pendingId;
+    const QByteArray name = eventName.isEmpty() ? QByteArray("message") : eventName;
+    QByteArray data = eventData;
+    data.chop(1); // trailing newline added per data line
+    eventName.clear();
+    eventData.clear();
+    pendingId.clear();
+
+    if (name == "hello") {
+        // Tiny control message; fine to parse here
+        retryDelayMs = kInitialRetryMs;
+        if (QJsonDocument::fromJson(data).object().value("reset").toBool()) {
+            if (!batch.isEmpty()) {
+                const QList<QByteArray> payloads = batch;
+                batch.clear();
+                emit fileEventsReceived(payloads);
+            }
+            emit resetRequested();
+            reloadFirstPage();
+        }
+    } else if (name == "file" && !data.isEmpty()) {
+        batch.append(data);
+    } else if (name == "queue") {
+        const QJsonObject depth = QJsonDocument::fromJson(data).object();
+        emit queueDepthChanged(depth.value("queued").toInt(), depth.value("active").toInt());
+    } else if (name == "analysis") {
+        const QJsonObject partial = QJsonDocument::fromJson(data).object();
+        emit analysisTextReceived(partial.value("id").toInt(), partial.value("text").toString());
+    }
+}
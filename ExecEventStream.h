@@ -0,0 +1,86 @@
+#ifndef EXECEVENTSTREAM_H
+#define EXECEVENTSTREAM_H
+
+#include <QObject>
+#include <QUrl>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QList>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
+
+// Server-Sent Events client for the file watcher's /api/events feed.
+// The first connect loads the newest page of history (/api/files/page,
+// summaries in compact CBOR); older pages follow on loadMore(). Reconnects
+// back off and catch up through /api/files?since=... from the last cursor,
+// so no file updates are lost across drops, then keep one long-lived GET
+// open on the event stream. When the gap is too large to catch up, or the
+// backend restarted, the client starts over from the first page.
+class ExecEventStream : public QObject {
+    Q_OBJECT
+public:
+    // baseUrl is the backend root, e.g. http://127.0.0.1:8000
+    explicit ExecEventStream(const QUrl &baseUrl, QObject *parent = nullptr);
+
+    static const int kPageSize = 200;
+    static const int kCatchUpLimit = 1000; // changes replayed on reconnect before starting over
+
+    void start();
+    void stop();
+    bool isActive() const { return active; }
+    void loadMore(); // next page of older history; no-op while one is loading or none is left
+    bool hasMore() const { return !nextPage.isEmpty(); }
+    void fetchRecord(int id); // full record, e.g. for a row listed as a summary
+
+signals:
+    void resetRequested(); // server could not resume us; drop cached records
+    // Raw JSON of the file records in one network read; decoding is left to
+    // the receiver so it can happen off the GUI thread.
+    void fileEventsReceived(const QList<QByteArray> &payloads);
+    // Catch-up body from /api/files?since=... or a page of history; CBOR
+    // array or JSON envelope
+    void snapshotReceived(const QByteArray &body, bool cbor);
+    void recordReceived(const QJsonObject &record);
+    // Files waiting for analysis and files being analysed right now
+    void queueDepthChanged(int queued, int active);
+    // Gemini's answer for a file so far, while it is being written; the
+    // final text arrives with the file's record
+    void analysisTextReceived(int fileId, const QString &text);
+
+private slots:
+    void onSnapshotFinished();
+    void onPageFinished();
+    void onReadyRead();
+    void onFinished();
+
+private:
+    void connectFeed();
+    QNetworkReply *requestPage(const QByteArray &cursor);
+    void reloadFirstPage();
+    void openStream();
+    void scheduleReconnect();
+    void handleLine(const QByteArray &line);
+    void dispatchEvent();
+
+    QNetworkAccessManager *manager;
+    QNetworkReply *snapshotReply; // catch-up or first page, before the stream opens
+    QNetworkReply *pageReply;     // a page loaded while the stream is open
+    QNetworkReply *reply;
+    QTimer *reconnectTimer;
+    QUrl baseUrl;
+    bool active;
+    int retryDelayMs;
+    QByteArray nextPage; // cursor of the next older page; empty when none is left
+
+    // SSE parser state
+    QByteArray buffer;
+    QByteArray eventName;
+    QByteArray eventData;
+    QByteArray pendingId;
+    QByteArray lastEventId; // "<epoch>:<seq>" of the last merged record
+    QList<QByteArray> batch;
+};
+
+#endif // EXECEVENTSTREAM_H
@@ -0,0 +1,154 @@
+#include "ExecFeedCodec.h"
+#include "ExecFeedKeys.h"
+#include <QCborStreamReader>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+static bool readerOk(const QCborStreamReader &r) {
+    return r.lastError() == QCborError::NoError;
+}
+
+// Map keys are either an index into ExecFeedKeys::kNames or a plain string
+static QString readKey(QCborStreamReader &r, int *keyId) {
+    *keyId = -1;
+    if (r.isInteger()) {
+        const qint64 id = r.toInteger();
+        r.next();
+        if (id >= 0 && id < ExecFeedKeys::kCount) {
+            *keyId = int(id);
+            return QString::fromLatin1(ExecFeedKeys::kNames[id]);
+        }
+        return QString::number(id);
+    }
+    if (r.isString()) return r.readAllString();
+    r.next();
+    return QString();
+}
+
+static QJsonValue readValue(QCborStreamReader &r) {
+    switch (r.type()) {
+    case QCborStreamReader::UnsignedInteger:
+    case QCborStreamReader::NegativeInteger: {
+        const qint64 v = r.toInteger();
+        r.next();
+        return QJsonValue(v);
+    }
+    case QCborStreamReader::Float16: {
+        const double v = double(r.toFloat16());
+        r.next();
+        return v;
+    }
+    case QCborStreamReader::Float: {
+        const double v = r.toFloat();
+        r.next();
+        return v;
+    }
+    case QCborStreamReader::Double: {
+        const double v = r.toDouble();
+        r.next();
+        return v;
+    }
+    case QCborStreamReader::String:
+        return r.readAllString();
+    case QCborStreamReader::ByteArray:
+        return QString::fromLatin1(r.readAllByteArray().toBase64());
+    case QCborStreamReader::Array: {
+        QJsonArray a;
+        r.enterContainer();
+        while (readerOk(r) && r.hasNext()) a.append(readValue(r));
+        if (readerOk(r)) r.leaveContainer();
+        return a;
+    }
+    case QCborStreamReader::Map: {
+        QJsonObject o;
+        r.enterContainer();
+        while (readerOk(r) && r.hasNext()) {
+            int keyId;
+            const QString key = readKey(r, &keyId);
+            o.insert(key, readValue(r));
+        }
+        if (readerOk(r)) r.leaveContainer();
+        return o;
+    }
+    case QCborStreamReader::SimpleType: {
+        const bool isBool = r.isBool();
+        const bool value = isBool && r.toBool();
+        r.next();
+        return isBool ? QJsonValue(value) : QJsonValue();
+    }
+    case QCborStreamReader::Tag:
+        r.next(); // tags carry no meaning for us; read the tagged item
+        return readValue(r);
+    default:
+        r.next();
+        return QJsonValue();
+    }
+}
+
+QList<ExecFileRow> ExecFeedCodec::decodeJsonRecords(const QList<QByteArray> &payloads) {
+    QList<ExecFileRow> rows;
+    rows.reserve(payloads.size());
+    for (const QByteArray &payload : payloads) {
+        const QJsonObject obj = QJsonDocument::fromJson(payload).object();
+        if (!obj.isEmpty()) rows.append(ExecFileRow::fromRecord(obj));
+    }
+    return rows;
+}
+
+QList<ExecFileRow> ExecFeedCodec::decodeJsonSnapshot(const QByteArray &body) {
+    QList<ExecFileRow> rows;
+    const QJsonArray files = QJsonDocument::fromJson(body).object().value("files").toArray();
+    rows.reserve(files.size());
+    for (const QJsonValue &v : files) {
+        rows.append(ExecFileRow::fromRecord(v.toObject()));
+    }
+    return rows;
+}
+
+QList<ExecFileRow> ExecFeedCodec::decodeCborSnapshot(const QByteArray &body) {
+    QList<ExecFileRow> rows;
+    QCborStreamReader r(body);
+    if (!r.isArray()) return rows;
+    if (r.isLengthKnown()) rows.reserve(qsizetype(r.length()));
+    r.enterContainer();
+    while (readerOk(r) && r.hasNext()) {
+        if (!r.isMap()) {
+            r.next();
+            continue;
+        }
+        // Top-level fields go straight into the row; the record keeps a copy
+        // of everything for the details panel.
+        ExecFileRow row;
+        r.enterContainer();
+        while (readerOk(r) && r.hasNext()) {
+            int keyId;
+            const QString key = readKey(r, &keyId);
+            const QJsonValue v = readValue(r);
+            switch (keyId) {
+            case ExecFeedKeys::Id: row.id = v.toInt(); break;
+            case ExecFeedKeys::Seq: row.seq = v.toInteger(); break;
+            case ExecFeedKeys::Name: row.name = v.toString(); break;
+            case ExecFeedKeys::Path: row.path = v.toString(); break;
+            case ExecFeedKeys::Type: row.status = ExecFileRow::statusForType(v.toString()); break;
+            case ExecFeedKeys::Details: {
+                const QJsonObject details = v.toObject();
+                row.when = details.value("created_at").toString();
+                row.cached = details.value("cached").toBool();
+                row.allowlisted = details.value("allowlisted").toBool();
+                break;
+            }
+            default:
+                if (key == QLatin1String("summary")) row.summary = v.toBool();
+                break;
+            }
+            row.record.insert(key, v);
+        }
+        if (!readerOk(r)) break;
+        r.leaveContainer();
+        if (row.status.isEmpty()) row.status = ExecFileRow::statusForType(QString());
+        row.updateSearchKey();
+        rows.append(row);
+    }
+    return rows;
+}
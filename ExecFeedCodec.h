@@ -0,0 +1,21 @@
+#ifndef EXECFEEDCODEC_H
+#define EXECFEEDCODEC_H
+
+#include <QByteArray>
+#include <QList>
+#include "DetectedFilesModel.h"
+
+// Decoders for the file watcher feed. All functions are pure and meant to
+// run on a worker thread.
+class ExecFeedCodec {
+public:
+    // One JSON record per payload, as carried by /api/events
+    static QList<ExecFileRow> decodeJsonRecords(const QList<QByteArray> &payloads);
+    // /api/files?since=... or /api/files/page JSON envelope; reads "files"
+    static QList<ExecFileRow> decodeJsonSnapshot(const QByteArray &body);
+    // /api/files?since=... or /api/files/page CBOR body: an array of records
+    // with compact keys, read with QCborStreamReader straight into rows
+    static QList<ExecFileRow> decodeCborSnapshot(const QByteArray &body);
+};
+
+#endif // EXECFEEDCODEC_H
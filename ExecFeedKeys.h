@@ -0,0 +1,36 @@
+#ifndef EXECFEEDKEYS_H
+#define EXECFEEDKEYS_H
+
+// Compact CBOR keys for file records, shared by the GUI decoder and the
+// watcher daemon. Must match CBOR_KEYS in ExecutableMonitor/wire_format.py
+// and may only ever be appended to.
+namespace ExecFeedKeys {
+
+inline constexpr const char *kNames[] = {
+    // file record
+    "id", "seq", "name", "path", "type", "details",
+    // details
+    "size", "ext", "mime", "magic_type", "hash", "entropy", "is_executable",
+    "has_digital_signature", "suspicious_strings", "file_header", "created_at",
+    "modified_at", "strings_count", "suspicious_count", "pe_sections",
+    "pe_timestamp", "is_dll", "rule", "gemini",
+    // verdict cache
+    "cached",
+    // similarity
+    "imphash", "similarity_digest", "similar", "distance", "same_imports",
+    // allowlist
+    "allowlisted",
+    // rules
+    "matched_rules",
+    // history
+    "summary",
+    // llm
+    "gemini_pending",
+};
+inline constexpr int kCount = int(sizeof(kNames) / sizeof(kNames[0]));
+
+enum Key { Id = 0, Seq, Name, Path, Type, Details };
+
+} // namespace ExecFeedKeys
+
+#endif // EXECFEEDKEYS_H
@@ -0,0 +1,86 @@
+#include "ExecSearchIndex.h"
+#include <algorithm>
+
+QList<quint64> ExecSearchIndex::trigramsOf(const QString &folded) {
+    QList<quint64> grams;
+    const qsizetype n = folded.size();
+    if (n < 3) return grams;
+    grams.reserve(n - 2);
+    const QChar *c = folded.constData();
+    for (qsizetype i = 0; i + 2 < n; ++i) {
+        grams.append((quint64(c[i].unicode()) << 32) | (quint64(c[i + 1].unicode()) << 16) | c[i + 2].unicode());
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+void ExecSearchIndex::addPosting(quint64 trigram, int row) {
+    QList<int> &rows = postings[trigram];
+    // Rows are usually appended in order, so this is almost always a push_back
+    if (rows.isEmpty() || rows.constLast() < row) {
+        rows.append(row);
+        return;
+    }
+    auto it = std::lower_bound(rows.begin(), rows.end(), row);
+    if (it == rows.end() || *it != row) rows.insert(it, row);
+}
+
+void ExecSearchIndex::removePosting(quint64 trigram, int row) {
+    auto p = postings.find(trigram);
+    if (p == postings.end()) return;
+    QList<int> &rows = p.value();
+    auto it = std::lower_bound(rows.begin(), rows.end(), row);
+    if (it != rows.end() && *it == row) rows.erase(it);
+    if (rows.isEmpty()) postings.erase(p);
+}
+
+void ExecSearchIndex::setRow(int row, const QString &folded) {
+    if (row < texts.size()) {
+        if (texts.at(row) == folded) return;
+        for (quint64 g : trigramsOf(texts.at(row))) removePosting(g, row);
+        texts[row] = folded;
+    } else {
+        texts.resize(row + 1);
+        texts[row] = folded;
+    }
+    for (quint64 g : trigramsOf(folded)) addPosting(g, row);
+}
+
+void ExecSearchIndex::clear() {
+    texts.clear();
+    postings.clear();
+}
+
+bool ExecSearchIndex::matches(int row, const QString &foldedQuery) const {
+    return row >= 0 && row < texts.size() && texts.at(row).contains(foldedQuery);
+}
+
+QBitArray ExecSearchIndex::search(const QString &foldedQuery) const {
+    QBitArray hits(texts.size());
+    if (foldedQuery.isEmpty()) {
+        hits.fill(true);
+        return hits;
+    }
+
+    // One- and two-character queries match most rows anyway; a straight scan
+    // of the pre-folded text is as fast as any index would be.
+    if (foldedQuery.size() < 3) {
+        for (qsizetype row = 0; row < texts.size(); ++row) {
+            if (texts.at(row).contains(foldedQuery)) hits.setBit(row);
+        }
+        return hits;
+    }
+
+    // Verify only the rows holding the query's rarest trigram
+    const QList<int> *rarest = nullptr;
+    for (quint64 g : trigramsOf(foldedQuery)) {
+        auto p = postings.constFind(g);
+        if (p == postings.constEnd()) return hits; // some trigram never occurs
+        if (!rarest || p.value().size() < rarest->size()) rarest = &p.value();
+    }
+    for (int row : *rarest) {
+        if (texts.at(row).contains(foldedQuery)) hits.setBit(row);
+    }
+    return hits;
+}
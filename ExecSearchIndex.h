@@ -0,0 +1,35 @@
+#ifndef EXECSEARCHINDEX_H
+#define EXECSEARCHINDEX_H
+
+#include <QBitArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+// Substring index over the detected files, keyed by model slot. Each file's
+// searchable text (name, path, extension, SHA-256) is case-folded once and
+// broken into trigram postings, so a query only verifies files that contain
+// its rarest trigram instead of scanning every file. Slots are assigned in
+// arrival order and never move, so the index is untouched by the display
+// order of the table.
+class ExecSearchIndex {
+public:
+    static QString fold(const QString &text) { return text.toCaseFolded(); }
+
+    void setRow(int row, const QString &foldedText); // adds or replaces a row
+    void clear();
+
+    // Rows whose text contains foldedQuery (already passed through fold()).
+    QBitArray search(const QString &foldedQuery) const;
+    bool matches(int row, const QString &foldedQuery) const;
+
+private:
+    static QList<quint64> trigramsOf(const QString &folded);
+    void addPosting(quint64 trigram, int row);
+    void removePosting(quint64 trigram, int row);
+
+    QList<QString> texts; // folded text per row
+    QHash<quint64, QList<int>> postings; // trigram -> sorted rows
+};
+
+#endif // EXECSEARCHINDEX_H
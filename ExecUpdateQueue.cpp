@@ -0,0 +1,122 @@
+#include "ExecUpdateQueue.h"
+#include "ExecFeedCodec.h"
+#include <QtConcurrent/QtConcurrentRun>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QDebug>
+
+ExecUpdateQueue::ExecUpdateQueue(QObject *parent)
+    : QObject(parent), watcher(new QFutureWatcher<QList<ExecFileRow>>(this)), applied(0),
+      chunkSize(256), generation(0), inflightGeneration(0), applyScheduled(false), worstSlice(0),
+      burstRows(0), burstSlices(0), burstWorst(0)
+{
+    connect(watcher, &QFutureWatcherBase::finished, this, &ExecUpdateQueue::onDecoded);
+}
+
+QList<ExecFileRow> ExecUpdateQueue::decode(const QList<Batch> &batches) {
+    QList<ExecFileRow> rows;
+    for (const Batch &batch : batches) {
+        switch (batch.kind) {
+        case Batch::JsonRecords:
+            rows.append(ExecFeedCodec::decodeJsonRecords(batch.data));
+            break;
+        case Batch::JsonSnapshot:
+            rows.append(ExecFeedCodec::decodeJsonSnapshot(batch.data.first()));
+            break;
+        case Batch::CborSnapshot:
+            rows.append(ExecFeedCodec::decodeCborSnapshot(batch.data.first()));
+            break;
+        }
+    }
+    return rows;
+}
+
+void ExecUpdateQueue::enqueue(const QList<QByteArray> &payloads) {
+    append(Batch::JsonRecords, payloads);
+}
+
+void ExecUpdateQueue::enqueueSnapshot(const QByteArray &body, bool cbor) {
+    append(cbor ? Batch::CborSnapshot : Batch::JsonSnapshot, {body});
+}
+
+void ExecUpdateQueue::append(Batch::Kind kind, const QList<QByteArray> &data) {
+    // Consecutive record batches merge so the worker sees fewer, larger jobs
+    if (kind == Batch::JsonRecords && !pending.isEmpty() && pending.last().kind == Batch::JsonRecords) {
+        pending.last().data.append(data);
+    } else {
+        pending.append(Batch{kind, data});
+    }
+    if (!watcher->isRunning()) startDecode();
+}
+
+void ExecUpdateQueue::clear() {
+    ++generation;
+    pending.clear();
+    decoded.clear();
+    applied = 0;
+    burstRows = 0;
+    burstSlices = 0;
+    burstWorst = 0;
+}
+
+void ExecUpdateQueue::startDecode() {
+    if (pending.isEmpty()) return;
+    QList<Batch> batches;
+    batches.swap(pending); // everything queued so far becomes one job
+    inflightGeneration = generation;
+    watcher->setFuture(QtConcurrent::run(&ExecUpdateQueue::decode, batches));
+}
+
+void ExecUpdateQueue::onDecoded() {
+    if (inflightGeneration == generation) {
+        decoded.append(watcher->result());
+        if (!applyScheduled) {
+            applyScheduled = true;
+            QTimer::singleShot(0, this, &ExecUpdateQueue::applySlice);
+        }
+    }
+    startDecode();
+}
+
+void ExecUpdateQueue::applySlice() {
+    applyScheduled = false;
+    QElapsedTimer slice;
+    slice.start();
+    const qsizetype before = applied;
+    while (applied < decoded.size() && slice.elapsed() < kSliceBudgetMs) {
+        QElapsedTimer chunkTimer;
+        chunkTimer.start();
+        const qsizetype n = qMin(chunkSize, decoded.size() - applied);
+        emit rowsReady(decoded.mid(applied, n));
+        applied += n;
+        // Keep one chunk well inside the budget whatever the model costs
+        const qint64 ms = chunkTimer.elapsed();
+        if (ms > kSliceBudgetMs / 2 && chunkSize > 16) chunkSize /= 2;
+        else if (ms == 0 && chunkSize < 4096) chunkSize *= 2;
+    }
+
+    const qint64 spent = slice.elapsed();
+    worstSlice = qMax(worstSlice, spent);
+    burstRows += applied - before;
+    ++burstSlices;
+    burstWorst = qMax(burstWorst, spent);
+    if (spent > kSliceBudgetMs * 2) {
+        qWarning() << "ExecUpdateQueue: GUI slice took" << spent << "ms (budget" << kSliceBudgetMs << "ms)";
+    }
+
+    if (applied < decoded.size()) {
+        // Yield to input and paint events before the next slice
+        applyScheduled = true;
+        QTimer::singleShot(0, this, &ExecUpdateQueue::applySlice);
+    } else {
+        if (burstSlices > 1) {
+            qInfo() << "ExecUpdateQueue: applied" << burstRows << "rows in" << burstSlices
+                    << "slices, worst" << burstWorst << "ms (budget" << kSliceBudgetMs << "ms)";
+        }
+        decoded.clear();
+        applied = 0;
+        burstRows = 0;
+        burstSlices = 0;
+        burstWorst = 0;
+    }
+}
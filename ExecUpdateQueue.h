@@ -0,0 +1,63 @@
+#ifndef EXECUPDATEQUEUE_H
+#define EXECUPDATEQUEUE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QList>
+#include <QFutureWatcher>
+#include "DetectedFilesModel.h"
+
+// Turns raw file-event payloads and /api/files snapshots into table rows
+// without stalling the GUI. Decoding and row building run on the global thread pool, one batch
+// at a time so updates keep their order; finished rows are handed back in
+// slices that each stay inside a small time budget on the GUI thread.
+// Every burst that needed more than one slice is logged with its worst
+// slice, and worstSliceMs() reports the worst since startup
+// (benchmarks/UpdateQueueBench checks it against the budget).
+class ExecUpdateQueue : public QObject {
+    Q_OBJECT
+public:
+    static constexpr int kSliceBudgetMs = 4;
+
+    explicit ExecUpdateQueue(QObject *parent = nullptr);
+
+    void enqueue(const QList<QByteArray> &payloads);
+    void enqueueSnapshot(const QByteArray &body, bool cbor);
+    void clear(); // drop queued and in-flight work, e.g. on stream reset
+    qint64 worstSliceMs() const { return worstSlice; }
+
+signals:
+    void rowsReady(const QList<ExecFileRow> &rows);
+
+private slots:
+    void onDecoded();
+    void applySlice();
+
+private:
+    // Queued input, decoded strictly in arrival order
+    struct Batch {
+        enum Kind { JsonRecords, JsonSnapshot, CborSnapshot };
+        Kind kind;
+        QList<QByteArray> data;
+    };
+
+    static QList<ExecFileRow> decode(const QList<Batch> &batches);
+    void append(Batch::Kind kind, const QList<QByteArray> &data);
+    void startDecode();
+
+    QFutureWatcher<QList<ExecFileRow>> *watcher;
+    QList<Batch> pending;        // input waiting for the worker
+    QList<ExecFileRow> decoded;  // worker output waiting for the GUI
+    qsizetype applied;           // rows of decoded already handed over
+    qsizetype chunkSize;         // rows per emit, tuned to the budget
+    quint64 generation;          // bumped by clear() to orphan in-flight work
+    quint64 inflightGeneration;
+    bool applyScheduled;
+    qint64 worstSlice;
+    // The burst being applied, for the log line once it drains
+    qint64 burstRows;
+    int burstSlices;
+    qint64 burstWorst;
+};
+
+#endif // EXECUPDATEQUEUE_H
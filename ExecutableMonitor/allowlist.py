@@ -0,0 +1,107 @@
+"""Known-good files by SHA-256 (e.g. the NSRL), answered before any analysis.
+
+The list is a file written by tools/AllowlistBuilder: a header, a blocked
+Bloom filter and the sorted hashes. It is memory-mapped, never parsed, so
+opening even an NSRL-sized list is instant. With the native library a lookup
+is one Bloom block for unknown files and a few probes for listed ones;
+without it the same file is searched from Python.
+
+    SECUREGUARD_ALLOWLIST  list file (default: allowlist.bin in the user cache dir)
+"""
+import bisect
+import mmap
+import os
+import struct
+import threading
+
+from native_features import native_allowlist
+from verdict_cache import default_path
+
+MAGIC = b'SGALLOW1'
+FORMAT = 1  # Allowlist.cpp kFormat
+HEADER = struct.Struct('<8sIIQQQQ')  # magic, format, key bytes, count, bloom blocks, bloom / keys offsets
+KEY_BYTES = 32
+
+
+class _Keys:
+    """The sorted hashes as a sequence, for bisect."""
+
+    def __init__(self, view, offset, count):
+        self.view, self.offset, self.count = view, offset, count
+
+    def __len__(self):
+        return self.count
+
+    def __getitem__(self, i):
+        start = self.offset + i * KEY_BYTES
+        return self.view[start:start + KEY_BYTES]
+
+
+class _MappedAllowlist:
+    """Python reader for the same file, for when the native library is missing."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.view = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        magic, fmt, key_bytes, count, blocks, bloom_offset, keys_offset = HEADER.unpack_from(self.view)
+        if magic != MAGIC or fmt != FORMAT or key_bytes != KEY_BYTES \
+                or keys_offset + count * KEY_BYTES != len(self.view) or bloom_offset + blocks * 64 != keys_offset:
+            raise OSError(f"{path}: not an allowlist (or built by another version)")
+        self.blocks, self.bloom_offset = blocks, bloom_offset
+        self.keys = _Keys(self.view, keys_offset, count)
+        self.counts = {'lookups': 0, 'bloom_rejects': 0, 'hits': 0}
+        self.lock = threading.Lock()
+
+    def _in_filter(self, key):
+        # Same bit layout as Allowlist.cpp: bytes 24..27 pick the block,
+        # bytes 8..15 a bit in each of its eight words
+        block = self.bloom_offset + (int.from_bytes(key[24:28], 'big') * self.blocks >> 32) * 64
+        words = struct.unpack_from('<8Q', self.view, block)
+        return all(words[i] >> (key[8 + i] & 63) & 1 for i in range(8))
+
+    def contains(self, sha256):
+        try:
+            key = bytes.fromhex(sha256)
+        except ValueError:
+            return False
+        if len(key) != KEY_BYTES:
+            return False
+        found = False
+        passed = self._in_filter(key)
+        if passed:
+            i = bisect.bisect_left(self.keys, key)
+            found = i < len(self.keys) and self.keys[i] == key
+        with self.lock:
+            self.counts['lookups'] += 1
+            self.counts['bloom_rejects'] += not passed
+            self.counts['hits'] += found
+        return found
+
+    def stats(self):
+        with self.lock:
+            return dict(self.counts, entries=len(self.keys), bloom_bytes=self.blocks * 64)
+
+
+class Allowlist:
+    def __init__(self, path=None):
+        self.path = path or os.environ.get('SECUREGUARD_ALLOWLIST') \
+            or os.path.join(os.path.dirname(default_path()), 'allowlist.bin')
+        self.list = None
+        if not os.path.exists(self.path):
+            return
+        self.list = native_allowlist(self.path)
+        if self.list is None:
+            try:
+                self.list = _MappedAllowlist(self.path)
+            except (OSError, ValueError, struct.error) as e:
+                print(f"[WARN] Allowlist disabled: {e}")
+        if self.list is not None:
+            print(f"[INFO] Allowlist: {self.list.stats()['entries']} known-good hashes from {self.path}")
+
+    def contains(self, sha256):
+        return self.list is not None and self.list.contains(sha256)
+
+    def stats(self):
+        if self.list is None:
+            return {'enabled': False}
+        return dict(self.list.stats(), enabled=True, path=self.path)
@@ -0,0 +1,102 @@
+"""Fixed-size, staged worker pool for file analysis.
+
+Each stage has its own bounded queue and a fixed number of worker threads,
+so concurrency is capped per kind of work however many files arrive:
+
+    io   hashing, cache lookup, feature extraction (disk bound)
+    cpu  pattern scan and rule assessment (one worker per core)
+
+submit() blocks while the target stage's queue is full. For the io stage
+that holds back the watchdog thread; for the cpu stage it holds back the
+io workers, so work does not pile up in memory. Gemini calls are not a
+stage: they wait on the network, not a worker, and go to llm_queue.py.
+
+    SECUREGUARD_IO_WORKERS / _CPU_WORKERS override the sizes.
+"""
+import os
+import queue
+import threading
+import traceback
+
+CORES = os.cpu_count() or 2
+
+
+def _env_int(name, default):
+    try:
+        return max(1, int(os.environ.get(name, default)))
+    except ValueError:
+        return default
+
+
+class _Stage:
+    def __init__(self, name, workers, capacity):
+        self.name = name
+        self.workers = workers
+        self.capacity = capacity
+        self.jobs = queue.Queue(maxsize=capacity)
+        self.active = 0
+
+
+class AnalysisPool:
+    def __init__(self, on_change=None):
+        self.on_change = on_change
+        self.lock = threading.Lock()
+        self.stages = {}
+        self.completed = 0
+        self.failed = 0
+
+    def add_stage(self, name, workers, capacity):
+        stage = _Stage(name, workers, capacity)
+        self.stages[name] = stage
+        for i in range(workers):
+            threading.Thread(target=self._work, args=(stage,), name=f"analysis-{name}-{i}", daemon=True).start()
+
+    def submit(self, stage_name, fn, *args):
+        """Queue fn(*args) on a stage; blocks while its queue is full."""
+        self.stages[stage_name].jobs.put((fn, args))
+        self._changed()
+
+    def _work(self, stage):
+        while True:
+            fn, args = stage.jobs.get()
+            with self.lock:
+                stage.active += 1
+            self._changed()
+            try:
+                fn(*args)
+                ok = True
+            except Exception:
+                traceback.print_exc()
+                ok = False
+            with self.lock:
+                stage.active -= 1
+                self.completed += ok
+                self.failed += not ok
+            self._changed()
+
+    def _changed(self):
+        if self.on_change is not None:
+            self.on_change()
+
+    def depth(self):
+        """Totals across stages: {'queued': n, 'active': n}."""
+        with self.lock:
+            return {'queued': sum(s.jobs.qsize() for s in self.stages.values()),
+                    'active': sum(s.active for s in self.stages.values())}
+
+    def stats(self):
+        with self.lock:
+            stages = {name: {'queued': s.jobs.qsize(), 'active': s.active,
+                             'workers': s.workers, 'capacity': s.capacity}
+                      for name, s in self.stages.items()}
+            completed, failed = self.completed, self.failed
+        return dict(self.depth(), stages=stages, completed=completed, failed=failed)
+
+
+def default_pool(on_change=None):
+    pool = AnalysisPool(on_change)
+    io_workers = _env_int('SECUREGUARD_IO_WORKERS', min(4, CORES))
+    cpu_workers = _env_int('SECUREGUARD_CPU_WORKERS', CORES)
+    pool.add_stage('io', io_workers, capacity=16 * io_workers)
+    pool.add_stage('cpu', cpu_workers, capacity=4 * cpu_workers)
+    return pool
@@ -0,0 +1,29 @@
+"""Fixed-size chunked file reads, so analysis memory stays the same
+whatever the size of the file being analysed."""
+
+CHUNK_SIZE = 1 << 20  # even, so UTF-16 pairs keep their parity across chunks
+
+
+def read_chunks(file_path, chunk_size=None):
+    """Yield the file's content chunk_size bytes at a time."""
+    with open(file_path, 'rb') as f:
+        while chunk := f.read(chunk_size or CHUNK_SIZE):
+            yield chunk
+
+
+def overlapping_chunks(file_path, overlap, chunk_size=None):
+    """Yield (window, start, fresh) for successive chunks.
+
+    Each window is the last `overlap` bytes of the previous window followed
+    by the next chunk, so any match of up to overlap + 1 bytes lies wholly
+    inside some window. start is the file offset of window[0]; bytes from
+    window[fresh:] have not been seen before, so a match is new if it ends
+    past fresh.
+    """
+    tail = b''
+    offset = 0
+    for chunk in read_chunks(file_path, chunk_size):
+        window = tail + chunk if tail else chunk
+        yield window, offset - len(tail), len(tail)
+        offset += len(chunk)
+        tail = window[-overlap:] if overlap else b''
@@ -0,0 +1,102 @@
+"""Per-path coalescing in front of the analysis pool.
+
+One download produces a burst of events: create, repeated writes and
+closes, renames. Requests for the same path are merged here:
+
+    - a burst within `window` seconds becomes one analysis (each request
+      restarts the path's window)
+    - a request while that path's analysis is queued or running cancels it
+      and the newer content is analysed instead. Stages check
+      job.cancelled and stop early, so a stale result is never published.
+
+merged + cancelled is the number of analyses saved.
+SECUREGUARD_COALESCE_WINDOW overrides the window (seconds).
+"""
+import os
+import threading
+import time
+
+
+class AnalysisJob:
+    def __init__(self, path, file_info):
+        self.path = path
+        self.file_info = file_info
+        self.cancelled = False
+        self.done = False
+
+
+class Coalescer:
+    def __init__(self, submit, window=None):
+        self.submit = submit  # submit(job); may block on a full queue
+        self.window = window if window is not None else float(os.environ.get('SECUREGUARD_COALESCE_WINDOW', 0.1))
+        self.lock = threading.Condition()
+        self.settling = {}  # path -> (due, job), not yet submitted
+        self.running = {}   # path -> job, submitted and not finished
+        self.merged = 0
+        self.cancelled = 0
+        threading.Thread(target=self._release, name="coalescer", daemon=True).start()
+
+    def request(self, path, file_info):
+        """Ask for path to be analysed once its burst of events is over."""
+        with self.lock:
+            self._cancel_running(path)
+            settling = self.settling.get(path)
+            if settling is not None:
+                self.merged += 1
+                job = settling[1]
+                job.file_info = file_info
+            else:
+                job = AnalysisJob(path, file_info)
+            self.settling[path] = (time.monotonic() + self.window, job)
+            self.lock.notify()
+
+    def cancel(self, path):
+        """The file is changing again; stop whatever analysis it has."""
+        with self.lock:
+            self._cancel_running(path)
+            if self.settling.pop(path, None) is not None:
+                self.merged += 1
+
+    def moved(self, path):
+        """Drops work pending under a path that was renamed away; True if
+        there was any, so the caller can request it under the new name."""
+        with self.lock:
+            settling = self.settling.pop(path, None)
+            job = self.running.pop(path, None)
+            busy = job is not None and not job.done
+            if busy:
+                job.cancelled = True
+            return busy or settling is not None
+
+    def finish(self, job):
+        with self.lock:
+            job.done = True
+            if self.running.get(job.path) is job:
+                del self.running[job.path]
+
+    def stats(self):
+        with self.lock:
+            return {'window': self.window, 'merged': self.merged, 'cancelled': self.cancelled,
+                    'analyses_saved': self.merged + self.cancelled}
+
+    def _cancel_running(self, path):
+        job = self.running.pop(path, None)
+        if job is not None and not job.done:
+            job.cancelled = True
+            self.cancelled += 1
+
+    def _release(self):
+        while True:
+            with self.lock:
+                while not self.settling:
+                    self.lock.wait()
+                now = time.monotonic()
+                due = [path for path, (at, _) in self.settling.items() if at <= now]
+                if not due:
+                    self.lock.wait(min(at for at, _ in self.settling.values()) - now)
+                    continue
+                jobs = [self.settling.pop(path)[1] for path in due]
+                for job in jobs:
+                    self.running[job.path] = job
+            for job in jobs:
+                self.submit(job)
@@ -4,10 +4,13 @@ import math
 import mimetypes
 import re
 import binascii
+import bisect
 import struct
 import string
 from datetime import datetime
 from collections import Counter
+from chunked_io import overlapping_chunks, read_chunks
+from native_features import NATIVE_AVAILABLE, extract_native, file_entropy
 
 # Try to import magic, but provide a fallback if it's not available
 try:
@@ -18,18 +21,22 @@ except ImportError:
     MAGIC_AVAILABLE = False
 
 def get_file_entropy(file_path):
-    with open(file_path, "rb") as f:
-        data = f.read()
-    if not data:
+    if NATIVE_AVAILABLE:
+        entropy = file_entropy(file_path)
+        if entropy is not None:
+            return round(entropy, 4) if entropy else 0
+    # Counter tallies the bytes in C rather than one Python step per byte
+    counts = Counter()
+    total = 0
+    for chunk in read_chunks(file_path):
+        counts.update(chunk)
+        total += len(chunk)
+    if not total:
         return 0
-    byte_freq = [0] * 256
-    for b in data:
-        byte_freq[b] += 1
     entropy = 0
-    for freq in byte_freq:
-        if freq > 0:
-            p = freq / len(data)
-            entropy -= p * math.log2(p)
+    for freq in counts.values():
+        p = freq / total
+        entropy -= p * math.log2(p)
     return round(entropy, 4)
 
 def get_sha256(file_path):
@@ -65,19 +72,90 @@ def get_file_header(file_path, num_bytes=20):
     except Exception:
         return ""
 
+MAX_STRING_LENGTH = 64 * 1024  # longer runs keep their first 64 KiB, as in NativeAnalysis
+_PRINTABLE_RUN = re.compile(rb'[\x20-\x7E]+')
+_NONZERO_TO_FF = bytes([0]) + bytes([0xFF]) * 255
+
+
+class _RunScanner:
+    """Printable runs of at least min_length bytes, fed chunk by chunk. A
+    run reaching the end of a chunk is held (at most MAX_STRING_LENGTH
+    bytes of it) until the next chunk shows where it ends."""
+
+    def __init__(self, min_length):
+        self.min_length = min_length
+        self.pending = None
+        self.pending_start = 0
+
+    def _flush(self, out):
+        if self.pending is not None and len(self.pending) >= self.min_length:
+            out.append((self.pending_start, self.pending))
+        self.pending = None
+
+    def feed(self, data, base, step=1):
+        """(file offset, run) for each run that ended in data; data[i] sits
+        at file offset base + i * step."""
+        out = []
+        for m in _PRINTABLE_RUN.finditer(data):
+            start, text = base + m.start() * step, m.group()
+            if self.pending is not None and m.start() == 0:
+                start, text = self.pending_start, self.pending + text
+                self.pending = None
+            self._flush(out)
+            text = text[:MAX_STRING_LENGTH]
+            if m.end() == len(data):
+                self.pending, self.pending_start = text, start
+            elif len(text) >= self.min_length:
+                out.append((start, text))
+        if data and not _PRINTABLE_RUN.match(data[-1:]):
+            self._flush(out)
+        return out
+
+    def finish(self):
+        out = []
+        self._flush(out)
+        return out
+
+
+def _utf16_pairs(chunk, next_byte, parity):
+    """The chunk's (char, 0x00) pairs starting at the given byte parity,
+    as one byte each: the char where the pair is valid, 0xFF elsewhere."""
+    firsts = chunk[parity::2]
+    seconds = (chunk + next_byte)[parity + 1::2].ljust(len(firsts), b'\x01')
+    # Byte-wise OR of the chars with a 0x00/0xFF mask, done as one big integer
+    mask = int.from_bytes(seconds.translate(_NONZERO_TO_FF), 'little')
+    return (int.from_bytes(firsts, 'little') | mask).to_bytes(len(firsts), 'little')
+
+
 def get_strings(file_path, min_length=4, max_strings=100):
+    """ASCII runs, then UTF-16LE runs, first max_strings of them; read in
+    chunks so memory does not grow with file size. UTF-16 runs at the two
+    byte parities never overlap, so they are scanned as separate streams
+    and merged by offset, as one left-to-right regex pass would find them."""
     try:
-        with open(file_path, 'rb') as f:
-            content = f.read()
-            # Find ASCII strings
-            ascii_pattern = re.compile(b'[\x20-\x7E]{' + str(min_length).encode() + b',}')
-            ascii_strings = ascii_pattern.findall(content)
-            # Find UTF-16 strings (Windows)
-            utf16_pattern = re.compile(b'(?:([\x20-\x7E]\x00){' + str(min_length).encode() + b',})')
-            utf16_strings = [s.decode('utf-16le', errors='ignore') for s in utf16_pattern.findall(content)]
-            # Combine and limit
-            all_strings = [s.decode('ascii', errors='ignore') for s in ascii_strings] + utf16_strings
-            return all_strings[:max_strings]
+        ascii_scanner = _RunScanner(min_length)
+        wide_scanners = [_RunScanner(min_length), _RunScanner(min_length)]
+        ascii_strings, utf16_strings = [], []
+        offset = 0
+        chunks = read_chunks(file_path)
+        chunk = next(chunks, b'')
+        while chunk and (len(ascii_strings) < max_strings or len(utf16_strings) < max_strings):
+            following = next(chunks, b'')
+            if len(ascii_strings) < max_strings:
+                ascii_strings += [text for _, text in ascii_scanner.feed(chunk, offset)]
+            if len(utf16_strings) < max_strings:
+                runs = []
+                for parity, scanner in enumerate(wide_scanners):
+                    first = (parity - offset) % 2  # chunk index of this parity's first pair
+                    runs += scanner.feed(_utf16_pairs(chunk, following[:1], first), offset + first, 2)
+                utf16_strings += [text for _, text in sorted(runs)]
+            offset += len(chunk)
+            chunk = following
+        if not chunk:
+            ascii_strings += [text for _, text in ascii_scanner.finish()]
+            utf16_strings += [text for _, text in sorted(wide_scanners[0].finish() + wide_scanners[1].finish())]
+        all_strings = [s.decode('ascii') for s in ascii_strings[:max_strings] + utf16_strings[:max_strings]]
+        return all_strings[:max_strings]
     except Exception:
         return []
 
@@ -129,19 +207,43 @@ def check_digital_signature(file_path):
     try:
         if os.name == 'nt' and file_path.lower().endswith(('.exe', '.dll', '.sys')):
             # Check for certificate data in the file (simplified approach)
-            with open(file_path, 'rb') as f:
-                content = f.read()
-                # Look for common certificate markers
-                has_cert_markers = (b'Microsoft Corporation' in content or 
-                                  b'DigiCert' in content or 
-                                  b'VeriSign' in content or
-                                  b'GlobalSign' in content)
-                return has_cert_markers
+            # Look for common certificate markers, chunk by chunk
+            markers = (b'Microsoft Corporation', b'DigiCert', b'VeriSign', b'GlobalSign')
+            overlap = max(map(len, markers)) - 1
+            for window, _, _ in overlapping_chunks(file_path, overlap):
+                if any(marker in window for marker in markers):
+                    return True
+            return False
         return False
     except Exception:
         return False
 
-def extract_file_features(file_path):  # ✅ Make sure this is defined!
+def extract_native_features(file_path, rules=None):
+    """extract_file_features() via the single-pass native library. With
+    NativeRules the result also has their 'rules' evaluation."""
+    # The rules see the MIME and libmagic types, so they come first
+    mime_type = get_mime_type(file_path)
+    magic_type = get_file_magic(file_path)
+    features = rules.extract(file_path, mime_type, magic_type) if rules is not None else extract_native(file_path)
+    if features is None:
+        return None
+    ctime = features.pop('ctime')
+    mtime = features.pop('mtime')
+    if features['file_size'] == 0:
+        features['entropy'] = 0
+    features.update({
+        "mime_type": mime_type,
+        "magic_type": magic_type,
+        "created_at": datetime.fromtimestamp(ctime).isoformat(),
+        "modified_at": datetime.fromtimestamp(mtime).isoformat(),
+    })
+    return features
+
+def extract_file_features(file_path, rules=None):  # ✅ Make sure this is defined!
+    if NATIVE_AVAILABLE:
+        features = extract_native_features(file_path, rules)
+        if features is not None:
+            return features
     try:
         stat = os.stat(file_path)
         
@@ -184,11 +286,20 @@ def extract_file_features(file_path):  # ✅ Make sure this is defined!
         ]
         
         suspicious_found = []
+        # Search all strings at once: they are printable, so a keyword never
+        # spans the newlines joining them, and its first occurrence in the
+        # joined text lies in the first string that contains it
+        joined = "\n".join(strings_found).lower()
+        starts = []
+        position = 0
+        for string in strings_found:
+            starts.append(position)
+            position += len(string) + 1
         for keyword in suspicious_keywords:
-            for string in strings_found:
-                if keyword.lower() in string.lower():
-                    suspicious_found.append(f"{keyword}: {string}")
-                    break
+            at = joined.find(keyword.lower())
+            if at >= 0:
+                string = strings_found[bisect.bisect_right(starts, at) - 1]
+                suspicious_found.append(f"{keyword}: {string}")
         
         features["suspicious_strings"] = suspicious_found
         features["suspicious_count"] = len(suspicious_found)
@@ -0,0 +1,285 @@
+"""The file records shown by the clients, persistent, bounded and paged.
+
+Every detected file gets a record {'id', 'seq', 'name', 'path', 'type',
+'details'}. Ids grow with detection order; seq is bumped on every change
+(see publish), so a client holding cursor N only needs the records with
+seq > N. Records are kept in scan_store's database, so history, ids and
+cursors survive a restart: the feed epoch is stored with them and only
+changes when the database is new. History is capped by count and by age:
+the oldest records go once either limit is passed, except those still
+being analysed.
+
+Clients list history a page at a time, newest first by default, with a
+keyset cursor: the cursor names the last record of a page, so pages stay
+consistent while new files arrive, and each page is one indexed query.
+Listings can be summaries, which leave out the bulky details (strings,
+header, rule and Gemini text); the full record is fetched by id when a file
+is opened.
+
+Records of files seen in this run stay in memory as the dicts the analysis
+stages update, so one file keeps one record object; publish writes them
+through.
+
+    SECUREGUARD_HISTORY_RECORDS  records kept, default 10,000
+    SECUREGUARD_HISTORY_DAYS     days kept, default 30
+"""
+import base64
+import json
+import os
+import threading
+import time
+from collections import OrderedDict
+from datetime import datetime
+
+import scan_store
+
+DEFAULT_RECORDS = 10000
+DEFAULT_DAYS = 30
+MAX_PAGE = 500
+LIVE_RECORDS = 4096  # records of this run kept in memory, by path
+SORTS = ('id', 'seq', 'name')
+# Details a summary keeps: enough for the table row
+SUMMARY_DETAILS = ('created_at', 'ext', 'hash', 'cached', 'allowlisted')
+COLUMNS = "id, seq, name, path, type, summary, details"
+
+
+def _setting(name, default, cast):
+    try:
+        return max(1, cast(os.environ.get(name, default)))
+    except ValueError:
+        return default
+
+
+def summary_details(details):
+    if details is None:
+        return None
+    return {k: details[k] for k in SUMMARY_DETAILS if k in details}
+
+
+def encode_cursor(key):
+    return base64.urlsafe_b64encode(json.dumps(key, separators=(',', ':')).encode()).decode().rstrip('=')
+
+
+def decode_cursor(cursor, sort):
+    """The sort key a page cursor names; ValueError if it is not one."""
+    try:
+        key = json.loads(base64.urlsafe_b64decode(cursor + '=' * (-len(cursor) % 4)))
+    except (ValueError, TypeError) as e:
+        raise ValueError(f"bad cursor: {e}")
+    shape = (str, int) if sort == 'name' else (int,)
+    if not isinstance(key, list) or len(key) != len(shape) \
+            or not all(isinstance(k, t) for k, t in zip(key, shape)):
+        raise ValueError("bad cursor")
+    return key
+
+
+def sort_key(record, sort):
+    if sort == 'name':
+        return [record['name'].lower(), record['id']]
+    return [record[sort]]
+
+
+def _row_record(row, summary=False):
+    record_id, seq, name, path, verdict, brief, details = row
+    record = {'id': record_id, 'seq': seq, 'name': name, 'path': path, 'type': verdict}
+    if summary:
+        record['summary'] = True
+        record['details'] = json.loads(brief) if brief is not None else None
+    else:
+        record['details'] = json.loads(details) if details is not None else None
+    return record
+
+
+class FileHistory:
+    def __init__(self, path=None, max_records=None, max_days=None):
+        self.max_records = max_records or _setting('SECUREGUARD_HISTORY_RECORDS', DEFAULT_RECORDS, int)
+        self.max_age = 86400 * (max_days or _setting('SECUREGUARD_HISTORY_DAYS', DEFAULT_DAYS, float))
+        self.lock = threading.Lock()
+        self.db = scan_store.connect(path)
+        self.epoch = scan_store.meta(self.db, 'epoch', scan_store.new_epoch)
+        self.live = OrderedDict()  # path -> record of this run, least recently used first
+        self.total = None  # records kept; counted when first needed
+        self.evicted = 0
+        # The top of an index, so this is instant at any size
+        self.cursor = self.db.execute("SELECT coalesce(max(seq), 0) FROM files").fetchone()[0]
+        self._abandon()
+
+    def _abandon(self):
+        # Analyses cut short by the last shutdown never finish; show them
+        # as errors rather than 'analyzing' forever
+        stuck = [r[0] for r in self.db.execute("SELECT id FROM files WHERE type = 'analyzing'")]
+        if not stuck:
+            return
+        self.db.execute("BEGIN")
+        for record_id in stuck:
+            self.cursor += 1
+            self.db.execute("UPDATE files SET type = 'error', seq = ? WHERE id = ?", (self.cursor, record_id))
+        self.db.execute("COMMIT")
+
+    def _remember(self, record):
+        self.live[record['path']] = record
+        self.live.move_to_end(record['path'])
+        while len(self.live) > LIVE_RECORDS:
+            self.live.popitem(last=False)
+
+    def _find(self, path):
+        record = self.live.get(path)
+        if record is None:
+            row = self.db.execute(f"SELECT {COLUMNS} FROM files WHERE path = ? ORDER BY id DESC LIMIT 1",
+                                  (path,)).fetchone()
+            if row is None:
+                return None
+            record = _row_record(row)
+        self._remember(record)
+        return record
+
+    def _count(self):
+        if self.total is None:
+            self.total = self.db.execute("SELECT count(*) FROM files").fetchone()[0]
+        return self.total
+
+    def track(self, path):
+        """The record for path, now 'analyzing' (not yet published). A path
+        seen before, in this run or an earlier one, keeps its record, e.g.
+        the empty placeholder a browser replaces on completion."""
+        with self.lock:
+            record = self._find(path)
+            if record is not None:
+                record['type'] = 'analyzing'
+                return record
+            self._count()
+            name = os.path.basename(path)
+            row = self.db.execute("INSERT INTO files (seq, path, name, name_key, type, added) "
+                                  "VALUES (0, ?, ?, ?, 'analyzing', ?)", (path, name, name.lower(), time.time()))
+            record = {
+                'id': row.lastrowid,
+                'seq': 0,
+                'name': name,
+                'path': path,
+                'type': 'analyzing',
+                'details': None
+            }
+            self.total += 1
+            self._remember(record)
+            self._expire()
+            return record
+
+    def _expire(self):
+        # Oldest first; a record still being analysed is kept until done.
+        # Both deletes walk an index from its start.
+        gone = self.db.execute("DELETE FROM files WHERE added < ? AND type != 'analyzing'",
+                               (time.time() - self.max_age,)).rowcount
+        excess = self.total - gone - self.max_records
+        if excess > 0:
+            gone += self.db.execute("DELETE FROM files WHERE id IN (SELECT id FROM files "
+                                    "WHERE type != 'analyzing' ORDER BY id LIMIT ?)", (excess,)).rowcount
+        if gone:
+            self.total -= gone
+            self.evicted += gone
+            # Evicted records of this run must not be written back
+            kept = {r[0] for r in self.db.execute(
+                f"SELECT id FROM files WHERE id IN ({','.join('?' * len(self.live))})",
+                [r['id'] for r in self.live.values()])} if self.live else set()
+            for path in [p for p, r in self.live.items() if r['id'] not in kept]:
+                del self.live[path]
+
+    def find(self, path):
+        with self.lock:
+            return self._find(path)
+
+    def rename(self, src, dest, record):
+        """Moves record to dest; publish it afterwards."""
+        with self.lock:
+            if self.live.get(src) is record:
+                del self.live[src]
+            record['name'], record['path'] = os.path.basename(dest), dest
+            self._remember(record)
+
+    def publish(self, record):
+        """Stores a change to record and gives it the next seq, for delta and
+        stream clients."""
+        with self.lock:
+            details = record['details']
+            name = record['name']
+            changed = self.db.execute(
+                "UPDATE files SET seq = ?, path = ?, name = ?, name_key = ?, type = ?, hash = ?, summary = ?, "
+                "details = ? WHERE id = ?",
+                (self.cursor + 1, record['path'], name, name.lower(), record['type'],
+                 (details or {}).get('hash'), json.dumps(summary_details(details)) if details is not None else None,
+                 json.dumps(details) if details is not None else None, record['id'])).rowcount
+            if not changed:
+                return  # evicted meanwhile
+            self.cursor += 1
+            record['seq'] = self.cursor
+
+    def since(self, since, limit=None):
+        """(cursor, records changed after since in seq order), or (cursor,
+        None) when there are more than limit of them."""
+        with self.lock:
+            sql = f"SELECT {COLUMNS} FROM files WHERE seq > ? ORDER BY seq"
+            args = (since,)
+            if limit is not None:
+                sql += " LIMIT ?"
+                args += (limit + 1,)
+            rows = self.db.execute(sql, args).fetchall()
+            if limit is not None and len(rows) > limit:
+                return self.cursor, None
+            return self.cursor, [_row_record(row) for row in rows]
+
+    def get(self, record_id):
+        with self.lock:
+            row = self.db.execute(f"SELECT {COLUMNS} FROM files WHERE id = ?", (record_id,)).fetchone()
+            return _row_record(row) if row is not None else None
+
+    def all(self):
+        with self.lock:
+            return [_row_record(row) for row in self.db.execute(f"SELECT {COLUMNS} FROM files ORDER BY id")]
+
+    def page(self, limit=100, cursor=None, sort='id', descending=True, verdict=None, summary=True):
+        """{'cursor', 'files', 'next', 'total'}: up to limit records after
+        the page cursor (None: from the start) in the given order, and the
+        cursor of the next page (None after the last). verdict keeps only
+        records of that type; total counts them all."""
+        if sort not in SORTS:
+            raise ValueError(f"sort must be one of {', '.join(SORTS)}")
+        after = decode_cursor(cursor, sort) if cursor else None
+        limit = max(1, min(limit, MAX_PAGE))
+        columns = ('name_key', 'id') if sort == 'name' else (sort,)
+        where, args = [], []
+        if sort == 'seq':
+            where.append("seq > 0")  # not yet published
+        if after is not None:
+            where.append(f"({', '.join(columns)}) {'<' if descending else '>'} ({', '.join('?' * len(after))})")
+            args += after
+        if verdict is not None:
+            where.append("type = ?")
+            args.append(verdict)
+        direction = 'DESC' if descending else 'ASC'
+        sql = f"SELECT {COLUMNS} FROM files"
+        if where:
+            sql += " WHERE " + " AND ".join(where)
+        sql += " ORDER BY " + ", ".join(f"{c} {direction}" for c in columns) + " LIMIT ?"
+        with self.lock:
+            rows = self.db.execute(sql, args + [limit + 1]).fetchall()
+            if verdict is None:
+                total = self._count()
+            else:
+                total = self.db.execute("SELECT count(*) FROM files WHERE type = ?", (verdict,)).fetchone()[0]
+            files = [_row_record(row, summary) for row in rows[:limit]]
+            return {
+                'cursor': self.cursor,
+                'files': files,
+                'next': encode_cursor(sort_key(files[-1], sort)) if len(rows) > limit else None,
+                'total': total,
+            }
+
+    def stats(self):
+        with self.lock:
+            oldest = self.db.execute("SELECT min(added) FROM files").fetchone()[0]
+            return {
+                'records': self._count(),
+                'max_records': self.max_records,
+                'max_days': self.max_age / 86400,
+                'evicted': self.evicted,
+                'oldest': datetime.fromtimestamp(oldest).isoformat() if oldest is not None else None,
+            }
@@ -0,0 +1,151 @@
+"""What Gemini is shown of a file, and the cache of its answers.
+
+The prompt carries only the security-relevant features, in compact JSON:
+no path, hashes, dates or random string samples, entropy to one decimal,
+sizes as a power-of-two class, suspicious strings as their keywords and PE
+details without addresses, timestamps or checksums. Besides cutting tokens,
+this makes the prompt the same for files that differ only in those details,
+so the answer is cached under a hash of it (the feature fingerprint) and
+reused: a repacked or renamed variant costs no call. Unlike the verdict
+cache, which matches identical content, this matches identical features.
+
+Answers are kept in a VerdictCache of their own (persistent with the
+native library), versioned by the backend and PROMPT_VERSION.
+
+    SECUREGUARD_LLM_CACHE          cache file (default: llm_answers.cache in the user cache dir)
+    SECUREGUARD_LLM_CACHE_MB       file size limit, default 16
+    SECUREGUARD_LLM_CACHE_ENTRIES  entry limit, default 4096
+"""
+import hashlib
+import json
+import os
+import threading
+
+from rule_engine import format_size
+from verdict_cache import VerdictCache, default_path
+
+# Bump when relevant_features() or the instructions change what is asked
+PROMPT_VERSION = 1
+MAX_IMPORTS = 64
+MAX_LIST = 32
+
+INSTRUCTIONS = """Assess this file for malware from the features below (JSON). Entropy above 7.0 suggests \
+packing or encryption; compare magic and mime with ext. rules lists the local detection rules that matched.
+Reply with:
+1. Safety assessment: Safe, Suspicious or Malicious
+2. Explanation with evidence
+3. Notable characteristics
+4. Risk level: Low, Medium or High
+5. Recommendations for handling the file
+"""
+
+# Bytes of instructions around the features in the verbose prompt this one
+# replaced, to count what the compact encoding saves
+_VERBOSE_OVERHEAD = 890
+
+
+def _size_class(size):
+    """Upper bound of size's power-of-two class, e.g. '4.00 KB'."""
+    return format_size(1 << max(0, int(size) - 1).bit_length()) if size else '0 B'
+
+
+def _pe_features(pe):
+    relevant = {
+        'dll': pe.get('is_dll'),
+        'subsystem': pe.get('subsystem'),
+        'sections': [f"{s.get('name', '')} {s.get('entropy', 0):.1f}" for s in pe.get('sections', [])],
+        'import_count': pe.get('import_count', 0),
+        'imports': sorted(pe.get('imports', []))[:MAX_IMPORTS],
+        'export_count': pe.get('export_count', 0),
+        'exports': sorted(pe.get('exports', []))[:MAX_LIST],
+        'resources': pe.get('resource_types', {}),
+        'tls_callbacks': len(pe.get('tls_callbacks', [])),
+        'overlay': _size_class(pe.get('overlay_payload_size', 0)),
+        'certificate': bool(pe.get('certificate_size')),
+    }
+    return {k: v for k, v in relevant.items() if v not in (None, [], {})}
+
+
+def relevant_features(features, matched_rules):
+    """The features Gemini sees, canonical so equal files give equal dicts."""
+    relevant = {
+        'ext': features.get('extension', ''),
+        'mime': features.get('mime_type', ''),
+        'magic': features.get('magic_type', ''),
+        'size': _size_class(features.get('file_size', 0)),
+        'entropy': round(float(features.get('entropy') or 0), 1),
+        'executable': bool(features.get('is_executable')),
+        'signed': bool(features.get('has_digital_signature')),
+        'header': (features.get('file_header') or '')[:8],  # magic bytes, hex
+        # "keyword: string it was found in" -> keyword
+        'suspicious': sorted({s.split(':', 1)[0] for s in features.get('suspicious_strings', [])})[:MAX_LIST],
+        'rules': sorted(matched_rules),
+    }
+    if features.get('pe_details'):
+        relevant['pe'] = _pe_features(features['pe_details'])
+    elif features.get('pe_sections'):
+        relevant['pe'] = {'dll': bool(features.get('is_dll')), 'section_count': features['pe_sections']}
+    return relevant
+
+
+def compact_prompt(relevant):
+    return INSTRUCTIONS + json.dumps(relevant, sort_keys=True, separators=(',', ':'), ensure_ascii=False)
+
+
+def fingerprint(prompt):
+    return hashlib.sha256(prompt.encode('utf-8')).hexdigest()
+
+
+class LlmRequest:
+    def __init__(self, features, matched_rules):
+        self.prompt = compact_prompt(relevant_features(features, matched_rules))
+        self.key = fingerprint(self.prompt)
+        self.prompt_bytes = len(self.prompt.encode('utf-8'))
+        # What the former prompt, the whole feature dict indented, would have cost
+        self.verbose_bytes = _VERBOSE_OVERHEAD + len(json.dumps(features, indent=2, default=str).encode('utf-8'))
+
+
+class LlmAnswerCache:
+    def __init__(self, backend_name, path=None, max_bytes=None, max_entries=None):
+        path = path or os.environ.get('SECUREGUARD_LLM_CACHE') \
+            or os.path.join(os.path.dirname(default_path()), 'llm_answers.cache')
+        max_bytes = max_bytes or int(float(os.environ.get('SECUREGUARD_LLM_CACHE_MB', 16)) * 1024 * 1024)
+        max_entries = max_entries or int(os.environ.get('SECUREGUARD_LLM_CACHE_ENTRIES', 4096))
+        self.store = VerdictCache(f"llm-{PROMPT_VERSION}-{backend_name}", path, max_bytes, max_entries)
+        self.lock = threading.Lock()
+        self.hits = 0
+        self.misses = 0
+        self.prompt_bytes = 0     # sent to the model
+        self.compact_saved = 0    # compact prompt against the verbose one
+        self.hit_saved = 0        # compact prompt and answer of calls not made
+
+    def get(self, request):
+        """The cached answer for request's features, or None (a call is due)."""
+        answer = self.store.get(request.key)
+        text = answer.get('text') if answer else None
+        with self.lock:
+            self.compact_saved += request.verbose_bytes - request.prompt_bytes
+            if text:
+                self.hits += 1
+                self.hit_saved += request.prompt_bytes + len(text.encode('utf-8'))
+            else:
+                self.misses += 1
+                self.prompt_bytes += request.prompt_bytes
+        return text
+
+    def put(self, request, text):
+        self.store.put(request.key, {'text': text})
+
+    def stats(self):
+        with self.lock:
+            lookups = self.hits + self.misses
+            return {
+                'hits': self.hits,
+                'misses': self.misses,
+                'hit_rate': round(self.hits / lookups, 4) if lookups else None,
+                'prompt_bytes_sent': self.prompt_bytes,
+                'bytes_saved_compact': self.compact_saved,
+                'bytes_saved_hits': self.hit_saved,
+                'bytes_saved': self.compact_saved + self.hit_saved,
+                'store': self.store.stats(),
+            }
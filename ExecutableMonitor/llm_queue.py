@@ -0,0 +1,412 @@
+"""Asynchronous queue for the LLM enrichment of verdicts.
+
+The rule-based verdict is published as soon as the cpu stage has it; the
+LLM's opinion follows whenever it arrives. Requests run on one asyncio loop
+in a thread of their own, so a slow model holds no analysis worker:
+
+    - at most `concurrency` calls are in flight
+    - a token bucket keeps to `rate` calls a minute, with bursts of `burst`
+    - each call is abandoned after `timeout` seconds
+    - a failed or timed-out call is retried up to `retries` times, with
+      exponential backoff and jitter; every attempt takes a token
+
+At most `capacity` requests wait. Past that a request is not queued but
+deferred: submit() returns False at once, so a backlog neither grows
+without bound nor holds back the cpu stage (and the rule verdicts of
+every later file).
+
+A request given a progress callback is streamed when the backend can: the
+callback gets the text so far with every chunk, so the GUI can show the
+answer as it is written instead of after the last word. LiveText holds
+those partial answers for the event streams.
+
+Backends are pluggable: anything with a `name` and an async
+generate(prompt) returning text, optionally an async generator
+stream(prompt) yielding chunks of it. SECUREGUARD_LLM_BACKEND picks one:
+
+    gemini  Google Gemini (the default when GEMINI_API_KEY is set)
+    mock    local stand-in with a configurable latency and error rate, for
+            load tests without network or quota
+    none    no LLM enrichment
+
+    SECUREGUARD_LLM_WORKERS   concurrent calls, default 2
+    SECUREGUARD_LLM_RATE      calls per minute, default 15
+    SECUREGUARD_LLM_BURST     bucket size, default 5
+    SECUREGUARD_LLM_TIMEOUT   seconds per attempt, default 30
+    SECUREGUARD_LLM_RETRIES   retries after the first attempt, default 2
+    SECUREGUARD_LLM_QUEUE     waiting requests before new ones are deferred, default 256
+    SECUREGUARD_MOCK_LLM_LATENCY  mock seconds per call, default 0.5; the
+                                  first streamed chunk comes after a tenth
+    SECUREGUARD_MOCK_LLM_ERRORS   mock failure rate 0..1, default 0
+"""
+import asyncio
+import hashlib
+import os
+import random
+import threading
+import time
+import traceback
+
+GEMINI_MODELS = ['gemini-2.0-flash']
+BACKOFF = 1.0  # seconds before the first retry; doubled for each further one
+
+
+def _env(name, default, cast):
+    try:
+        return cast(os.environ.get(name, default))
+    except ValueError:
+        return default
+
+
+class GeminiBackend:
+    def __init__(self, api_key, models=GEMINI_MODELS):
+        import google.generativeai as genai
+        genai.configure(api_key=api_key)
+        self.genai = genai
+        self.models = models
+        self.name = 'gemini:' + ','.join(models)
+
+    async def generate(self, prompt):
+        # Try each model in turn to avoid 404s on unsupported versions
+        last_error = None
+        for model_name in self.models:
+            try:
+                response = await self.genai.GenerativeModel(model_name).generate_content_async(prompt)
+                if hasattr(response, 'text') and response.text:
+                    return response.text
+                # Some SDK versions return a list of candidates
+                if hasattr(response, 'candidates') and response.candidates:
+                    candidate_text = getattr(response.candidates[0], 'content', None)
+                    if candidate_text:
+                        return str(candidate_text)
+            except Exception as e:
+                last_error = e
+        if last_error:
+            raise last_error
+        return None
+
+    async def stream(self, prompt):
+        # A model that fails before its first chunk is skipped as above;
+        # once text has been shown, a failure is the attempt's
+        last_error = None
+        for model_name in self.models:
+            started = False
+            try:
+                response = await self.genai.GenerativeModel(model_name).generate_content_async(prompt, stream=True)
+                async for chunk in response:
+                    try:
+                        text = chunk.text
+                    except ValueError:
+                        continue  # a chunk without text parts (e.g. only safety ratings)
+                    if text:
+                        started = True
+                        yield text
+                return
+            except Exception as e:
+                if started:
+                    raise
+                last_error = e
+        if last_error:
+            raise last_error
+
+
+class MockBackend:
+    """Answers like Gemini after a delay, without the network. One file in
+    five is called suspicious, chosen by the prompt's hash so a file always
+    gets the same answer. Streamed, the first words come after a tenth of
+    the delay and the rest over the remainder, a word at a time."""
+
+    name = 'mock'
+
+    def __init__(self, latency=0.5, error_rate=0.0):
+        self.latency = latency
+        self.error_rate = error_rate
+        self.rng = random.Random()
+
+    def answer(self, prompt):
+        if hashlib.sha256(prompt.encode()).digest()[0] < 52:
+            return ("1. Safety assessment: Suspicious\n"
+                    "2. The mock backend flags one file in five for load testing.\n"
+                    "4. Risk level: Medium\n"
+                    "5. Recommendation: treat as a test result, not a real assessment.")
+        return ("1. Safety assessment: Safe\n"
+                "2. The mock backend passes four files in five for load testing.\n"
+                "4. Risk level: Low\n"
+                "5. Recommendation: treat as a test result, not a real assessment.")
+
+    async def generate(self, prompt):
+        await asyncio.sleep(self.latency * self.rng.uniform(0.5, 1.5))
+        if self.rng.random() < self.error_rate:
+            raise RuntimeError("mock LLM error")
+        return self.answer(prompt)
+
+    async def stream(self, prompt):
+        latency = self.latency * self.rng.uniform(0.5, 1.5)
+        words = self.answer(prompt).split(' ')
+        # A failing call breaks off somewhere in the answer
+        fail_at = self.rng.randrange(len(words)) if self.rng.random() < self.error_rate else None
+        await asyncio.sleep(latency * 0.1)
+        for i, word in enumerate(words):
+            if i == fail_at:
+                raise RuntimeError("mock LLM error")
+            if i:
+                await asyncio.sleep(latency * 0.9 / len(words))
+            yield word if i == len(words) - 1 else word + ' '
+
+
+def default_backend():
+    """The backend SECUREGUARD_LLM_BACKEND names, or None for no LLM."""
+    api_key = os.getenv("GEMINI_API_KEY")
+    has_key = bool(api_key) and api_key != 'your_api_key_here'
+    choice = os.environ.get('SECUREGUARD_LLM_BACKEND', 'gemini' if has_key else 'none')
+    if choice == 'mock':
+        return MockBackend(_env('SECUREGUARD_MOCK_LLM_LATENCY', 0.5, float),
+                           _env('SECUREGUARD_MOCK_LLM_ERRORS', 0.0, float))
+    if choice == 'gemini' and has_key:
+        return GeminiBackend(api_key)
+    if choice not in ('gemini', 'none'):
+        print(f"[WARN] Unknown SECUREGUARD_LLM_BACKEND {choice!r}; LLM analysis disabled")
+    return None
+
+
+class LiveText:
+    """Answers still being written, by key, each with the change number of
+    its last chunk so a reader can ask for what changed since it looked.
+    Thread safe; nothing is kept once discarded."""
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.texts = {}  # key -> (change, text so far)
+        self.change = 0
+
+    def update(self, key, text):
+        with self.lock:
+            self.change += 1
+            self.texts[key] = (self.change, text)
+
+    def discard(self, key):
+        with self.lock:
+            self.texts.pop(key, None)
+
+    def since(self, change):
+        """(latest change, [(key, text)] updated after change)."""
+        with self.lock:
+            return self.change, [(key, text) for key, (c, text) in self.texts.items() if c > change]
+
+
+class TokenBucket:
+    """rate tokens a second, at most burst saved up. Used on one loop only."""
+
+    def __init__(self, rate, burst):
+        self.rate = rate
+        self.burst = burst
+        self.tokens = burst
+        self.stamp = time.monotonic()
+
+    async def take(self):
+        """Waits for a token; returns the seconds waited."""
+        waited = 0.0
+        while True:
+            now = time.monotonic()
+            self.tokens = min(self.burst, self.tokens + (now - self.stamp) * self.rate)
+            self.stamp = now
+            if self.tokens >= 1:
+                self.tokens -= 1
+                return waited
+            delay = (1 - self.tokens) / self.rate
+            await asyncio.sleep(delay)
+            waited += delay
+
+
+class LlmQueue:
+    def __init__(self, backend, concurrency=2, rate=15.0, burst=5, timeout=30.0, retries=2, capacity=256,
+                 on_change=None):
+        self.backend = backend
+        self.concurrency = max(1, concurrency)
+        self.rate = rate
+        self.burst = max(1, burst)
+        self.timeout = timeout
+        self.retries = max(0, retries)
+        self.capacity = max(1, capacity)
+        self.on_change = on_change
+        self.lock = threading.Lock()
+        self.slots = threading.BoundedSemaphore(self.capacity)
+        self.queued = 0
+        self.active = 0
+        self.completed = 0
+        self.failed = 0
+        self.skipped = 0
+        self.deferred = 0  # not queued: the queue was full
+        self.retried = 0
+        self.timeouts = 0
+        self.throttled = 0.0  # seconds spent waiting for the rate limit
+        self.latency = 0.0    # total seconds of successful calls
+        self.first_chunk = 0.0  # total seconds to the first streamed chunk
+        self.streamed = 0
+        self.loop = None
+        if backend is not None:
+            ready = threading.Event()
+            threading.Thread(target=self._run, args=(ready,), name="llm-queue", daemon=True).start()
+            ready.wait()
+
+    @property
+    def enabled(self):
+        return self.backend is not None
+
+    @property
+    def name(self):
+        return self.backend.name if self.backend is not None else None
+
+    def _run(self, ready):
+        self.loop = asyncio.new_event_loop()
+        asyncio.set_event_loop(self.loop)
+        self.bucket = TokenBucket(self.rate / 60.0, self.burst)
+        self.running = asyncio.Semaphore(self.concurrency)
+        ready.set()
+        self.loop.run_forever()
+
+    def reserve(self):
+        """Takes a place in the queue for one submit(..., reserved=True).
+        False, without waiting, when the queue is full."""
+        if self.slots.acquire(blocking=False):
+            return True
+        with self.lock:
+            self.deferred += 1
+        return False
+
+    def submit(self, prompt, done, cancelled=None, progress=None, reserved=False):
+        """Queue prompt; done(text, error) is called on the queue's thread
+        with the answer, or with text None once every attempt has failed
+        or when cancelled() turned true before the call was made. With
+        progress, the answer is streamed if the backend can and
+        progress(text so far) is called with every chunk; a retry starts
+        the text over. Never blocks: returns False, and done is never
+        called, when the queue is full (unless a place was reserved)."""
+        if not reserved and not self.reserve():
+            return False
+        with self.lock:
+            self.queued += 1
+        self._changed()
+        asyncio.run_coroutine_threadsafe(self._request(prompt, done, cancelled, progress), self.loop)
+        return True
+
+    async def _request(self, prompt, done, cancelled, progress):
+        async with self.running:
+            with self.lock:
+                self.queued -= 1
+                self.active += 1
+            self.slots.release()
+            self._changed()
+            try:
+                text, error = await self._attempts(prompt, cancelled, progress)
+            except Exception as e:
+                text, error = None, e
+            with self.lock:
+                self.active -= 1
+                if text is not None:
+                    self.completed += 1
+                elif error is not None:
+                    self.failed += 1
+                else:
+                    self.skipped += 1
+        self._changed()
+        try:
+            done(text, error)
+        except Exception:
+            traceback.print_exc()
+
+    async def _attempts(self, prompt, cancelled, progress):
+        error = None
+        for attempt in range(self.retries + 1):
+            if attempt:
+                with self.lock:
+                    self.retried += 1
+                await asyncio.sleep(BACKOFF * 2 ** (attempt - 1) * random.uniform(0.5, 1.5))
+            # Superseded while queued or backing off: no token, no call
+            if cancelled is not None and cancelled():
+                return None, None
+            waited = await self.bucket.take()
+            with self.lock:
+                self.throttled += waited
+            # Superseded while waiting for the token: the call is saved,
+            # though the token is spent
+            if cancelled is not None and cancelled():
+                return None, None
+            start = time.monotonic()
+            try:
+                text = await asyncio.wait_for(self._call(prompt, progress), self.timeout)
+            except asyncio.TimeoutError:
+                with self.lock:
+                    self.timeouts += 1
+                error = TimeoutError(f"no answer from {self.backend.name} within {self.timeout:g} s")
+                continue
+            except Exception as e:
+                error = e
+                continue
+            with self.lock:
+                self.latency += time.monotonic() - start
+            if text:
+                return text, None
+            error = ValueError(f"empty answer from {self.backend.name}")
+        return None, error
+
+    async def _call(self, prompt, progress):
+        stream = getattr(self.backend, 'stream', None)
+        if progress is None or stream is None:
+            return await self.backend.generate(prompt)
+        start = time.monotonic()
+        text = ''
+        async for chunk in stream(prompt):
+            if not text:
+                with self.lock:
+                    self.first_chunk += time.monotonic() - start
+                    self.streamed += 1
+            text += chunk
+            try:
+                progress(text)
+            except Exception:
+                traceback.print_exc()
+        return text
+
+    def _changed(self):
+        if self.on_change is not None:
+            self.on_change()
+
+    def depth(self):
+        """{'queued': n, 'active': n}, as AnalysisPool.depth()."""
+        with self.lock:
+            return {'queued': self.queued, 'active': self.active}
+
+    def stats(self):
+        with self.lock:
+            return {
+                'backend': self.name,
+                'queued': self.queued,
+                'active': self.active,
+                'concurrency': self.concurrency,
+                'capacity': self.capacity,
+                'rate_per_minute': self.rate,
+                'burst': self.burst,
+                'timeout': self.timeout,
+                'retries': self.retries,
+                'completed': self.completed,
+                'failed': self.failed,
+                'skipped': self.skipped,
+                'deferred': self.deferred,
+                'retried': self.retried,
+                'timeouts': self.timeouts,
+                'throttled_seconds': round(self.throttled, 3),
+                'mean_latency': round(self.latency / self.completed, 3) if self.completed else None,
+                'mean_first_chunk': round(self.first_chunk / self.streamed, 3) if self.streamed else None,
+            }
+
+
+def default_queue(on_change=None, backend=None):
+    return LlmQueue(backend if backend is not None else default_backend(),
+                    concurrency=_env('SECUREGUARD_LLM_WORKERS', 2, int),
+                    rate=max(0.01, _env('SECUREGUARD_LLM_RATE', 15.0, float)),
+                    burst=_env('SECUREGUARD_LLM_BURST', 5, int),
+                    timeout=_env('SECUREGUARD_LLM_TIMEOUT', 30.0, float),
+                    retries=_env('SECUREGUARD_LLM_RETRIES', 2, int),
+                    capacity=_env('SECUREGUARD_LLM_QUEUE', 256, int),
+                    on_change=on_change)
@@ -0,0 +1,392 @@
+"""ctypes bindings for the NativeAnalysis library (libsecureguard_native).
+
+The library memory-maps a file once and computes everything
+extract_file_features() needs in a single pass. When it is not built (or
+SECUREGUARD_NATIVE_LIB points nowhere) NATIVE_AVAILABLE is False and callers
+fall back to the pure-Python extractors.
+"""
+import ctypes
+import json
+import os
+import sys
+
+ABI_VERSION = 8
+
+_HERE = os.path.dirname(os.path.abspath(__file__))
+_LIB_DIR = os.path.join(_HERE, '..', 'NativeAnalysis')
+
+if sys.platform == 'win32':
+    _NAMES = ['secureguard_native.dll', os.path.join('release', 'secureguard_native.dll'),
+              os.path.join('debug', 'secureguard_native.dll')]
+elif sys.platform == 'darwin':
+    _NAMES = ['libsecureguard_native.dylib']
+else:
+    _NAMES = ['libsecureguard_native.so']
+
+
+class _Match(ctypes.Structure):
+    _fields_ = [('pattern', ctypes.c_uint), ('offset', ctypes.c_ulonglong)]
+
+
+class _CacheStats(ctypes.Structure):
+    _fields_ = [('entries', ctypes.c_uint), ('max_entries', ctypes.c_uint),
+                ('value_bytes', ctypes.c_ulonglong), ('heap_bytes', ctypes.c_ulonglong),
+                ('hits', ctypes.c_ulonglong), ('misses', ctypes.c_ulonglong),
+                ('insertions', ctypes.c_ulonglong), ('evictions', ctypes.c_ulonglong)]
+
+
+class _SimilarityMatch(ctypes.Structure):
+    _fields_ = [('id', ctypes.c_longlong), ('distance', ctypes.c_int)]
+
+
+class _SimilarityStats(ctypes.Structure):
+    _fields_ = [('entries', ctypes.c_ulonglong), ('capacity', ctypes.c_ulonglong),
+                ('additions', ctypes.c_ulonglong), ('queries', ctypes.c_ulonglong)]
+
+
+class _AllowlistStats(ctypes.Structure):
+    _fields_ = [('entries', ctypes.c_ulonglong), ('bloom_bytes', ctypes.c_ulonglong),
+                ('lookups', ctypes.c_ulonglong), ('bloom_rejects', ctypes.c_ulonglong),
+                ('hits', ctypes.c_ulonglong)]
+
+
+class _RulesInfo(ctypes.Structure):
+    _fields_ = [('rules', ctypes.c_ulonglong), ('strings', ctypes.c_ulonglong),
+                ('fingerprint', ctypes.c_char * 65)]
+
+
+def _load():
+    candidates = [os.environ.get('SECUREGUARD_NATIVE_LIB')] + [os.path.join(_LIB_DIR, n) for n in _NAMES]
+    for path in candidates:
+        if not path or not os.path.exists(path):
+            continue
+        try:
+            lib = ctypes.CDLL(path)
+        except OSError as e:
+            print(f"[WARN] Could not load native library {path}: {e}")
+            continue
+        lib.sg_abi_version.restype = ctypes.c_int
+        if lib.sg_abi_version() != ABI_VERSION:
+            print(f"[WARN] Ignoring {path}: ABI version {lib.sg_abi_version()}, expected {ABI_VERSION}")
+            continue
+        # c_void_p, not c_char_p, so the pointer survives to be freed
+        lib.sg_extract_features_json.restype = ctypes.c_void_p
+        lib.sg_extract_features_json.argtypes = [ctypes.c_char_p]
+        lib.sg_file_entropy.restype = ctypes.c_int
+        lib.sg_file_entropy.argtypes = [ctypes.c_char_p, ctypes.POINTER(ctypes.c_double)]
+        lib.sg_entropy_profile.restype = ctypes.c_longlong
+        lib.sg_entropy_profile.argtypes = [ctypes.c_char_p, ctypes.c_ulonglong, ctypes.c_ulonglong,
+                                           ctypes.POINTER(ctypes.c_double), ctypes.c_ulonglong]
+        lib.sg_histogram_kernel.restype = ctypes.c_char_p
+        lib.sg_matcher_create.restype = ctypes.c_void_p
+        lib.sg_matcher_create.argtypes = [ctypes.POINTER(ctypes.c_char_p), ctypes.POINTER(ctypes.c_ulonglong),
+                                          ctypes.c_int, ctypes.c_int]
+        lib.sg_matcher_free.restype = None
+        lib.sg_matcher_free.argtypes = [ctypes.c_void_p]
+        lib.sg_matcher_scan.restype = ctypes.c_longlong
+        lib.sg_matcher_scan.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_ulonglong,
+                                        ctypes.POINTER(_Match), ctypes.c_ulonglong, ctypes.c_int]
+        lib.sg_matcher_scan_file.restype = ctypes.c_longlong
+        lib.sg_matcher_scan_file.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.POINTER(_Match),
+                                             ctypes.c_ulonglong, ctypes.c_int]
+        lib.sg_cache_open.restype = ctypes.c_void_p
+        lib.sg_cache_open.argtypes = [ctypes.c_char_p, ctypes.c_char_p, ctypes.c_ulonglong, ctypes.c_uint]
+        lib.sg_cache_close.restype = None
+        lib.sg_cache_close.argtypes = [ctypes.c_void_p]
+        lib.sg_cache_get.restype = ctypes.c_void_p
+        lib.sg_cache_get.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.POINTER(ctypes.c_ulonglong)]
+        lib.sg_cache_put.restype = ctypes.c_int
+        lib.sg_cache_put.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p, ctypes.c_ulonglong]
+        lib.sg_cache_clear.restype = None
+        lib.sg_cache_clear.argtypes = [ctypes.c_void_p]
+        lib.sg_cache_stats_get.restype = ctypes.c_int
+        lib.sg_cache_stats_get.argtypes = [ctypes.c_void_p, ctypes.POINTER(_CacheStats)]
+        lib.sg_similarity_distance.restype = ctypes.c_int
+        lib.sg_similarity_distance.argtypes = [ctypes.c_char_p, ctypes.c_char_p]
+        lib.sg_similarity_index_create.restype = ctypes.c_void_p
+        lib.sg_similarity_index_create.argtypes = [ctypes.c_ulonglong]
+        lib.sg_similarity_index_free.restype = None
+        lib.sg_similarity_index_free.argtypes = [ctypes.c_void_p]
+        lib.sg_similarity_index_add.restype = ctypes.c_int
+        lib.sg_similarity_index_add.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_longlong]
+        lib.sg_similarity_index_query.restype = ctypes.c_int
+        lib.sg_similarity_index_query.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_int,
+                                                  ctypes.POINTER(_SimilarityMatch), ctypes.c_int]
+        lib.sg_similarity_index_stats_get.restype = ctypes.c_int
+        lib.sg_similarity_index_stats_get.argtypes = [ctypes.c_void_p, ctypes.POINTER(_SimilarityStats)]
+        lib.sg_allowlist_open.restype = ctypes.c_void_p
+        lib.sg_allowlist_open.argtypes = [ctypes.c_char_p]
+        lib.sg_allowlist_close.restype = None
+        lib.sg_allowlist_close.argtypes = [ctypes.c_void_p]
+        lib.sg_allowlist_contains.restype = ctypes.c_int
+        lib.sg_allowlist_contains.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+        lib.sg_allowlist_stats_get.restype = ctypes.c_int
+        lib.sg_allowlist_stats_get.argtypes = [ctypes.c_void_p, ctypes.POINTER(_AllowlistStats)]
+        lib.sg_rules_compile.restype = ctypes.c_void_p
+        lib.sg_rules_compile.argtypes = [ctypes.c_char_p, ctypes.POINTER(ctypes.c_void_p)]
+        lib.sg_rules_free.restype = None
+        lib.sg_rules_free.argtypes = [ctypes.c_void_p]
+        lib.sg_rules_info_get.restype = ctypes.c_int
+        lib.sg_rules_info_get.argtypes = [ctypes.c_void_p, ctypes.POINTER(_RulesInfo)]
+        lib.sg_extract_features_rules_json.restype = ctypes.c_void_p
+        lib.sg_extract_features_rules_json.argtypes = [ctypes.c_char_p, ctypes.c_void_p, ctypes.c_char_p,
+                                                       ctypes.c_char_p]
+        lib.sg_free.restype = None
+        lib.sg_free.argtypes = [ctypes.c_void_p]
+        return lib
+    return None
+
+
+_lib = _load()
+NATIVE_AVAILABLE = _lib is not None
+
+
+def _take_json(ptr):
+    if not ptr:
+        return None
+    try:
+        return json.loads(ctypes.string_at(ptr).decode('utf-8'))
+    finally:
+        _lib.sg_free(ptr)
+
+
+def extract_native(file_path):
+    """Single-pass features for file_path, or None if unavailable/unreadable.
+
+    Keys match extract_file_features() except mime_type/magic_type (left to
+    the caller), plus 'md5' and raw 'ctime'/'mtime' epoch seconds.
+    """
+    if _lib is None:
+        return None
+    return _take_json(_lib.sg_extract_features_json(os.fsencode(file_path)))
+
+
+def file_entropy(file_path):
+    """Whole-file Shannon entropy (unrounded), or None."""
+    if _lib is None:
+        return None
+    value = ctypes.c_double()
+    if _lib.sg_file_entropy(os.fsencode(file_path), ctypes.byref(value)) != 0:
+        return None
+    return value.value
+
+
+def entropy_profile(file_path, window=4096, step=4096):
+    """Entropy of each window of the file, or None."""
+    if _lib is None:
+        return None
+    path = os.fsencode(file_path)
+    count = _lib.sg_entropy_profile(path, window, step, None, 0)
+    if count < 0:
+        return None
+    out = (ctypes.c_double * count)()
+    if count and _lib.sg_entropy_profile(path, window, step, out, count) < 0:
+        return None
+    return list(out)
+
+
+def histogram_kernel():
+    return _lib.sg_histogram_kernel().decode() if _lib is not None else None
+
+
+class NativeMatcher:
+    """All patterns compiled into one case-insensitive automaton.
+
+    With regex=True patterns use predict.py's subset: '\\' escapes the next
+    byte and an unescaped '.' matches anything but a newline. Scans return
+    (pattern index, start offset) pairs in input order, or None on error.
+    """
+
+    def __init__(self, patterns, regex=True):
+        count = len(patterns)
+        self._handle = _lib.sg_matcher_create((ctypes.c_char_p * count)(*patterns),
+                                              (ctypes.c_ulonglong * count)(*map(len, patterns)),
+                                              count, 1 if regex else 0)
+        if not self._handle:
+            raise ValueError("unsupported pattern set")
+
+    def __del__(self):
+        if getattr(self, '_handle', None) and _lib is not None:
+            _lib.sg_matcher_free(self._handle)
+
+    def _collect(self, scan, first_only):
+        # Usually one call; a second only when hits overflow the buffer
+        capacity = 1 if first_only else 256
+        out = (_Match * capacity)()
+        count = scan(out, capacity, 1 if first_only else 0)
+        if count > capacity:
+            capacity = count
+            out = (_Match * capacity)()
+            count = scan(out, capacity, 0)
+        if count < 0:
+            return None
+        return [(m.pattern, m.offset) for m in out[:count]]
+
+    def scan(self, data, first_only=False):
+        return self._collect(lambda out, cap, first: _lib.sg_matcher_scan(self._handle, data, len(data),
+                                                                          out, cap, first), first_only)
+
+    def scan_file(self, file_path, first_only=False):
+        path = os.fsencode(file_path)
+        return self._collect(lambda out, cap, first: _lib.sg_matcher_scan_file(self._handle, path,
+                                                                               out, cap, first), first_only)
+
+
+def native_matcher(patterns, regex=True):
+    """NativeMatcher for patterns, or None when the library is unavailable."""
+    if _lib is None:
+        return None
+    try:
+        return NativeMatcher(patterns, regex)
+    except ValueError:
+        return None
+
+
+class NativeVerdictCache:
+    """The library's mmap-backed SHA-256 -> bytes table (VerdictCache.h)."""
+
+    def __init__(self, path, version, max_bytes, max_entries):
+        self._handle = _lib.sg_cache_open(os.fsencode(path), version.encode(), max_bytes, max_entries)
+        if not self._handle:
+            raise OSError(f"cannot open verdict cache {path}")
+
+    def __del__(self):
+        if getattr(self, '_handle', None) and _lib is not None:
+            _lib.sg_cache_close(self._handle)
+
+    def get(self, sha256):
+        length = ctypes.c_ulonglong()
+        ptr = _lib.sg_cache_get(self._handle, sha256.encode(), ctypes.byref(length))
+        if not ptr:
+            return None
+        try:
+            return ctypes.string_at(ptr, length.value)
+        finally:
+            _lib.sg_free(ptr)
+
+    def put(self, sha256, value):
+        return _lib.sg_cache_put(self._handle, sha256.encode(), value, len(value)) == 0
+
+    def clear(self):
+        _lib.sg_cache_clear(self._handle)
+
+    def stats(self):
+        out = _CacheStats()
+        _lib.sg_cache_stats_get(self._handle, ctypes.byref(out))
+        return {name: getattr(out, name) for name, _ in _CacheStats._fields_}
+
+
+def native_verdict_cache(path, version, max_bytes, max_entries):
+    """NativeVerdictCache, or None when the library is missing or the file
+    cannot be opened (e.g. another process holds it)."""
+    if _lib is None:
+        return None
+    try:
+        return NativeVerdictCache(path, version, max_bytes, max_entries)
+    except OSError as e:
+        print(f"[WARN] {e}")
+        return None
+
+
+class NativeSimilarityIndex:
+    """The library's top-k index over similarity digests (SimilarityIndex.h)."""
+
+    def __init__(self, capacity):
+        self._handle = _lib.sg_similarity_index_create(capacity)
+        if not self._handle:
+            raise MemoryError("cannot create similarity index")
+
+    def __del__(self):
+        if getattr(self, '_handle', None) and _lib is not None:
+            _lib.sg_similarity_index_free(self._handle)
+
+    def add(self, digest, record_id):
+        return _lib.sg_similarity_index_add(self._handle, digest.encode(), record_id) == 0
+
+    def query(self, digest, k, max_distance):
+        """[(id, distance)], closest first."""
+        out = (_SimilarityMatch * k)()
+        count = _lib.sg_similarity_index_query(self._handle, digest.encode(), max_distance, out, k)
+        return [(m.id, m.distance) for m in out[:max(count, 0)]]
+
+    def stats(self):
+        out = _SimilarityStats()
+        _lib.sg_similarity_index_stats_get(self._handle, ctypes.byref(out))
+        return {name: getattr(out, name) for name, _ in _SimilarityStats._fields_}
+
+
+def native_similarity_index(capacity):
+    """NativeSimilarityIndex, or None when the library is unavailable."""
+    if _lib is None:
+        return None
+    return NativeSimilarityIndex(capacity)
+
+
+class NativeAllowlist:
+    """The library's memory-mapped known-good SHA-256 list (Allowlist.h)."""
+
+    def __init__(self, path):
+        self._handle = _lib.sg_allowlist_open(os.fsencode(path))
+        if not self._handle:
+            raise OSError(f"cannot open allowlist {path}")
+
+    def __del__(self):
+        if getattr(self, '_handle', None) and _lib is not None:
+            _lib.sg_allowlist_close(self._handle)
+
+    def contains(self, sha256):
+        return _lib.sg_allowlist_contains(self._handle, sha256.encode()) == 1
+
+    def stats(self):
+        out = _AllowlistStats()
+        _lib.sg_allowlist_stats_get(self._handle, ctypes.byref(out))
+        return {name: getattr(out, name) for name, _ in _AllowlistStats._fields_}
+
+
+def native_allowlist(path):
+    """NativeAllowlist, or None when the library is missing or the file
+    cannot be opened."""
+    if _lib is None:
+        return None
+    try:
+        return NativeAllowlist(path)
+    except OSError as e:
+        print(f"[WARN] {e}")
+        return None
+
+
+class NativeRules:
+    """Detection rules compiled by the library (RuleSet.h). Immutable, so
+    one instance may be shared by the analysis threads."""
+
+    def __init__(self, source):
+        error = ctypes.c_void_p()
+        self._handle = _lib.sg_rules_compile(source.encode(), ctypes.byref(error))
+        if not self._handle:
+            message = 'cannot compile rules'
+            if error.value:
+                message = ctypes.string_at(error.value).decode('utf-8', 'replace')
+                _lib.sg_free(error.value)
+            raise ValueError(message)
+        info = _RulesInfo()
+        _lib.sg_rules_info_get(self._handle, ctypes.byref(info))
+        self.rule_count, self.string_count = info.rules, info.strings
+        self.fingerprint = info.fingerprint.decode()
+
+    def __del__(self):
+        if getattr(self, '_handle', None) and _lib is not None:
+            _lib.sg_rules_free(self._handle)
+
+    def extract(self, file_path, mime, magic_type):
+        """extract_native() plus 'rules': {'suspicious', 'matched'}, with the
+        rules' strings searched in the same pass; None if unreadable."""
+        return _take_json(_lib.sg_extract_features_rules_json(os.fsencode(file_path), self._handle,
+                                                              mime.encode(), magic_type.encode()))
+
+
+def native_rules(source):
+    """NativeRules, or None when the library is unavailable. Raises
+    ValueError with the line and reason when the source does not compile."""
+    if _lib is None:
+        return None
+    return NativeRules(source)
@@ -1,5 +1,8 @@
-import os
+"""The built-in detection checks, which rule_engine applies when the rules
+cannot be compiled natively."""
 import re
+from chunked_io import overlapping_chunks
+from native_features import native_matcher
 
 # List of suspicious file extensions
 SUSPICIOUS_EXTENSIONS = [
@@ -21,39 +24,23 @@ SUSPICIOUS_PATTERNS = [
     rb'system\(', rb'passthru', rb'proc_open', rb'popen'
 ]
 
-def predict_file(file_path):
-    """
-    Perform basic rule-based safety prediction on a file.
-    Returns 'suspicious' or 'safe'
-    """
-    # Check if file exists
-    if not os.path.exists(file_path):
-        return "suspicious"  # Treat missing files as suspicious
-    
-    # Check file extension
-    _, ext = os.path.splitext(file_path.lower())
-    if ext in SUSPICIOUS_EXTENSIONS:
-        return "suspicious"
-    
-    # Check file size
-    try:
-        file_size = os.path.getsize(file_path)
-        if file_size > 10 * 1024 * 1024:  # Files larger than 10MB
-            return "suspicious"
-        
-        # For smaller files, check content for suspicious patterns
-        if file_size < 5 * 1024 * 1024:  # Only scan files smaller than 5MB
-            try:
-                with open(file_path, 'rb') as f:
-                    content = f.read()
-                    for pattern in SUSPICIOUS_PATTERNS:
-                        if re.search(pattern, content, re.IGNORECASE):
-                            return "suspicious"
-            except Exception:
-                # If we can't read the file, consider it suspicious
-                return "suspicious"
-    except Exception:
-        return "suspicious"
-    
-    # If no suspicious indicators found
-    return "safe"
\ No newline at end of file
+# Every pattern in one pass over the content: the native automaton when the
+# library is built, otherwise a single compiled alternation
+_NATIVE_PATTERNS = native_matcher(SUSPICIOUS_PATTERNS)
+_COMBINED_PATTERN = re.compile(b'|'.join(SUSPICIOUS_PATTERNS), re.IGNORECASE)
+# Bytes each pattern matches; chunks overlap by one less than the longest
+_PATTERN_LENGTHS = [len(re.sub(rb'\\(.)', rb'\1', p)) for p in SUSPICIOUS_PATTERNS]
+_PATTERN_OVERLAP = max(_PATTERN_LENGTHS) - 1
+
+
+def contains_suspicious_pattern(file_path):
+    """True if any of SUSPICIOUS_PATTERNS occurs in the file. Reads in
+    fixed-size chunks, so files of any size take the same memory."""
+    if _NATIVE_PATTERNS is not None:
+        hits = _NATIVE_PATTERNS.scan_file(file_path, first_only=True)
+        if hits is not None:
+            return bool(hits)
+    for window, _, _ in overlapping_chunks(file_path, _PATTERN_OVERLAP):
+        if _COMBINED_PATTERN.search(window):
+            return True
+    return False
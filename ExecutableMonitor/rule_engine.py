@@ -0,0 +1,150 @@
+"""Detection rules, compiled by the native library and reloaded when edited.
+
+The rules (rules/default.rules, language described in NativeAnalysis/
+RuleSet.h) are evaluated in the extraction pass: their strings ride along
+the same automaton scan, so a rule costs no extra read of the file. The file
+is checked for changes at most once a second; a version that does not
+compile is reported and the previous rules stay in force. Without the
+native library the built-in checks of predict.py apply, with the same rule
+names and sentences.
+
+    SECUREGUARD_RULES  rules file (default: rules/default.rules next to this file)
+"""
+import hashlib
+import os
+import threading
+import time
+from datetime import datetime
+
+from native_features import NATIVE_AVAILABLE, native_rules
+from predict import SUSPICIOUS_EXTENSIONS, SUSPICIOUS_PATTERNS, contains_suspicious_pattern
+
+RELOAD_INTERVAL = 1.0  # seconds between checks of the rules file
+PACKED_SECTION_ENTROPY = 7.2  # PeParser::kPackedEntropy
+LEGACY_FINGERPRINT = hashlib.sha256(repr((SUSPICIOUS_EXTENSIONS, SUSPICIOUS_PATTERNS)).encode()).hexdigest()
+
+_HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+def format_size(size):
+    return f"{size / (1024 * 1024):.2f} MB" if size > 1024*1024 else f"{size / 1024:.2f} KB"
+
+
+def _match(name, description, suspicious=False):
+    return {'name': name, 'tags': ['suspicious'] if suspicious else [], 'description': description}
+
+
+def legacy_evaluation(features, file_path):
+    """default.rules, hard-coded, for when the rules cannot be compiled."""
+    matched = []
+    ext = features.get('extension', '').lower()
+    if ext in SUSPICIOUS_EXTENSIONS:
+        matched.append(_match('Suspicious_Extension', f"The {ext} extension is commonly used to run code.", True))
+    try:
+        content = contains_suspicious_pattern(file_path)
+    except Exception:
+        content = True  # unreadable counts as suspicious
+    if content:
+        matched.append(_match('Suspicious_Content',
+                              "Content mentions command interpreters or scripting APIs often used by malware.", True))
+    if features.get('entropy', 0) > 7.0:
+        matched.append(_match('High_Entropy', "High entropy detected (>7.0), which may indicate encryption, "
+                                              "compression, or obfuscation."))
+    if features.get('is_executable', False) and not features.get('has_digital_signature', False):
+        matched.append(_match('Unsigned_Executable', "Executable file without a valid digital signature."))
+    if features.get('suspicious_strings', []):
+        matched.append(_match('Suspicious_Strings',
+                              f"Found {len(features['suspicious_strings'])} potentially suspicious strings."))
+    mime, magic_type = features.get('mime_type', ''), features.get('magic_type', '')
+    if mime != 'unknown' and magic_type != 'unknown' \
+            and ext not in mime.lower() and ext not in magic_type.lower():
+        matched.append(_match('Extension_Mismatch', "Possible file extension mismatch with actual content type."))
+
+    # Native extractor only: TLS callbacks, overlay, packed sections
+    pe = features.get('pe_details', {})
+    if pe.get('tls_callbacks'):
+        matched.append(_match('Tls_Callbacks', f"Has {len(pe['tls_callbacks'])} TLS callback(s), "
+                                               "which run before the entry point."))
+    if pe.get('overlay_payload_size'):
+        matched.append(_match('Overlay', f"{format_size(pe['overlay_payload_size'])} of data appended after "
+                                         "the last section (overlay)."))
+    packed = [s['name'] for s in pe.get('sections', []) if s.get('entropy', 0) > PACKED_SECTION_ENTROPY]
+    if packed:
+        matched.append(_match('Packed_Sections', f"Packed or encrypted sections "
+                                                 f"(entropy >{PACKED_SECTION_ENTROPY:.1f}): {', '.join(packed)}."))
+    return {'suspicious': any('suspicious' in m['tags'] for m in matched), 'matched': matched}
+
+
+class RuleEngine:
+    def __init__(self, path=None):
+        self.path = path or os.environ.get('SECUREGUARD_RULES') or os.path.join(_HERE, 'rules', 'default.rules')
+        self.lock = threading.Lock()
+        self.rules = None  # NativeRules in force
+        self.stamp = None  # (mtime_ns, size) of the file they came from
+        self.checked = 0.0
+        self.loaded_at = None
+        self.reloads = 0
+        self.error = None
+        if NATIVE_AVAILABLE:
+            self._reload()
+        else:
+            self.error = "native library unavailable; using the built-in rules"
+
+    def _reload(self):
+        try:
+            stat = os.stat(self.path)
+            stamp = (stat.st_mtime_ns, stat.st_size)
+            if stamp == self.stamp:
+                return
+            self.stamp = stamp
+            with open(self.path, encoding='utf-8') as f:
+                rules = native_rules(f.read())
+        except (OSError, UnicodeDecodeError, ValueError) as e:
+            self.error = f"{self.path}: {e}"
+            fallback = 'keeping the previous ones' if self.rules else 'using the built-in rules'
+            print(f"[WARN] Rules not (re)loaded, {fallback}: {self.error}")
+            return
+        if self.rules is not None:
+            self.reloads += 1
+        self.rules, self.error = rules, None
+        self.loaded_at = datetime.now().isoformat()
+        print(f"[INFO] Rules: {rules.rule_count} rules, {rules.string_count} strings from {self.path}")
+
+    def current(self):
+        """The rules to analyse the next file with (None: the built-in ones),
+        after picking up any edit to the file."""
+        if not NATIVE_AVAILABLE:
+            return None
+        with self.lock:
+            now = time.monotonic()
+            if now - self.checked >= RELOAD_INTERVAL:
+                self.checked = now
+                self._reload()
+            return self.rules
+
+    @staticmethod
+    def fingerprint(rules):
+        """Identifies the rules in verdict cache keys."""
+        return rules.fingerprint if rules is not None else LEGACY_FINGERPRINT
+
+    @staticmethod
+    def evaluate(features, file_path):
+        """{'suspicious', 'matched': [{'name', 'tags', 'description'}]} for
+        features from extract_file_features(file_path, rules). Takes the
+        native evaluation out of features, which go on to the LLM as is."""
+        evaluation = features.pop('rules', None)
+        return evaluation if evaluation is not None else legacy_evaluation(features, file_path)
+
+    def stats(self):
+        with self.lock:
+            rules = self.rules
+            return {
+                'enabled': rules is not None,
+                'path': self.path,
+                'rules': rules.rule_count if rules else 0,
+                'strings': rules.string_count if rules else 0,
+                'fingerprint': self.fingerprint(rules),
+                'loaded_at': self.loaded_at,
+                'reloads': self.reloads,
+                'error': self.error,
+            }
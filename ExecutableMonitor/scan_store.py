@@ -0,0 +1,131 @@
+"""The on-disk store behind the file history and the URL scan history.
+
+One SQLite database in WAL mode, shared by server.py and URL/app.py. Writes
+append to the write-ahead log, which SQLite checkpoints into the main file
+every thousand pages; after a crash, opening replays only the log tail since
+that checkpoint. Nothing is loaded up front: pages and lookups are indexed
+queries (time, hash, verdict, path, change sequence), so opening takes a few
+milliseconds with a million records as with ten.
+
+    SECUREGUARD_HISTORY_DB  database file (default: history.sqlite in the user cache dir)
+"""
+import json
+import os
+import sqlite3
+import threading
+import time
+import uuid
+
+from verdict_cache import default_path
+
+SCHEMA_VERSION = 1
+SCHEMA = """
+CREATE TABLE IF NOT EXISTS meta (key TEXT PRIMARY KEY, value TEXT NOT NULL);
+CREATE TABLE IF NOT EXISTS files (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,  -- never reused, even once evicted
+    seq INTEGER NOT NULL,
+    path TEXT NOT NULL,
+    name TEXT NOT NULL,
+    name_key TEXT NOT NULL,
+    type TEXT NOT NULL,
+    hash TEXT,
+    added REAL NOT NULL,
+    summary TEXT,
+    details TEXT
+);
+CREATE INDEX IF NOT EXISTS files_seq ON files (seq);
+CREATE INDEX IF NOT EXISTS files_path ON files (path);
+CREATE INDEX IF NOT EXISTS files_added ON files (added);
+CREATE INDEX IF NOT EXISTS files_hash ON files (hash);
+CREATE INDEX IF NOT EXISTS files_type ON files (type, id);
+CREATE INDEX IF NOT EXISTS files_name ON files (name_key, id);
+CREATE TABLE IF NOT EXISTS urls (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    url TEXT NOT NULL,
+    classification TEXT NOT NULL,
+    scanned REAL NOT NULL,
+    result TEXT NOT NULL
+);
+CREATE INDEX IF NOT EXISTS urls_scanned ON urls (scanned);
+CREATE INDEX IF NOT EXISTS urls_url ON urls (url);
+CREATE INDEX IF NOT EXISTS urls_classification ON urls (classification, id);
+"""
+
+
+def database_path():
+    return os.environ.get('SECUREGUARD_HISTORY_DB') \
+        or os.path.join(os.path.dirname(default_path()), 'history.sqlite')
+
+
+def connect(path=None):
+    """An open connection, schema in place, for use under the caller's lock."""
+    path = path or database_path()
+    os.makedirs(os.path.dirname(os.path.abspath(path)), exist_ok=True)
+    db = sqlite3.connect(path, check_same_thread=False, isolation_level=None)
+    db.execute("PRAGMA journal_mode=WAL")
+    db.execute("PRAGMA synchronous=NORMAL")  # a power cut may lose the last commits, never the file
+    db.execute("PRAGMA busy_timeout=5000")  # the other service may be writing
+    db.executescript(SCHEMA)
+    version = meta(db, 'schema', lambda: str(SCHEMA_VERSION))
+    if version != str(SCHEMA_VERSION):
+        raise sqlite3.DatabaseError(f"{path}: schema {version}, expected {SCHEMA_VERSION}")
+    return db
+
+
+def meta(db, key, default):
+    """The stored value of key, set to default() the first time."""
+    row = db.execute("SELECT value FROM meta WHERE key = ?", (key,)).fetchone()
+    if row is not None:
+        return row[0]
+    value = default()
+    db.execute("INSERT OR IGNORE INTO meta (key, value) VALUES (?, ?)", (key, value))
+    return db.execute("SELECT value FROM meta WHERE key = ?", (key,)).fetchone()[0]
+
+
+def new_epoch():
+    return uuid.uuid4().hex[:16]
+
+
+class UrlHistory:
+    """URL verdicts, newest first, for the GUI's scan results list."""
+
+    MAX_PAGE = 500
+
+    def __init__(self, path=None):
+        self.db = connect(path)
+        self.lock = threading.Lock()
+
+    def add(self, url, classification, result):
+        with self.lock:
+            cursor = self.db.execute("INSERT INTO urls (url, classification, scanned, result) VALUES (?, ?, ?, ?)",
+                                     (url, classification, time.time(), json.dumps(result)))
+            return cursor.lastrowid
+
+    def page(self, limit=50, before=None, classification=None):
+        """{'urls': [{'id', 'url', 'classification', 'scanned'}], 'next'}:
+        scans older than id `before`, newest first; next is the `before`
+        of the following page (None after the last)."""
+        limit = max(1, min(limit, self.MAX_PAGE))
+        where, args = [], []
+        if before is not None:
+            where.append("id < ?")
+            args.append(before)
+        if classification:
+            where.append("classification = ?")
+            args.append(classification)
+        sql = "SELECT id, url, classification, scanned FROM urls"
+        if where:
+            sql += " WHERE " + " AND ".join(where)
+        with self.lock:
+            rows = self.db.execute(sql + " ORDER BY id DESC LIMIT ?", args + [limit + 1]).fetchall()
+        urls = [{'id': r[0], 'url': r[1], 'classification': r[2], 'scanned': r[3]} for r in rows[:limit]]
+        return {'urls': urls, 'next': urls[-1]['id'] if len(rows) > limit else None}
+
+    def get(self, scan_id):
+        with self.lock:
+            row = self.db.execute("SELECT id, url, classification, scanned, result FROM urls WHERE id = ?",
+                                  (scan_id,)).fetchone()
+        if row is None:
+            return None
+        return {'id': row[0], 'url': row[1], 'classification': row[2], 'scanned': row[3],
+                'result': json.loads(row[4])}
@@ -1,19 +1,29 @@
 import os
 import json
-import time
-import threading
-from fastapi import FastAPI
-from fastapi.responses import FileResponse, JSONResponse, Response
+import hashlib
+import asyncio
+from datetime import datetime
+from fastapi import FastAPI, HTTPException, Query, Request
+from fastapi.responses import FileResponse, JSONResponse, Response, StreamingResponse
 from fastapi.middleware.cors import CORSMiddleware
 import uvicorn
 from watchdog.observers import Observer
 from watchdog.events import FileSystemEventHandler
-import google.generativeai as genai
 from dotenv import load_dotenv
 
 # Import from local files
-from extract_features import extract_file_features
-from predict import predict_file
+from allowlist import Allowlist
+from analysis_pool import default_pool
+from coalescer import Coalescer
+from extract_features import extract_file_features, get_file_extension, get_mime_type, get_sha256
+from history import FileHistory
+from llm_cache import PROMPT_VERSION, LlmAnswerCache, LlmRequest
+from llm_queue import LiveText, default_queue
+from rule_engine import RuleEngine, format_size
+from similarity_index import SimilarityIndex
+from verdict_cache import VerdictCache
+from write_completion import WriteTracker, is_partial_download
+from wire_format import negotiated_response
 
 # Load environment variables
 load_dotenv()
@@ -32,59 +42,264 @@ app.add_middleware(
 
 # Global variables
 WATCHED_DIR = "C:/Users/hp/Downloads"  # Directory to monitor
-analyzed_files = []  # Store analyzed files
 observer = None  # Watchdog observer instance
+file_handler = None  # its FileEventHandler
+
+# File records, on disk and bounded by count and age, with the change feed
+# for delta and stream clients and pages for history
+history = FileHistory()
+# Names the history database: cursors survive a restart, and clients of a
+# new database are told to reset
+SERVER_EPOCH = history.epoch
+
+# Event stream wakeup. publish() runs on watcher threads, so it hands the
+# notification to the server loop, which swaps in a fresh asyncio.Event.
+event_loop = None
+files_changed = None
+STREAM_KEEPALIVE = 15  # seconds between comment lines on an idle stream
+
+# Bump when analyze_file changes what it reports; together with the LLM
+# backend this versions the verdict cache. The rules, which can change while
+# running, are part of each key instead.
+ANALYSIS_VERSION = 4
+
+
+def analysis_version():
+    llm = (llm_queue.name, PROMPT_VERSION) if llm_queue.enabled else None
+    return f"{ANALYSIS_VERSION}-{hashlib.sha256(repr(llm).encode()).hexdigest()[:16]}"
+
+
+def verdict_key(file_path, sha256, rules_fingerprint):
+    """Cache key: the content hash, plus the extension, which the rules and
+    is_executable also look at, and the rules themselves."""
+    return hashlib.sha256(f"{sha256}{get_file_extension(file_path)}{rules_fingerprint}".encode()).hexdigest()
+
+
+def allowlisted_details(file_path, sha256):
+    """Details for a file on the allowlist, which is not analysed."""
+    stat = os.stat(file_path)
+    return {
+        'size': format_size(stat.st_size),
+        'ext': get_file_extension(file_path),
+        'mime': get_mime_type(file_path),
+        'hash': sha256,
+        'created_at': datetime.fromtimestamp(stat.st_ctime).isoformat(),
+        'modified_at': datetime.fromtimestamp(stat.st_mtime).isoformat(),
+        'rule': "Known-good file: its SHA-256 is on the allowlist, so it was not analysed.",
+        'gemini': "Not needed for an allowlisted file.",
+        'allowlisted': True,
+    }
+
+
+def _wake_streams():
+    global files_changed
+    files_changed.set()
+    files_changed = asyncio.Event()
+
+
+def _queue_changed():
+    # Streams compare the queue depth on every wakeup and send it if it moved
+    if event_loop is not None:
+        event_loop.call_soon_threadsafe(_wake_streams)
+
+
+# Bounded per-stage workers (io / cpu) instead of a thread per file
+analysis_pool = default_pool(on_change=_queue_changed)
+# Gemini (or its mock) on an async, rate-limited queue of its own; the
+# rule-based verdict is shown without waiting for it
+llm_queue = default_queue(on_change=_queue_changed)
+# Gemini answers as they stream in, by record id; sent as 'analysis' events
+# and dropped once the final text is published with the record
+live_analysis = LiveText()
+# Gemini answers by feature fingerprint: files whose relevant features match
+# an earlier one's get its answer without a call
+llm_cache = LlmAnswerCache(llm_queue.name) if llm_queue.enabled else None
+verdict_cache = VerdictCache(analysis_version())
+# Earlier files with a close similarity digest (variants of one family)
+similarity_index = SimilarityIndex()
+# Known-good hashes (e.g. the NSRL); listed files skip analysis altogether
+allowlist = Allowlist()
+rule_engine = RuleEngine()
+
+
+def publish(file_info):
+    """Record a change to file_info so delta and stream clients pick it up."""
+    history.publish(file_info)
+    if event_loop is not None:
+        event_loop.call_soon_threadsafe(_wake_streams)
+
+
+def analysis_depth():
+    """Backlog across the analysis stages and the LLM queue."""
+    pool, llm = analysis_pool.depth(), llm_queue.depth()
+    return {'queued': pool['queued'] + llm['queued'], 'active': pool['active'] + llm['active']}
+
+
+def gemini_verdict(verdict, text):
+    """The rule-based verdict, raised to suspicious if Gemini says so."""
+    lowered = text.lower()
+    if "suspicious" in lowered or "malicious" in lowered or "high risk" in lowered:
+        return 'suspicious'
+    return verdict
+
 
 class FileEventHandler(FileSystemEventHandler):
     def __init__(self):
-        self.api_key = os.getenv("GEMINI_API_KEY")
-        if self.api_key:
-            genai.configure(api_key=self.api_key)
-        
+        # Completed writes are merged per path before they reach the pool
+        self.coalescer = Coalescer(self.start_analysis)
+        self.writes = WriteTracker(self.coalescer.request)
+
     def on_created(self, event):
+        # Browser temp files are skipped; their rename to the final name
+        # arrives as on_moved
+        if event.is_directory or is_partial_download(event.src_path):
+            return
+        file_path = event.src_path
+        print(f"[INFO] New file detected: {file_path}")
+        # Show it as 'analyzing' now; analysis starts once it is written
+        self.writes.watch(file_path, self.track(file_path))
+
+    def on_modified(self, event):
+        if event.is_directory or is_partial_download(event.src_path):
+            return
+        file_path = event.src_path
+        file_info = history.find(file_path)
+        if file_info is None:
+            return  # only files seen arriving are followed
+        # Changing again: drop any analysis of the old content and wait for
+        # this write to complete
+        self.coalescer.cancel(file_path)
+        if file_info['type'] != 'analyzing':
+            self.track(file_path)
+        self.writes.watch(file_path, file_info)
+
+    def on_closed(self, event):
+        # IN_CLOSE_WRITE (Linux): the writer is done, no need to wait
         if not event.is_directory:
-            file_path = event.src_path
-            print(f"[INFO] New file detected: {file_path}")
-            
-            # Add file to list with 'analyzing' status
-            file_name = os.path.basename(file_path)
-            file_info = {
-                'name': file_name,
-                'path': file_path,
-                'type': 'analyzing',
-                'details': None
-            }
-            
-            # Add to analyzed files list - clients will poll for updates
-            analyzed_files.append(file_info)
-            
-            # Start analysis in a separate thread to not block
-            threading.Thread(target=self.analyze_file, args=(file_path, file_info)).start()
-    
-    def analyze_file(self, file_path, file_info):
-        # Add a short delay to wait for the file to finish writing
-        time.sleep(1.5)
-        
+            self.writes.closed(event.src_path)
+
+    def on_moved(self, event):
+        if event.is_directory:
+            return
+        src, dest = event.src_path, event.dest_path
+        if is_partial_download(dest):
+            self.writes.forget(src)
+            return
+        file_info = self.writes.moved(src, dest)
+        if file_info is not None:
+            # Renamed while still being written; keep waiting under the new name
+            self.rename(src, dest, file_info)
+            return
+        file_info = None if history.find(dest) else history.find(src)
+        if file_info is not None:
+            # Same inode, same content: the record follows the file, and
+            # only work still pending on the old name is redone
+            self.rename(src, dest, file_info)
+            if self.coalescer.moved(src):
+                self.coalescer.request(dest, file_info)
+            return
+        # A finished download renamed into place is complete as it lands
+        print(f"[INFO] File moved in: {dest}")
+        self.coalescer.request(dest, self.track(dest))
+
+    def track(self, file_path):
+        """The 'analyzing' record for file_path. A path seen before keeps its
+        record, e.g. the empty placeholder a browser replaces on completion."""
+        file_info = history.track(file_path)
+        publish(file_info)
+        return file_info
+
+    def rename(self, src, dest, file_info):
+        history.rename(src, dest, file_info)
+        publish(file_info)
+
+    def start_analysis(self, job):
+        # Queued, not threaded: blocks the caller while the io stage is full
+        analysis_pool.submit('io', self.read_stage, job)
+
+    def apply(self, job, verdict, details=None):
+        """Show a stage's result, unless a newer write superseded the job."""
+        if job.cancelled:
+            return
+        job.file_info['type'] = verdict
+        if details is not None:
+            job.file_info['details'] = details
+        publish(job.file_info)
+
+    def similar(self, job, details):
+        """Earlier records close to this content, for details['similar'].
+        Also indexes this record's digest for later files."""
+        imphash = details.get('imphash')
+        similar = []
+        for other_id, distance in similarity_index.match(details.get('similarity_digest'), job.file_info['id']):
+            other = history.get(other_id)
+            if other is None:
+                continue  # gone from history
+            similar.append({'id': other_id, 'name': other['name'], 'type': other['type'], 'distance': distance,
+                            'same_imports': bool(imphash) and (other['details'] or {}).get('imphash') == imphash})
+        return similar
+
+    def fail(self, job, error):
+        print(f"[ERROR] Analysis failed: {error}")
+        self.apply(job, 'error')
+        self.coalescer.finish(job)
+
+    def read_stage(self, job):
+        """io stage: hash, cache lookup and feature extraction."""
+        if job.cancelled:
+            self.coalescer.finish(job)
+            return
+        file_path = job.path
         try:
-            # Extract features
-            features = extract_file_features(file_path)
+            sha256 = get_sha256(file_path)
+            if allowlist.contains(sha256):
+                self.apply(job, 'safe', allowlisted_details(file_path, sha256))
+                self.coalescer.finish(job)
+                return
+
+            # Identical content seen before: reuse its verdict and skip the
+            # analysis and the Gemini call
+            rules = rule_engine.current()
+            cache_key = verdict_key(file_path, sha256, rule_engine.fingerprint(rules))
+            cached = verdict_cache.get(cache_key)
+            if cached is not None:
+                stat = os.stat(file_path)
+                self.apply(job, cached['type'], dict(cached['details'],
+                                                     mime=get_mime_type(file_path),
+                                                     created_at=datetime.fromtimestamp(stat.st_ctime).isoformat(),
+                                                     modified_at=datetime.fromtimestamp(stat.st_mtime).isoformat(),
+                                                     similar=self.similar(job, cached['details']),
+                                                     cached=True))
+                self.coalescer.finish(job)
+                return
+
+            # Extract features; the rules' strings are searched in the same pass
+            features = extract_file_features(file_path, rules)
             if not features:
-                file_info['type'] = 'error'
+                self.apply(job, 'error')
+                self.coalescer.finish(job)
                 return
-                
-            # Basic safety check
-            basic_safety = predict_file(file_path)
-            
-            # Set initial risk level based on basic check
-            if basic_safety == "suspicious":
-                file_info['type'] = 'suspicious'
-            else:
-                file_info['type'] = 'safe'
+        except Exception as e:
+            self.fail(job, e)
+            return
+
+        analysis_pool.submit('cpu', self.assess_stage, job, features, cache_key)
+
+    def assess_stage(self, job, features, cache_key):
+        """cpu stage: rule-based assessment."""
+        if job.cancelled:
+            self.coalescer.finish(job)
+            return
+        try:
+            # Detection rules (already evaluated in the native pass)
+            evaluation = rule_engine.evaluate(features, job.path)
+            matched = evaluation['matched']
+            verdict = 'suspicious' if evaluation['suspicious'] else 'safe'
             
             # Prepare details for UI
             file_size = features.get('file_size', 0)
-            file_info['details'] = {
-                'size': f"{file_size / (1024 * 1024):.2f} MB" if file_size > 1024*1024 else f"{file_size / 1024:.2f} KB",
+            details = {
+                'size': format_size(file_size),
                 'ext': features.get('extension', 'unknown'),
                 'mime': features.get('mime_type', 'unknown'),
                 'magic_type': features.get('magic_type', 'unknown'),
@@ -101,109 +316,85 @@ class FileEventHandler(FileSystemEventHandler):
                 'pe_sections': features.get('pe_sections', ''),
                 'pe_timestamp': features.get('pe_timestamp', ''),
                 'is_dll': features.get('is_dll', False),
-                'rule': f"File is a {features.get('mime_type', 'unknown')} file. {basic_safety.capitalize()} based on initial checks.",
+                'imphash': features.get('imphash', ''),
+                'similarity_digest': features.get('similarity_digest', ''),
+                'rule': f"File is a {features.get('mime_type', 'unknown')} file. {verdict.capitalize()} based on initial checks.",
+                'matched_rules': [m['name'] for m in matched],
                 'gemini': "Gemini AI analysis not available."
             }
             
-            # Add more detailed rule-based assessment
-            rule_details = []
-            
-            # Check for high entropy
-            if features.get('entropy', 0) > 7.0:
-                rule_details.append("High entropy detected (>7.0), which may indicate encryption, compression, or obfuscation.")
-            
-            # Check for executable with no digital signature
-            if features.get('is_executable', False) and not features.get('has_digital_signature', False):
-                rule_details.append("Executable file without a valid digital signature.")
-            
-            # Check for suspicious strings
-            if features.get('suspicious_strings', []):
-                rule_details.append(f"Found {len(features.get('suspicious_strings', []))} potentially suspicious strings.")
-            
-            # Check for extension/mime type mismatch
-            if features.get('mime_type', '') != 'unknown' and features.get('magic_type', '') != 'unknown':
-                if features.get('extension', '').lower() not in features.get('mime_type', '').lower() and \
-                   features.get('extension', '').lower() not in features.get('magic_type', '').lower():
-                    rule_details.append("Possible file extension mismatch with actual content type.")
-            
-            # Update rule text if we have additional details
+            # Which rules matched, then why
+            if matched:
+                details['rule'] += f" Matched rules: {', '.join(details['matched_rules'])}."
+            rule_details = [m['description'] for m in matched if m['description']]
             if rule_details:
-                file_info['details']['rule'] += " " + " ".join(rule_details)
-            
-            # Advanced analysis with Gemini if API key is available
-            if self.api_key:
-                gemini_analysis = self.analyze_with_gemini(features)
-                if gemini_analysis:
-                    file_info['details']['gemini'] = gemini_analysis
-                    # Update risk level if Gemini found it suspicious
-                    if "suspicious" in gemini_analysis.lower() or "malicious" in gemini_analysis.lower() or "high risk" in gemini_analysis.lower():
-                        file_info['type'] = 'suspicious'
-            
-            # Update the file info in the global list
-            # No broadcasting needed - clients will poll for updates
-            
+                details['rule'] += " " + " ".join(rule_details)
+
+            # Variants of files seen earlier, by similarity digest
+            details['similar'] = self.similar(job, details)
         except Exception as e:
-            print(f"[ERROR] Analysis failed: {e}")
-            file_info['type'] = 'error'
-    
-    def analyze_with_gemini(self, features):
+            self.fail(job, e)
+            return
+
+        if llm_queue.enabled and not job.cancelled:
+            request = LlmRequest(features, details['matched_rules'])
+            answer = llm_cache.get(request)
+            if answer is not None:
+                # Same relevant features as an earlier file: same answer
+                verdict = gemini_verdict(verdict, answer)
+                details['gemini'] = answer
+            elif not llm_queue.reserve():
+                # Backlog full: the rule verdict stands, uncached, so a
+                # later copy of the file gets its Gemini analysis
+                details['gemini'] = "Gemini AI analysis skipped: too many files are waiting for it."
+                self.apply(job, verdict, details)
+                self.coalescer.finish(job)
+                return
+            else:
+                # Publish the rule-based verdict now; Gemini's upgrades it later
+                details.update(gemini="Gemini AI analysis pending.", gemini_pending=True)
+                self.apply(job, verdict, details)
+                llm_queue.submit(request.prompt,
+                                 lambda text, error: self.gemini_done(job, cache_key, request, verdict, details,
+                                                                      text, error),
+                                 lambda: job.cancelled,
+                                 lambda text: self.gemini_progress(job, text),
+                                 reserved=True)
+                return
+        self.apply(job, verdict, details)
+        verdict_cache.put(cache_key, {'type': verdict, 'details': details})
+        self.coalescer.finish(job)
+
+    def gemini_progress(self, job, text):
+        """Gemini's answer so far, streamed to clients as it is written."""
+        if job.cancelled:
+            return
+        live_analysis.update(job.file_info['id'], text)
+        if event_loop is not None:
+            event_loop.call_soon_threadsafe(_wake_streams)
+
+    def gemini_done(self, job, cache_key, request, verdict, details, text, error):
+        """Gemini's answer (on the LLM queue's thread): upgrades the shown
+        verdict, which is then cached."""
         try:
-            # Convert features to a formatted string for Gemini
-            features_str = json.dumps(features, indent=2)
-            
-            # Create the prompt for Gemini
-            prompt = f"""Analyze this file based on its extracted features and determine if it's safe or suspicious:
-            
-            {features_str}
-            
-            Focus especially on these security-relevant features:
-            - File entropy (high entropy >7.0 may indicate encryption or packing)
-            - Executable status and PE file characteristics
-            - Digital signature verification
-            - Suspicious strings found in the file
-            - File header analysis
-            - File magic type vs extension mismatch
-            
-            Please provide:
-            1. A safety assessment (Safe, Suspicious, or Malicious)
-            2. Detailed explanation of your assessment with evidence
-            3. Highlight any suspicious or important characteristics
-            4. Risk level (Low, Medium, High)
-            5. Specific recommendations for handling this file
-            """
-            
-            # Configure Gemini model with fallback options to avoid 404s on unsupported versions
-            supported_models = [
-                'gemini-2.0-flash'
-            ]
-
-            last_error = None
-            for model_name in supported_models:
-                try:
-                    model = genai.GenerativeModel(model_name)
-                    response = model.generate_content(prompt)
-                    if hasattr(response, 'text') and response.text:
-                        return response.text
-                    # Some SDK versions return a list of candidates
-                    if hasattr(response, 'candidates') and response.candidates:
-                        candidate_text = getattr(response.candidates[0], 'content', None)
-                        if candidate_text:
-                            return str(candidate_text)
-                except Exception as inner_e:
-                    last_error = inner_e
-                    continue
-
-            # If all models failed
-            if last_error:
-                raise last_error
-            return None
-            return response.text
-            
-        except Exception as e:
-            print(f"[ERROR] Gemini analysis failed: {e}")
-            return None
+            live_analysis.discard(job.file_info['id'])
+            if text is not None:
+                llm_cache.put(request, text)  # valid for these features even if the file moved on
+            if job.cancelled:
+                return  # superseded; the newer content has its own request
+            details = {k: v for k, v in details.items() if k != 'gemini_pending'}
+            if text is None:
+                # A failed Gemini call is retried on the next copy, not cached
+                print(f"[ERROR] Gemini analysis failed: {error}")
+                self.apply(job, verdict, dict(details, gemini="Gemini AI analysis not available."))
+                return
+            details = dict(details, gemini=text)
+            verdict = gemini_verdict(verdict, text)
+            self.apply(job, verdict, details)
+            verdict_cache.put(cache_key, {'type': verdict, 'details': details})
+        finally:
+            self.coalescer.finish(job)
 
-# Routes
 @app.get("/")
 async def get_html():
     # Serve the UI directly as a static file (avoids encoding issues)
@@ -215,21 +406,146 @@ async def favicon():
     return Response(status_code=204)
 
 @app.get("/api/files")
-async def get_files():
-    return JSONResponse(content=analyzed_files)
+async def get_files(request: Request, since: int = Query(None, ge=0), epoch: str = Query(None),
+                    limit: int = Query(None, ge=1)):
+    # Legacy clients without a cursor still get the full array (all of the
+    # history that is kept)
+    if since is None:
+        return negotiated_response(request, history.all())
+
+    # A cursor from another server run (or from the future) is meaningless;
+    # send a full snapshot and tell the client to drop its cache. A client
+    # that passes limit pages through history instead: it gets the reset
+    # with no records, also when more than limit records changed.
+    reset = epoch != SERVER_EPOCH or since > history.cursor
+    if reset and limit is not None:
+        cursor, delta = history.cursor, []
+    else:
+        cursor, delta = history.since(0 if reset else since, limit)
+        if delta is None:
+            reset, delta = True, []
+    # Feed position is repeated in headers so the CBOR body can be a bare array
+    headers = {
+        'X-Feed-Epoch': SERVER_EPOCH,
+        'X-Feed-Cursor': str(cursor),
+        'X-Feed-Reset': '1' if reset else '0'
+    }
+    return negotiated_response(request, {
+        'epoch': SERVER_EPOCH,
+        'cursor': cursor,
+        'reset': reset,
+        'files': delta
+    }, headers=headers, cbor_content=delta)
+
+@app.get("/api/files/page")
+async def get_files_page(request: Request, limit: int = Query(100, ge=1), cursor: str = Query(None),
+                         sort: str = Query('id'), order: str = Query('desc'), verdict: str = Query(None, alias='type'),
+                         summary: bool = Query(True)):
+    """One page of history. next (X-Page-Next) continues after its last
+    record; the feed cursor (X-Feed-Cursor) is where to stream from to keep
+    the page up to date."""
+    if order not in ('asc', 'desc'):
+        raise HTTPException(status_code=400, detail="order must be asc or desc")
+    try:
+        page = history.page(limit, cursor, sort, order == 'desc', verdict, summary)
+    except ValueError as e:
+        raise HTTPException(status_code=400, detail=str(e))
+    headers = {
+        'X-Feed-Epoch': SERVER_EPOCH,
+        'X-Feed-Cursor': str(page['cursor']),
+        'X-Page-Next': page['next'] or '',
+        'X-Page-Total': str(page['total'])
+    }
+    return negotiated_response(request, dict(page, epoch=SERVER_EPOCH), headers=headers,
+                               cbor_content=page['files'])
+
+@app.get("/api/files/{file_id}")
+async def get_file(request: Request, file_id: int):
+    """The full record, e.g. for a row listed as a summary."""
+    file_info = history.get(file_id)
+    if file_info is None:
+        raise HTTPException(status_code=404, detail="no such file (or no longer kept)")
+    return negotiated_response(request, file_info)
+
+def parse_resume_id(last_event_id):
+    """Split an '<epoch>:<seq>' event id into (epoch, seq)."""
+    epoch, _, seq = (last_event_id or '').partition(':')
+    try:
+        return epoch, int(seq)
+    except ValueError:
+        return None, 0
+
+def sse_event(event, data, event_id=None):
+    lines = [f"event: {event}"]
+    if event_id is not None:
+        lines.append(f"id: {event_id}")
+    lines.append(f"data: {json.dumps(data)}")
+    return "\n".join(lines) + "\n\n"
+
+@app.get("/api/events")
+async def get_events(request: Request, limit: int = Query(None, ge=1)):
+    # Resume point comes from Last-Event-ID (set by EventSource and the GUI
+    # on reconnect); ids carry the epoch so a restarted server is detected.
+    # With limit, a reset (or a gap of more than limit changes) replays
+    # nothing: the stream starts at the present and the client reloads its
+    # first page of history.
+    epoch, since = parse_resume_id(request.headers.get('last-event-id'))
+    reset = epoch != SERVER_EPOCH or since > history.cursor
+    if not reset and limit is not None and history.since(since, limit)[1] is None:
+        reset = True
+    if reset:
+        since = history.cursor if limit is not None else 0
+
+    async def stream():
+        nonlocal since
+        yield sse_event('hello', {'epoch': SERVER_EPOCH, 'reset': reset})
+        depth = None
+        text_change = 0
+        while not await request.is_disconnected():
+            # Grab the waiter before reading so a publish in between wakes us
+            waiter = files_changed
+            cursor, delta = history.since(since)
+            for file_info in delta:
+                yield sse_event('file', file_info, f"{SERVER_EPOCH}:{file_info['seq']}")
+            since = cursor
+            # Gemini text still being written, latest version per file
+            text_change, texts = live_analysis.since(text_change)
+            for record_id, text in texts:
+                yield sse_event('analysis', {'id': record_id, 'text': text})
+            # Analysis backlog, sent first after hello and then on change
+            current = analysis_depth()
+            if current != depth:
+                depth = current
+                yield sse_event('queue', depth)
+            try:
+                await asyncio.wait_for(waiter.wait(), STREAM_KEEPALIVE)
+            except asyncio.TimeoutError:
+                yield ": keepalive\n\n"
+
+    return StreamingResponse(stream(), media_type="text/event-stream",
+                             headers={'Cache-Control': 'no-cache'})
 
 @app.get("/api/status")
 async def get_status():
-    api_key = os.getenv("GEMINI_API_KEY")
+    history_stats = history.stats()
     return JSONResponse(content={
         'monitoring': True,
         'watched_dir': WATCHED_DIR,
-        'gemini_enabled': bool(api_key) and api_key != 'your_api_key_here',
-        'file_count': len(analyzed_files)
+        'gemini_enabled': llm_queue.enabled,
+        'file_count': history_stats['records'],
+        'history': history_stats,
+        'verdict_cache': verdict_cache.stats(),
+        'analysis_queue': analysis_pool.stats(),
+        'llm': llm_queue.stats(),
+        'llm_cache': llm_cache.stats() if llm_cache else None,
+        'coalescing': file_handler.coalescer.stats() if file_handler else None,
+        'similarity': similarity_index.stats(),
+        'allowlist': allowlist.stats(),
+        'rules': rule_engine.stats(),
     })
 
 def start_monitoring():
-    global observer
+    global observer, file_handler
     if not os.path.isdir(WATCHED_DIR):
         try:
             os.makedirs(WATCHED_DIR, exist_ok=True)
@@ -238,8 +554,8 @@ def start_monitoring():
 
     if observer is None:
         obs = Observer()
-        event_handler = FileEventHandler()
-        obs.schedule(event_handler, WATCHED_DIR, recursive=True)
+        file_handler = file_handler or FileEventHandler()
+        obs.schedule(file_handler, WATCHED_DIR, recursive=True)
         obs.start()
         observer = obs
         print(f"Monitoring started on: {WATCHED_DIR}")
@@ -252,6 +568,12 @@ def stop_monitoring():
         observer = None
         print("Monitoring stopped.")
 
+@app.on_event("startup")
+async def init_event_stream():
+    global event_loop, files_changed
+    files_changed = asyncio.Event()
+    event_loop = asyncio.get_running_loop()
+
 @app.on_event("startup")
 def on_startup():
     start_monitoring()
@@ -0,0 +1,45 @@
+"""Earlier files that look like a new one, so variants of one family are
+grouped even though their SHA-256 differs.
+
+The native extractor gives every file a TLSH-style 'similarity_digest' and
+every PE an 'imphash'. Digests go into NativeAnalysis' LSH index, which
+answers top-k queries in well under a millisecond over a million files.
+Without the native library there are no digests and matching is off.
+
+    SECUREGUARD_SIMILARITY_ENTRIES  digests kept, default 1,000,000
+"""
+import os
+
+from native_features import native_similarity_index
+
+DEFAULT_ENTRIES = 1000000
+TOP_K = 5
+MAX_DISTANCE = 100  # TLSH scale: below ~100 is usually the same family
+
+
+class SimilarityIndex:
+    def __init__(self, entries=None):
+        if entries is None:
+            try:
+                entries = max(1, int(os.environ.get('SECUREGUARD_SIMILARITY_ENTRIES', DEFAULT_ENTRIES)))
+            except ValueError:
+                entries = DEFAULT_ENTRIES
+        self.native = native_similarity_index(entries)
+
+    def match(self, digest, record_id, k=TOP_K, max_distance=MAX_DISTANCE):
+        """Closest earlier records as [(id, distance)], then digest is added
+        under record_id. A record analysed again (changed content) never
+        matches itself and appears once, at its closest digest."""
+        if self.native is None or not digest:
+            return []
+        matches, seen = [], {record_id}
+        # Extra candidates make room for duplicates of re-analysed records
+        for other, distance in self.native.query(digest, 2 * k + 1, max_distance):
+            if other not in seen:
+                seen.add(other)
+                matches.append((other, distance))
+        self.native.add(digest, record_id)
+        return matches[:k]
+
+    def stats(self):
+        return self.native.stats() if self.native is not None else {'enabled': False}
@@ -0,0 +1,111 @@
+"""Verdicts keyed by file content (SHA-256), so another copy of a file that
+was already analysed is answered without re-running the analysis or Gemini.
+
+Entries live in NativeAnalysis' mmap-backed table, which persists across
+restarts. Without the native library an in-memory LRU with the same limits
+stands in for it. Either way the cache is bound to a version string: when
+the rules or the model change, old verdicts are dropped.
+
+    SECUREGUARD_VERDICT_CACHE          cache file (default: user cache dir)
+    SECUREGUARD_VERDICT_CACHE_MB       file size limit, default 64
+    SECUREGUARD_VERDICT_CACHE_ENTRIES  entry limit, default 16384
+"""
+import json
+import os
+import sys
+import threading
+from collections import OrderedDict
+
+from native_features import native_verdict_cache
+
+DEFAULT_MAX_MB = 64
+DEFAULT_MAX_ENTRIES = 16384
+
+
+def default_path():
+    if sys.platform == 'win32':
+        root = os.environ.get('LOCALAPPDATA') or os.path.expanduser('~')
+    else:
+        root = os.environ.get('XDG_CACHE_HOME') or os.path.join(os.path.expanduser('~'), '.cache')
+    return os.path.join(root, 'secureguard', 'verdicts.cache')
+
+
+class _MemoryCache:
+    """LRU over the same limits, for when the native table is unavailable."""
+
+    def __init__(self, max_bytes, max_entries):
+        self.max_bytes = max_bytes
+        self.max_entries = max_entries
+        self.entries = OrderedDict()
+        self.bytes = 0
+        self.counts = {'hits': 0, 'misses': 0, 'insertions': 0, 'evictions': 0}
+        self.lock = threading.Lock()
+
+    def get(self, sha256):
+        with self.lock:
+            value = self.entries.get(sha256)
+            if value is None:
+                self.counts['misses'] += 1
+                return None
+            self.entries.move_to_end(sha256)
+            self.counts['hits'] += 1
+            return value
+
+    def put(self, sha256, value):
+        if not value or len(value) > self.max_bytes // 8:
+            return False
+        with self.lock:
+            old = self.entries.pop(sha256, None)
+            if old is not None:
+                self.bytes -= len(old)
+            while self.entries and (len(self.entries) >= self.max_entries
+                                    or self.bytes + len(value) > self.max_bytes):
+                _, dropped = self.entries.popitem(last=False)
+                self.bytes -= len(dropped)
+                self.counts['evictions'] += 1
+            self.entries[sha256] = value
+            self.bytes += len(value)
+            self.counts['insertions'] += 1
+            return True
+
+    def clear(self):
+        with self.lock:
+            self.entries.clear()
+            self.bytes = 0
+
+    def stats(self):
+        with self.lock:
+            return dict(self.counts, entries=len(self.entries), max_entries=self.max_entries,
+                        value_bytes=self.bytes, heap_bytes=self.max_bytes)
+
+
+class VerdictCache:
+    """SHA-256 -> {'type': ..., 'details': {...}} for a given analysis version."""
+
+    def __init__(self, version, path=None, max_bytes=None, max_entries=None):
+        self.version = version
+        self.path = path or os.environ.get('SECUREGUARD_VERDICT_CACHE') or default_path()
+        max_bytes = max_bytes or int(float(os.environ.get('SECUREGUARD_VERDICT_CACHE_MB', DEFAULT_MAX_MB))
+                                     * 1024 * 1024)
+        max_entries = max_entries or int(os.environ.get('SECUREGUARD_VERDICT_CACHE_ENTRIES', DEFAULT_MAX_ENTRIES))
+        backend = None
+        try:
+            os.makedirs(os.path.dirname(self.path), exist_ok=True)
+            backend = native_verdict_cache(self.path, version, max_bytes, max_entries)
+        except OSError as e:
+            print(f"[WARN] Verdict cache directory unavailable: {e}")
+        self.persistent = backend is not None
+        self.backend = backend or _MemoryCache(max_bytes, max_entries)
+
+    def get(self, sha256):
+        value = self.backend.get(sha256)
+        return json.loads(value) if value is not None else None
+
+    def put(self, sha256, verdict):
+        return self.backend.put(sha256, json.dumps(verdict, separators=(',', ':')).encode('utf-8'))
+
+    def clear(self):
+        self.backend.clear()
+
+    def stats(self):
+        return dict(self.backend.stats(), persistent=self.persistent, version=self.version)
@@ -0,0 +1,63 @@
+"""Content negotiation between JSON and compact CBOR responses.
+
+CBOR bodies replace the well-known field names below with their index in
+CBOR_KEYS, so a record no longer repeats long key strings. Unknown keys are
+sent as plain strings. The table is shared with the C++ GUI and watcher daemon
+(ExecFeedKeys.h) and must only ever be appended to.
+"""
+from fastapi.responses import JSONResponse, Response
+
+try:
+    import cbor2
+    CBOR_AVAILABLE = True
+except ImportError:
+    CBOR_AVAILABLE = False
+
+CBOR_MEDIA_TYPE = "application/cbor"
+
+CBOR_KEYS = [
+    # file record
+    'id', 'seq', 'name', 'path', 'type', 'details',
+    # details
+    'size', 'ext', 'mime', 'magic_type', 'hash', 'entropy', 'is_executable',
+    'has_digital_signature', 'suspicious_strings', 'file_header', 'created_at',
+    'modified_at', 'strings_count', 'suspicious_count', 'pe_sections',
+    'pe_timestamp', 'is_dll', 'rule', 'gemini',
+    # verdict cache
+    'cached',
+    # similarity
+    'imphash', 'similarity_digest', 'similar', 'distance', 'same_imports',
+    # allowlist
+    'allowlisted',
+    # rules
+    'matched_rules',
+    # history
+    'summary',
+    # llm
+    'gemini_pending',
+]
+CBOR_KEY_IDS = {key: i for i, key in enumerate(CBOR_KEYS)}
+
+
+def compact(value):
+    """Swap known dict keys for their CBOR_KEYS index, recursively."""
+    if isinstance(value, dict):
+        return {CBOR_KEY_IDS.get(k, k): compact(v) for k, v in value.items()}
+    if isinstance(value, list):
+        return [compact(v) for v in value]
+    return value
+
+
+def wants_cbor(request):
+    return CBOR_AVAILABLE and CBOR_MEDIA_TYPE in request.headers.get('accept', '')
+
+
+def negotiated_response(request, content, headers=None, cbor_content=None):
+    """JSON by default; compact CBOR when the client asks for it.
+
+    cbor_content lets a caller send a different (leaner) shape in CBOR.
+    """
+    if wants_cbor(request):
+        body = cbor2.dumps(compact(content if cbor_content is None else cbor_content))
+        return Response(content=body, media_type=CBOR_MEDIA_TYPE, headers=headers)
+    return JSONResponse(content=content, headers=headers)
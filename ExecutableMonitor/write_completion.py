@@ -0,0 +1,103 @@
+"""Decides when a newly created file is finished being written.
+
+A file counts as complete as soon as any of these happens:
+
+    - its writer closes it (inotify IN_CLOSE_WRITE, watchdog's on_closed)
+    - a finished download is renamed into place (on_moved)
+    - its size and mtime have not changed for `quiet` seconds. This is the
+      fallback on platforms with no close events (Windows, macOS).
+
+Browser temp files (.crdownload, .part, ...) are never analysed. The
+rename to the final name is what marks the download complete.
+"""
+import os
+import threading
+import time
+
+PARTIAL_SUFFIXES = ('.crdownload', '.part', '.partial', '.download', '.opdownload', '.tmp')
+
+
+def is_partial_download(path):
+    return path.lower().endswith(PARTIAL_SUFFIXES)
+
+
+def _signature(path):
+    try:
+        stat = os.stat(path)
+    except OSError:
+        return None
+    return stat.st_size, stat.st_mtime_ns
+
+
+class _Pending:
+    def __init__(self, payload):
+        self.payload = payload
+        self.signature = None
+        self.since = time.monotonic()
+
+
+class WriteTracker:
+    """Calls on_ready(path, payload) once per watched path when it is complete.
+
+    SECUREGUARD_WRITE_QUIET overrides the stabilisation window (seconds).
+    """
+
+    def __init__(self, on_ready, quiet=None, poll=0.1):
+        self.on_ready = on_ready
+        self.quiet = quiet if quiet is not None else float(os.environ.get('SECUREGUARD_WRITE_QUIET', 0.5))
+        self.poll = poll
+        self.lock = threading.Lock()
+        self.pending = {}
+        self.wake = threading.Event()
+        threading.Thread(target=self._stabilise, name="write-completion", daemon=True).start()
+
+    def watch(self, path, payload):
+        with self.lock:
+            self.pending[path] = _Pending(payload)
+        self.wake.set()
+
+    def closed(self, path):
+        """The writer closed path: it is complete now."""
+        self._ready(path)
+
+    def moved(self, src, dest):
+        """Follows a rename of a file still being written. Returns its
+        payload, or None if src was not being watched."""
+        with self.lock:
+            entry = self.pending.pop(src, None)
+            if entry is not None:
+                self.pending[dest] = entry
+        return entry.payload if entry is not None else None
+
+    def forget(self, path):
+        with self.lock:
+            self.pending.pop(path, None)
+
+    def pending_count(self):
+        with self.lock:
+            return len(self.pending)
+
+    def _ready(self, path):
+        with self.lock:
+            entry = self.pending.pop(path, None)
+        if entry is not None:
+            self.on_ready(path, entry.payload)
+
+    def _stabilise(self):
+        while True:
+            if not self.pending_count():
+                self.wake.wait()
+                self.wake.clear()
+            time.sleep(self.poll)
+            now = time.monotonic()
+            settled = []
+            with self.lock:
+                for path, entry in self.pending.items():
+                    signature = _signature(path)
+                    if signature != entry.signature:
+                        entry.signature, entry.since = signature, now
+                    elif now - entry.since >= self.quiet:
+                        settled.append(path)
+            # A vanished file settles too; its analysis then reports the error
+            for path in settled:
+                self._ready(path)
@@ -1,24 +1,34 @@
 #include "ExecutableMonitorPage.h"
 #include <QWidget>
-#include <QTableWidget>
+#include <QTableView>
+#include <QTimer>
 #include <QLineEdit>
 #include <QCheckBox>
 #include <QLabel>
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
+#include <QGridLayout>
 #include <QScrollArea>
 #include <QFrame>
 #include <QHeaderView>
+#include <QScrollBar>
+#include <QJsonObject>
 
 ExecutableMonitorPage::ExecutableMonitorPage(QWidget *parent)
-    : QWidget(parent), monitorToggle(nullptr), filterInput(nullptr), detectedTable(nullptr),
+    : QWidget(parent), monitorToggle(nullptr), backlogLabel(nullptr), filterInput(nullptr), detectedTable(nullptr),
+      filesModel(new DetectedFilesModel(this)), filesProxy(new DetectedFilesFilter(this)),
+      filterDebounce(new QTimer(this)),
       selectedNameLabel(nullptr), selectedPathLabel(nullptr), riskLevelLabel(nullptr),
-      fileTypeLabel(nullptr), fileSizeLabel(nullptr), detectionLabel(nullptr),
+      fileTypeLabel(nullptr), fileSizeLabel(nullptr), detectionLabel(nullptr), aiStatusLabel(nullptr),
       findingsContainer(nullptr), recommendationsContainer(nullptr),
-      mimeLabel(nullptr), md5Label(nullptr), sha256Label(nullptr), stringsContainer(nullptr)
+      mimeLabel(nullptr), md5Label(nullptr), sha256Label(nullptr), stringsContainer(nullptr),
+      similarContainer(nullptr)
 {
     this->setObjectName("execMonitorPage");
+    filesProxy->setFilesModel(filesModel); // rows come newest first from the model; no proxy sort
+    filterDebounce->setSingleShot(true);
+    filterDebounce->setInterval(150);
     QHBoxLayout *rootLayout = new QHBoxLayout(this);
     rootLayout->setContentsMargins(0, 0, 0, 0);
     rootLayout->setSpacing(0);
@@ -54,7 +64,11 @@ QWidget* ExecutableMonitorPage::buildLeftPanel() {
     monitorToggle = new QCheckBox();
     monitorToggle->setChecked(true);
     connect(monitorToggle, &QCheckBox::toggled, this, &ExecutableMonitorPage::monitoringToggled);
+    backlogLabel = new QLabel();
+    backlogLabel->setObjectName("subtitle");
+    backlogLabel->setToolTip("Files waiting for analysis / being analysed");
     monitorLayout->addWidget(status);
+    monitorLayout->addWidget(backlogLabel);
     monitorLayout->addStretch();
     monitorLayout->addWidget(monitorToggle);
     layout->addWidget(monitorRow);
@@ -63,17 +77,27 @@ QWidget* ExecutableMonitorPage::buildLeftPanel() {
     filterInput = new QLineEdit();
     filterInput->setPlaceholderText("Filter files...");
     filterInput->setObjectName("urlInput");
-    connect(filterInput, &QLineEdit::textChanged, this, &ExecutableMonitorPage::filterChanged);
+    // Each keystroke restarts the debounce; only the settled text is applied
+    connect(filterInput, &QLineEdit::textChanged, filterDebounce, qOverload<>(&QTimer::start));
+    connect(filterDebounce, &QTimer::timeout, this, [this]() {
+        const QString text = filterInput->text();
+        filesProxy->setQuery(text);
+        emit filterChanged(text);
+    });
     layout->addWidget(filterInput);
 
-    // Detected files table
-    detectedTable = new QTableWidget(0, 3);
+    // Detected files table. Fixed row heights and column widths keep the
+    // view from measuring every row, so only the visible rows are touched.
+    detectedTable = new QTableView();
     detectedTable->setObjectName("detectedTable");
-    QStringList headers; headers << "Executable" << "Status" << "When";
-    detectedTable->setHorizontalHeaderLabels(headers);
+    detectedTable->setModel(filesProxy);
     detectedTable->horizontalHeader()->setStretchLastSection(true);
-    detectedTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
-    detectedTable->horizontalHeader()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
+    detectedTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    detectedTable->setColumnWidth(DetectedFilesModel::NameColumn, 200);
+    detectedTable->setColumnWidth(DetectedFilesModel::StatusColumn, 90);
+    detectedTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    detectedTable->verticalHeader()->setDefaultSectionSize(32);
+    detectedTable->setWordWrap(false);
     detectedTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     detectedTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     detectedTable->setSelectionMode(QAbstractItemView::SingleSelection);
@@ -82,14 +106,23 @@ QWidget* ExecutableMonitorPage::buildLeftPanel() {
     detectedTable->verticalHeader()->setVisible(false);
     detectedTable->horizontalHeader()->setVisible(true);
     detectedTable->setAlternatingRowColors(true);
-    detectedTable->setStyleSheet("QTableWidget#detectedTable { background: transparent; } ");
+    detectedTable->setStyleSheet("QTableView#detectedTable { background: transparent; } ");
     layout->addWidget(detectedTable, 1);
 
-    connect(detectedTable, &QTableWidget::cellDoubleClicked, this, [this](int row, int){
-        const QString name = detectedTable->item(row, 0) ? detectedTable->item(row, 0)->text() : QString();
-        emit itemActivated(name);
+    connect(detectedTable, &QTableView::doubleClicked, this, [this](const QModelIndex &index){
+        emit itemActivated(index.data(DetectedFilesModel::FileIdRole).toInt());
     });
 
+    // Older history is loaded a page at a time: ask for more when the view
+    // nears its last row, or is not even full yet
+    QScrollBar *scroll = detectedTable->verticalScrollBar();
+    const auto nearEnd = [this, scroll]() {
+        const int rowsLeft = scroll->maximum() - scroll->value(); // scrolls per item
+        if (rowsLeft < 20) emit moreRequested();
+    };
+    connect(scroll, &QScrollBar::valueChanged, this, nearEnd);
+    connect(scroll, &QScrollBar::rangeChanged, this, nearEnd);
+
     return panel;
 }
 
@@ -140,8 +173,11 @@ QWidget* ExecutableMonitorPage::buildRightPanel() {
     QLabel *aiTitle = new QLabel("Gemini AI Analysis");
     QFont f; f.setBold(true); f.setPointSize(14); aiTitle->setFont(f);
     aiLayout->addWidget(aiTitle);
-    QLabel *aiStatus = new QLabel("Analyzing...");
-    aiLayout->addWidget(aiStatus);
+    aiStatusLabel = new QLabel("Analyzing...");
+    aiStatusLabel->setWordWrap(true);
+    aiStatusLabel->setTextFormat(Qt::PlainText); // model output, not markup
+    aiStatusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    aiLayout->addWidget(aiStatusLabel);
     layout->addWidget(aiFrame);
 
     // File features block
@@ -171,18 +207,36 @@ QWidget* ExecutableMonitorPage::buildRightPanel() {
 
     layout->addWidget(featuresFrame);
 
+    // Similar files block: variants of earlier files, closest first
+    QFrame *similarFrame = new QFrame();
+    similarFrame->setObjectName("analysisCard");
+    QVBoxLayout *similarLayout = new QVBoxLayout(similarFrame);
+    QLabel *similarTitle = new QLabel("Similar Files");
+    similarTitle->setFont(f);
+    similarLayout->addWidget(similarTitle);
+    similarContainer = new QWidget();
+    QVBoxLayout *matchesLayout = new QVBoxLayout(similarContainer);
+    matchesLayout->setContentsMargins(0,0,0,0);
+    matchesLayout->setSpacing(2);
+    matchesLayout->addWidget(new QLabel("No similar files seen"));
+    similarLayout->addWidget(similarContainer);
+
+    layout->addWidget(similarFrame);
+
     return panel;
 }
 
-void ExecutableMonitorPage::setDetectedFiles(const QList<QStringList> &rows) {
-    detectedTable->setRowCount(0);
-    for (const QStringList &r : rows) {
-        int row = detectedTable->rowCount();
-        detectedTable->insertRow(row);
-        for (int c = 0; c < qMin(3, r.size()); ++c) {
-            detectedTable->setItem(row, c, new QTableWidgetItem(r[c]));
-        }
-    }
+void ExecutableMonitorPage::upsertFiles(const QList<ExecFileRow> &rows) {
+    filesModel->upsertRows(rows);
+}
+
+void ExecutableMonitorPage::clearFiles() {
+    filesModel->clear();
+}
+
+void ExecutableMonitorPage::setBacklog(int queued, int active) {
+    if (queued == 0 && active == 0) backlogLabel->clear();
+    else backlogLabel->setText(QString("(%1 queued, %2 analyzing)").arg(queued).arg(active));
 }
 
 void ExecutableMonitorPage::setAnalysisDetails(const QString &fileName,
@@ -226,4 +280,36 @@ void ExecutableMonitorPage::setAnalysisDetails(const QString &fileName,
     }
 }
 
+void ExecutableMonitorPage::setAiAnalysis(const QString &text, bool inProgress) {
+    if (!aiStatusLabel) return;
+    if (text.isEmpty()) aiStatusLabel->setText(inProgress ? QStringLiteral("Analyzing...") : QString());
+    else aiStatusLabel->setText(inProgress ? text + QStringLiteral(" \u258C") : text); // block cursor while streaming
+}
 
+void ExecutableMonitorPage::setSimilarFiles(const QJsonArray &matches) {
+    auto layout = similarContainer ? qobject_cast<QVBoxLayout*>(similarContainer->layout()) : nullptr;
+    if (!layout) return;
+    QLayoutItem *child;
+    while ((child = layout->takeAt(0)) != nullptr) {
+        delete child->widget();
+        delete child;
+    }
+    if (matches.isEmpty()) {
+        layout->addWidget(new QLabel("No similar files seen"));
+        return;
+    }
+    for (const QJsonValue &v : matches) {
+        const QJsonObject m = v.toObject();
+        // The name links to that file's analysis
+        QString text = QString("<a href=\"%1\">%2</a> %3, distance %4")
+                           .arg(m.value("id").toInt())
+                           .arg(m.value("name").toString().toHtmlEscaped(),
+                                ExecFileRow::statusForType(m.value("type").toString()))
+                           .arg(m.value("distance").toInt());
+        if (m.value("same_imports").toBool()) text += ", same imports";
+        QLabel *label = new QLabel(text);
+        label->setTextFormat(Qt::RichText);
+        connect(label, &QLabel::linkActivated, this, [this](const QString &id) { emit itemActivated(id.toInt()); });
+        layout->addWidget(label);
+    }
+}
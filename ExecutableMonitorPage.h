@@ -2,11 +2,14 @@
 #define EXECUTABLEMONITORPAGE_H
 
 #include <QObject>
+#include <QJsonArray>
 #include <QWidget>
 #include <QString>
 #include <QStringList>
+#include "DetectedFilesModel.h"
 
-class QTableWidget;
+class QTableView;
+class QTimer;
 class QLineEdit;
 class QCheckBox;
 class QLabel;
@@ -23,10 +26,13 @@ public:
 signals:
     void monitoringToggled(bool enabled);
     void filterChanged(const QString &text);
-    void itemActivated(const QString &executableName);
+    void itemActivated(int fileId);
+    void moreRequested(); // scrolled near the oldest loaded file
 
 public slots:
-    void setDetectedFiles(const QList<QStringList> &rows); // each: [name, status, time]
+    void upsertFiles(const QList<ExecFileRow> &rows);
+    void clearFiles();
+    void setBacklog(int queued, int active); // analysis queue depth from the backend
     void setAnalysisDetails(const QString &fileName,
                             const QString &filePath,
                             const QString &riskLevel,
@@ -39,6 +45,13 @@ public slots:
                             const QString &md5,
                             const QString &sha256,
                             const QStringList &suspiciousStrings);
+    // details.similar: earlier files with a close similarity digest
+    void setSimilarFiles(const QJsonArray &matches);
+    // Gemini card; inProgress marks text still being streamed
+    void setAiAnalysis(const QString &text, bool inProgress);
+
+public:
+    const ExecFileRow *fileById(int id) const { return filesModel->fileById(id); }
 
 private:
     QWidget *buildLeftPanel();
@@ -46,8 +59,12 @@ private:
 
     // Left panel
     QCheckBox *monitorToggle;
+    QLabel *backlogLabel;
     QLineEdit *filterInput;
-    QTableWidget *detectedTable;
+    QTableView *detectedTable;
+    DetectedFilesModel *filesModel;
+    DetectedFilesFilter *filesProxy;
+    QTimer *filterDebounce; // coalesces typing bursts into one filter pass
 
     // Right panel (summary widgets)
     QLabel *selectedNameLabel;
@@ -56,6 +73,7 @@ private:
     QLabel *fileTypeLabel;
     QLabel *fileSizeLabel;
     QLabel *detectionLabel;
+    QLabel *aiStatusLabel;
 
     // Sections
     QWidget *findingsContainer;
@@ -64,6 +82,7 @@ private:
     QLabel *md5Label;
     QLabel *sha256Label;
     QWidget *stringsContainer;
+    QWidget *similarContainer;
 };
 
 #endif // EXECUTABLEMONITORPAGE_H
@@ -17,9 +17,14 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QCborValue>
+#include <QCborArray>
+#include <QCborMap>
 #include <QTableWidget>
 #include <QHeaderView>
 #include <QTimer>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
 #include "ExecutableMonitorPage.h"
 
 // ==============================
@@ -44,25 +49,125 @@ private:
     std::function<void()> m_callback;
 };
 
+// ==============================
+// URL scan decoding (worker thread)
+// ==============================
+// Backend classification -> result list type, status text and risk score
+static void urlVerdictStyle(const QString &classification, QString *type, QString *status, int *risk) {
+    int score;
+    if (classification.compare("Legitimate", Qt::CaseInsensitive) == 0) {
+        *type = "safe";
+        *status = "Safe";
+        score = 20;
+    } else if (classification.compare("Phishing", Qt::CaseInsensitive) == 0) {
+        *type = "malicious";
+        *status = "Malicious";
+        score = 85;
+    } else {
+        *type = "suspicious";
+        *status = "Suspicious";
+        score = 55;
+    }
+    if (risk) *risk = score;
+}
+
+static void addUrlScanFactor(UrlScanResult &result, const QString &factor, const QString &description) {
+    UrlScanFactor f;
+    f.factor = factor;
+    f.description = description;
+    if (f.description.startsWith("✅")) { f.status = "Legitimate"; f.badgeColor = "#22C55E"; result.legit++; }
+    else if (f.description.startsWith("⚠️")) { f.status = "Phishing"; f.badgeColor = "#EF4444"; result.phish++; }
+    else { f.status = "Neutral"; f.badgeColor = "#F59E0B"; result.neutral++; }
+    result.factors.append(f);
+}
+
+// Same wording the backend uses for features_table in its JSON reply
+static QString urlFeatureMeaning(const QCborValue &value) {
+    if (!value.isInteger()) return "ℹ️ No data.";
+    switch (value.toInteger()) {
+    case 1: return "✅ Indicates the behaviour of a legitimate website.";
+    case -1: return "⚠️ Indicates phishing behavior.";
+    default: return "ℹ️ No strong indication of phishing or legitimacy.";
+    }
+}
+
+// Compact reply: {"classification", "conclusion", "factors": [[name, value], ...]}
+static UrlScanResult decodeUrlScanCbor(const QByteArray &data) {
+    UrlScanResult result;
+    QCborParserError parseError{};
+    const QCborValue doc = QCborValue::fromCbor(data, &parseError);
+    if (parseError.error != QCborError::NoError || !doc.isMap()) return result;
+
+    const QCborMap obj = doc.toMap();
+    result.valid = true;
+    result.classification = obj.value(QStringLiteral("classification")).toString();
+    result.conclusion = obj.value(QStringLiteral("conclusion")).toString();
+    for (const QCborValue &v : obj.value(QStringLiteral("factors")).toArray()) {
+        const QCborArray pair = v.toArray();
+        addUrlScanFactor(result, pair.at(0).toString(), urlFeatureMeaning(pair.at(1)));
+    }
+    return result;
+}
+
+static UrlScanResult decodeUrlScanResult(const QByteArray &data, bool cbor) {
+    if (cbor) return decodeUrlScanCbor(data);
+
+    UrlScanResult result;
+    QJsonParseError parseError{};
+    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) return result;
+
+    QJsonObject obj = doc.object();
+    result.valid = true;
+    result.classification = obj.value("classification").toString();
+    result.conclusion = obj.value("conclusion").toString();
+    for (const QJsonValue &v : obj.value("features_table").toArray()) {
+        QJsonObject fo = v.toObject();
+        addUrlScanFactor(result, fo.value("feature").toString(), fo.value("description").toString());
+    }
+    return result;
+}
+
+// /api/urls reply, newest first -> list entries, oldest first
+static QList<UrlHistoryEntry> decodeUrlHistory(const QByteArray &data) {
+    const QJsonArray urls = QJsonDocument::fromJson(data).object().value("urls").toArray();
+    QList<UrlHistoryEntry> entries;
+    entries.reserve(urls.size());
+    for (qsizetype i = urls.size() - 1; i >= 0; --i) {
+        const QJsonObject scan = urls.at(i).toObject();
+        UrlHistoryEntry entry;
+        urlVerdictStyle(scan.value("classification").toString(), &entry.type, &entry.status, nullptr);
+        entry.url = scan.value("url").toString();
+        entries.append(entry);
+    }
+    return entries;
+}
+
 // ==============================
 // Constructor & Destructor
 // ==============================
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), isDarkMode(true), currentRiskScore(0)
+    : QMainWindow(parent), isDarkMode(true), execShownFileId(0), currentRiskScore(0)
 {
     setupUI();
     networkManager = new QNetworkAccessManager(this);
-    execNetworkManager = new QNetworkAccessManager(this);
-    execPollTimer = new QTimer(this);
-    execPollTimer->setInterval(2000);
-    connect(execPollTimer, &QTimer::timeout, this, [this]() {
-        QNetworkRequest req(QUrl("http://127.0.0.1:8000/api/files"));
-        execNetworkManager->get(req);
-    });
+    // File watcher backend: URL/app.py by default, or secureguard-watcherd
+    const QString execApi = qEnvironmentVariable("SECUREGUARD_EXEC_API", "http://127.0.0.1:8000");
+    execEventStream = new ExecEventStream(QUrl(execApi), this);
+    connect(execEventStream, &ExecEventStream::resetRequested, this, &MainWindow::onExecStreamReset);
+    execUpdates = new ExecUpdateQueue(this);
+    connect(execEventStream, &ExecEventStream::fileEventsReceived, execUpdates, &ExecUpdateQueue::enqueue);
+    connect(execEventStream, &ExecEventStream::snapshotReceived, execUpdates, &ExecUpdateQueue::enqueueSnapshot);
+    connect(execUpdates, &ExecUpdateQueue::rowsReady, executableMonitorPage, &ExecutableMonitorPage::upsertFiles);
+    connect(execUpdates, &ExecUpdateQueue::rowsReady, this, &MainWindow::onExecRowsUpdated);
+    connect(execEventStream, &ExecEventStream::analysisTextReceived, this, &MainWindow::onExecAnalysisText);
+    connect(execEventStream, &ExecEventStream::queueDepthChanged, executableMonitorPage, &ExecutableMonitorPage::setBacklog);
+    connect(execEventStream, &ExecEventStream::recordReceived, this, &MainWindow::onExecRecordReceived);
+    connect(executableMonitorPage, &ExecutableMonitorPage::moreRequested, execEventStream, &ExecEventStream::loadMore);
     connect(networkManager, &QNetworkAccessManager::finished, this, &MainWindow::onAnalyzeUrlFinished);
-    connect(execNetworkManager, &QNetworkAccessManager::finished, this, &MainWindow::onExecPollFinished);
     applyDarkTheme();
+    loadUrlHistory();
 }
 
 MainWindow::~MainWindow() {}
@@ -375,106 +480,91 @@ QWidget* MainWindow::createExecutableMonitorPage() {
     ExecutableMonitorPage *page = new ExecutableMonitorPage();
     // Wire signals
     connect(page, &ExecutableMonitorPage::monitoringToggled, this, &MainWindow::onExecMonitoringToggled);
-    connect(page, &ExecutableMonitorPage::filterChanged, this, &MainWindow::onExecFilterChanged);
     connect(page, &ExecutableMonitorPage::itemActivated, this, &MainWindow::onExecItemActivated);
-    // Seed with some sample rows similar to the provided HTML
-    QList<QStringList> rows = {
-        {"svchost.exe", "Safe", "1h ago"},
-        {"malicious_payload.exe", "Critical", "2h ago"},
-        {"explorer.exe", "Safe", ""},
-        {"unknown_installer.msi", "Suspicious", "5h ago"}
-    };
-    page->setDetectedFiles(rows);
     return page;
 }
 
-void MainWindow::onExecPollFinished(QNetworkReply *reply) {
-    if (!reply) return;
-    if (reply->error() != QNetworkReply::NoError) {
-        reply->deleteLater();
-        return;
-    }
-    if (reply->url().toString().endsWith("/api/files")) {
-        const QByteArray data = reply->readAll();
-        QJsonParseError err{};
-        QJsonDocument doc = QJsonDocument::fromJson(data, &err);
-        if (err.error == QJsonParseError::NoError && doc.isArray()) {
-            execFiles = doc.array();
-            QList<QStringList> rows;
-            for (const QJsonValue &v : execFiles) {
-                QJsonObject obj = v.toObject();
-                const QString name = obj.value("name").toString();
-                if (!execFilterText.isEmpty() && !name.contains(execFilterText, Qt::CaseInsensitive)) continue;
-                const QString type = obj.value("type").toString();
-                const QString when = obj.value("details").toObject().value("created_at").toString();
-                QString status;
-                if (type.compare("suspicious", Qt::CaseInsensitive) == 0) status = "Suspicious";
-                else if (type.compare("error", Qt::CaseInsensitive) == 0) status = "Error";
-                else status = "Safe";
-                rows.append({name, status, when});
-            }
-            if (executableMonitorPage) executableMonitorPage->setDetectedFiles(rows);
-        }
-    }
-    reply->deleteLater();
+void MainWindow::onExecStreamReset() {
+    // Backend restarted or lost our cursor; the first page follows
+    execUpdates->clear();
+    execAiText.clear();
+    if (executableMonitorPage) executableMonitorPage->clearFiles();
 }
 
 // ==============================
-// Executable monitor slots (placeholders)
+// Executable monitor slots
 // ==============================
 void MainWindow::onExecMonitoringToggled(bool enabled) {
-    Q_UNUSED(enabled);
-    // TODO: Will connect to backend process monitoring toggle
+    if (enabled) execEventStream->start();
+    else execEventStream->stop();
 }
 
-void MainWindow::onExecFilterChanged(const QString &text) {
-    execFilterText = text;
-    // Re-render using cached execFiles
-    QList<QStringList> rows;
-    for (const QJsonValue &v : execFiles) {
-        QJsonObject obj = v.toObject();
-        const QString name = obj.value("name").toString();
-        if (!execFilterText.isEmpty() && !name.contains(execFilterText, Qt::CaseInsensitive)) continue;
-        const QString type = obj.value("type").toString();
-        const QString when = obj.value("details").toObject().value("created_at").toString();
-        QString status;
-        if (type.compare("suspicious", Qt::CaseInsensitive) == 0) status = "Suspicious";
-        else if (type.compare("error", Qt::CaseInsensitive) == 0) status = "Error";
-        else status = "Safe";
-        rows.append({name, status, when});
+void MainWindow::onExecItemActivated(int fileId) {
+    if (!executableMonitorPage) return;
+    const ExecFileRow *file = executableMonitorPage->fileById(fileId);
+    // Listed as a summary, or not loaded (e.g. a similar file on an older
+    // page): show it once the full record arrives
+    if (!file || file->summary) {
+        if (fileId > 0) execEventStream->fetchRecord(fileId);
+        return;
     }
-    if (executableMonitorPage) executableMonitorPage->setDetectedFiles(rows);
+    showExecDetailsFromObject(file->record);
 }
 
-void MainWindow::onExecItemActivated(const QString &exeName) {
-    // Find the object and populate right panel
-    for (const QJsonValue &v : execFiles) {
-        QJsonObject obj = v.toObject();
-        if (obj.value("name").toString().compare(exeName, Qt::CaseInsensitive) == 0) {
-            // Map details to page
-            const QJsonObject d = obj.value("details").toObject();
-            if (executableMonitorPage) {
-                QStringList suspiciousStrings;
-                for (const QJsonValue &sv : d.value("suspicious_strings").toArray()) {
-                    suspiciousStrings.append(sv.toString());
-                }
-                executableMonitorPage->setAnalysisDetails(
-                    obj.value("name").toString(),
-                    obj.value("path").toString(),
-                    obj.value("type").toString().toUpper(),
-                    d.value("ext").toString().toUpper(),
-                    d.value("size").toString(),
-                    d.value("rule").toString(),
-                    QStringList(),
-                    QStringList(),
-                    d.value("mime").toString(),
-                    d.value("hash").toString(),
-                    d.value("sha256").toString().left(32) + "...",
-                    suspiciousStrings
-                );
-            }
-            break;
-        }
+void MainWindow::onExecRecordReceived(const QJsonObject &record) {
+    if (!executableMonitorPage) return;
+    executableMonitorPage->upsertFiles({ExecFileRow::fromRecord(record)});
+    showExecDetailsFromObject(record);
+}
+
+void MainWindow::onExecRowsUpdated(const QList<ExecFileRow> &rows) {
+    for (const ExecFileRow &row : rows) {
+        if (row.summary) continue;
+        const QJsonObject d = row.record.value("details").toObject();
+        // Gemini has finished (or given up): the record carries the final text
+        if (!d.value("gemini_pending").toBool()) execAiText.remove(row.id);
+        // Keep the open file's panel current, e.g. when Gemini upgrades the verdict
+        if (row.id == execShownFileId && executableMonitorPage) showExecDetailsFromObject(row.record);
+    }
+}
+
+void MainWindow::onExecAnalysisText(int fileId, const QString &text) {
+    execAiText.insert(fileId, text);
+    if (fileId == execShownFileId && executableMonitorPage) executableMonitorPage->setAiAnalysis(text, true);
+}
+
+void MainWindow::showExecDetailsFromObject(const QJsonObject &obj) {
+    // Map details to page
+    const QJsonObject d = obj.value("details").toObject();
+    execShownFileId = obj.value("id").toInt();
+    QStringList suspiciousStrings;
+    for (const QJsonValue &sv : d.value("suspicious_strings").toArray()) {
+        suspiciousStrings.append(sv.toString());
+    }
+    QString status = obj.value("type").toString().toUpper();
+    if (d.value("allowlisted").toBool()) status += QStringLiteral(" (ALLOWLISTED)");
+    else if (d.value("cached").toBool()) status += QStringLiteral(" (CACHED)");
+    executableMonitorPage->setAnalysisDetails(
+        obj.value("name").toString(),
+        obj.value("path").toString(),
+        status,
+        d.value("ext").toString().toUpper(),
+        d.value("size").toString(),
+        d.value("rule").toString(),
+        QStringList(),
+        QStringList(),
+        d.value("mime").toString(),
+        d.value("hash").toString(),
+        d.value("sha256").toString().left(32) + "...",
+        suspiciousStrings
+    );
+    executableMonitorPage->setSimilarFiles(d.value("similar").toArray());
+    // While Gemini is still writing, show what has streamed in so far
+    if (d.value("gemini_pending").toBool()) {
+        executableMonitorPage->setAiAnalysis(execAiText.value(execShownFileId), true);
+    } else {
+        executableMonitorPage->setAiAnalysis(d.value("gemini").toString(),
+                                             obj.value("type").toString() == QLatin1String("analyzing"));
     }
 }
 
@@ -548,10 +638,7 @@ QWidget* MainWindow::createUrlDetectionPage() {
     QWidget *scrollWidget = new QWidget();
     scanResultsLayout = new QVBoxLayout(scrollWidget);
     scanResultsLayout->setSpacing(8);
-    
-    addSampleResults();
-    
-    scanResultsLayout->addStretch();
+    scanResultsLayout->addStretch(); // results go above it; past scans come from loadUrlHistory()
     scrollArea->setWidget(scrollWidget);
     
     pageLayout->addWidget(scrollArea, 1);
@@ -798,10 +885,23 @@ QWidget* MainWindow::createActionItem(const QString &icon, const QString &title,
     return item;
 }
 
-void MainWindow::addSampleResults() {
-    addScanResult("Safe", "https://example.com/login", "safe");
-    addScanResult("Malicious", "https://malicious.site/phishing", "malicious");
-    addScanResult("Suspicious", "https://suspicious.link/unknown", "suspicious");
+void MainWindow::loadUrlHistory() {
+    // Past scans kept by the backend, newest first
+    QNetworkRequest req(QUrl("http://127.0.0.1:8000/api/urls?limit=50"));
+    req.setRawHeader("Accept", "application/json");
+    QNetworkReply *reply = networkManager->get(req);
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        reply->deleteLater();
+        if (reply->error() != QNetworkReply::NoError) return; // backend not up yet; the list starts empty
+        // Parse on a worker; addScanResult appends, so entries come oldest first
+        auto *watcher = new QFutureWatcher<QList<UrlHistoryEntry>>(this);
+        connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]() {
+            const QList<UrlHistoryEntry> entries = watcher->result();
+            watcher->deleteLater();
+            for (const UrlHistoryEntry &entry : entries) addScanResult(entry.status, entry.url, entry.type);
+        });
+        watcher->setFuture(QtConcurrent::run(decodeUrlHistory, reply->readAll()));
+    });
 }
 
 void MainWindow::addScanResult(const QString &status, const QString &url, const QString &type) {
@@ -904,13 +1004,11 @@ void MainWindow::setActiveNavButton(QPushButton *activeBtn) {
 void MainWindow::showDashboard() {
     contentStack->setCurrentWidget(dashboardPage);
     setActiveNavButton(dashboardBtn);
-    if (execPollTimer && execPollTimer->isActive()) execPollTimer->stop();
 }
 
 void MainWindow::showUrlDetection() {
     contentStack->setCurrentWidget(urlDetectionPage);
     setActiveNavButton(urlDetectionBtn);
-    if (execPollTimer && execPollTimer->isActive()) execPollTimer->stop();
 }
 
 void MainWindow::showAnalysisDetails(const QString &url, int riskScore) {
@@ -958,7 +1056,9 @@ void MainWindow::onExecutableMonitorClicked() {
     if (executableMonitorPage) {
         contentStack->setCurrentWidget(executableMonitorPage);
         setActiveNavButton(executableMonitorBtn);
-        if (execPollTimer && !execPollTimer->isActive()) execPollTimer->start();
+        // The stream stays open once started: it costs nothing while idle
+        // and keeps the cache current for the next visit.
+        if (!execEventStream->isActive()) execEventStream->start();
     }
 }
 
@@ -990,12 +1090,15 @@ void MainWindow::onScanUrlClicked() {
     // Send POST to FastAPI
     QNetworkRequest req(QUrl("http://127.0.0.1:8000/analyze_url"));
     req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    req.setRawHeader("Accept", "application/cbor, application/json;q=0.9");
     networkManager->post(req, doc.toJson());
 }
 
 void MainWindow::onAnalyzeUrlFinished(QNetworkReply *reply) {
-    if (!reply) return;
+    // GETs (the scan history) are handled where they are sent
+    if (!reply || reply->operation() != QNetworkAccessManager::PostOperation) return;
     QByteArray data = reply->readAll();
+    const bool cbor = reply->header(QNetworkRequest::ContentTypeHeader).toString().startsWith("application/cbor");
     reply->deleteLater();
 
     if (reply->error() != QNetworkReply::NoError) {
@@ -1003,35 +1106,28 @@ void MainWindow::onAnalyzeUrlFinished(QNetworkReply *reply) {
         return;
     }
 
-    QJsonParseError parseError{};
-    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
-    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
-        QMessageBox::critical(this, "Scan Error", "Invalid JSON response from server.");
-        return;
-    }
-
-    QJsonObject obj = doc.object();
-    const QString classification = obj.value("classification").toString();
-    const QString conclusion = obj.value("conclusion").toString();
-    const QJsonArray features = obj.value("features_table").toArray();
+    // Parse and classify on a worker; only widget updates happen here
     const QString scannedUrl = urlInput ? urlInput->text().trimmed() : QString();
+    auto *watcher = new QFutureWatcher<UrlScanResult>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, scannedUrl]() {
+        const UrlScanResult result = watcher->result();
+        watcher->deleteLater();
+        if (!result.valid) {
+            QMessageBox::critical(this, "Scan Error", "Invalid response from server.");
+            return;
+        }
+        applyUrlScanResult(result, scannedUrl);
+    });
+    watcher->setFuture(QtConcurrent::run(decodeUrlScanResult, data, cbor));
+}
+
+void MainWindow::applyUrlScanResult(const UrlScanResult &result, const QString &scannedUrl) {
+    const QString &classification = result.classification;
 
     QString type;
     QString status;
     int risk = 0;
-    if (classification.compare("Legitimate", Qt::CaseInsensitive) == 0) {
-        type = "safe";
-        status = "Safe";
-        risk = 20;
-    } else if (classification.compare("Phishing", Qt::CaseInsensitive) == 0) {
-        type = "malicious";
-        status = "Malicious";
-        risk = 85;
-    } else {
-        type = "suspicious";
-        status = "Suspicious";
-        risk = 55;
-    }
+    urlVerdictStyle(classification, &type, &status, &risk);
 
     addScanResult(status, scannedUrl.isEmpty() ? "(unknown)" : scannedUrl, type);
 
@@ -1059,7 +1155,6 @@ void MainWindow::onAnalyzeUrlFinished(QNetworkReply *reply) {
     }
 
     // Fill table and counts
-    int legit = 0, phish = 0, neutral = 0;
     factorsTable->setRowCount(0);
     auto addRow = [&](const QString &factor, const QString &statusText, const QString &desc, const QString &badgeColor){
         int r = factorsTable->rowCount();
@@ -1073,21 +1168,13 @@ void MainWindow::onAnalyzeUrlFinished(QNetworkReply *reply) {
         factorsTable->setItem(r, 2, dItem);
     };
 
-    for (const QJsonValue &v : features) {
-        QJsonObject fo = v.toObject();
-        const QString factor = fo.value("feature").toString();
-        const QString meaning = fo.value("description").toString();
-        QString statusText;
-        QString badgeColor;
-        if (meaning.startsWith("✅")) { statusText = "Legitimate"; badgeColor = "#22C55E"; legit++; }
-        else if (meaning.startsWith("⚠️")) { statusText = "Phishing"; badgeColor = "#EF4444"; phish++; }
-        else { statusText = "Neutral"; badgeColor = "#F59E0B"; neutral++; }
-        addRow(factor, statusText, meaning, badgeColor);
+    for (const UrlScanFactor &f : result.factors) {
+        addRow(f.factor, f.status, f.description, f.badgeColor);
     }
 
-    if (legitimateCountLabel) legitimateCountLabel->setText(QString::number(legit));
-    if (phishingCountLabel) phishingCountLabel->setText(QString::number(phish));
-    if (neutralCountLabel) neutralCountLabel->setText(QString::number(neutral));
+    if (legitimateCountLabel) legitimateCountLabel->setText(QString::number(result.legit));
+    if (phishingCountLabel) phishingCountLabel->setText(QString::number(result.phish));
+    if (neutralCountLabel) neutralCountLabel->setText(QString::number(result.neutral));
 
     // Resize columns to fit content
     factorsTable->resizeColumnsToContents();
@@ -1095,8 +1182,8 @@ void MainWindow::onAnalyzeUrlFinished(QNetworkReply *reply) {
     // Navigate to details page populated with data
     showAnalysisDetails(scannedUrl, risk);
 
-    if (!conclusion.isEmpty()) {
-        QMessageBox::information(this, "Scan Complete", conclusion);
+    if (!result.conclusion.isEmpty()) {
+        QMessageBox::information(this, "Scan Complete", result.conclusion);
     }
     if (urlInput) urlInput->clear();
 }
@@ -1166,8 +1253,8 @@ void MainWindow::applyDarkTheme() {
         QScrollArea { border: none; }
 
         /* Table styling for Executable Monitor */
-        QTableWidget#detectedTable { background-color: transparent; gridline-color: transparent; }
-        QTableWidget#detectedTable::item { padding: 8px; }
+        QTableView#detectedTable { background-color: transparent; gridline-color: transparent; }
+        QTableView#detectedTable::item { padding: 8px; }
         QHeaderView::section { background-color: rgba(255,255,255,0.05); color: #E5E5E5; border: none; padding: 8px; font-weight: 600; }
         QTableCornerButton::section { background-color: transparent; border: none; }
         QTableView { alternate-background-color: rgba(255,255,255,0.03); selection-background-color: rgba(239,119,34,0.2); selection-color: #E5E5E5; }
@@ -1228,8 +1315,8 @@ void MainWindow::applyLightTheme() {
         QScrollArea { border: none; }
 
         /* Table styling for Executable Monitor */
-        QTableWidget#detectedTable { background-color: white; gridline-color: #EEE; }
-        QTableWidget#detectedTable::item { padding: 8px; }
+        QTableView#detectedTable { background-color: white; gridline-color: #EEE; }
+        QTableView#detectedTable::item { padding: 8px; }
         QHeaderView::section { background-color: #F3F4F6; color: #333; border: 1px solid #E5E7EB; padding: 8px; font-weight: 600; }
         QTableCornerButton::section { background-color: #F3F4F6; border: 1px solid #E5E7EB; }
         QTableView { alternate-background-color: #FAFAFA; selection-background-color: rgba(239,119,34,0.1); selection-color: #333; }
@@ -12,9 +12,37 @@
 #include <QTableWidget>
 #include <QLabel>
 #include "ExecutableMonitorPage.h"
-#include <QTimer>
+#include "ExecEventStream.h"
+#include "ExecUpdateQueue.h"
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QHash>
+
+// One row of the URL factors table, classified off the GUI thread.
+struct UrlScanFactor {
+    QString factor;
+    QString status;
+    QString description;
+    QString badgeColor;
+};
+
+// Decoded /analyze_url response, ready to be shown.
+struct UrlScanResult {
+    bool valid = false;
+    QString classification;
+    QString conclusion;
+    QList<UrlScanFactor> factors;
+    int legit = 0;
+    int phish = 0;
+    int neutral = 0;
+};
+
+// One past scan from /api/urls, as the scan results list shows it.
+struct UrlHistoryEntry {
+    QString status;
+    QString url;
+    QString type;
+};
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -52,10 +80,10 @@ private:
     QLineEdit *urlInput;
     QVBoxLayout *scanResultsLayout;
     QNetworkAccessManager *networkManager;
-    QNetworkAccessManager *execNetworkManager; // for executable monitor polling
-    QTimer *execPollTimer; // polling timer for /api/files
-    QJsonArray execFiles; // latest files from backend
-    QString execFilterText;
+    ExecEventStream *execEventStream; // push feed from /api/events
+    ExecUpdateQueue *execUpdates;     // decodes feed payloads off the GUI thread
+    int execShownFileId;              // file in the details panel; 0 = none
+    QHash<int, QString> execAiText;   // Gemini text still streaming, by file id
     
     // Analysis Details data
     QString currentAnalysisUrl;    // NEW: Store current URL being analyzed
@@ -80,12 +108,10 @@ private:
     QWidget* createUrlDetectionPage();
     QWidget* createAnalysisDetailsPage();  // NEW: Create analysis details page
     QWidget* createExecutableMonitorPage(); // NEW: Create executable monitor page
-    void startExecPolling();
-    void stopExecPolling();
-    void refreshExecTable(const QJsonArray &files);
     void showExecDetailsFromObject(const QJsonObject &obj);
-    void addSampleResults();
+    void loadUrlHistory();
     void addScanResult(const QString &status, const QString &url, const QString &type);
+    void applyUrlScanResult(const UrlScanResult &result, const QString &scannedUrl);
     void setActiveNavButton(QPushButton *activeBtn);
     void applyDarkTheme();
     void applyLightTheme();
@@ -112,9 +138,11 @@ private slots:
     void onAnalyzeUrlFinished(QNetworkReply *reply);
     // Executable monitor placeholders
     void onExecMonitoringToggled(bool enabled);
-    void onExecFilterChanged(const QString &text);
-    void onExecItemActivated(const QString &exeName);
-    void onExecPollFinished(QNetworkReply *reply);
+    void onExecItemActivated(int fileId);
+    void onExecStreamReset();
+    void onExecRecordReceived(const QJsonObject &record);
+    void onExecRowsUpdated(const QList<ExecFileRow> &rows);
+    void onExecAnalysisText(int fileId, const QString &text);
 };
 
 #endif // MAINWINDOW_H
\ No newline at end of file
@@ -0,0 +1,287 @@
+#include "Allowlist.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <queue>
+
+namespace {
+
+const char kMagic[8] = {'S', 'G', 'A', 'L', 'L', 'O', 'W', '1'};
+const uint32_t kFormat = 1;       // bump when the layout below changes
+const size_t kHeaderBytes = 4096; // header is padded to one page
+const size_t kBlockWords = 8;     // one 64-byte Bloom block per key
+const int kInterpolationSteps = 8;
+
+using Key = std::array<uint8_t, Allowlist::kKeyBytes>;
+
+// Hashes are uniform, so the filter takes its bits straight from the key:
+// bytes 24..27 pick the block and bytes 8..15 one bit in each of its words
+inline uint64_t blockOf(const uint8_t *key, uint64_t blocks) {
+    const uint64_t h = uint64_t(key[24]) << 24 | uint64_t(key[25]) << 16 | uint64_t(key[26]) << 8 | key[27];
+    return (h * blocks) >> 32;
+}
+
+// Big-endian, so it orders like memcmp
+inline uint64_t prefix(const uint8_t *key) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v = v << 8 | key[i];
+    return v;
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool parseHex(const char *hex, uint8_t *key) {
+    for (size_t i = 0; i < Allowlist::kKeyBytes; ++i) {
+        const int hi = hexValue(hex[2 * i]), lo = hexValue(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        key[i] = uint8_t(hi << 4 | lo);
+    }
+    return true;
+}
+
+// The first token of exactly 64 hex digits in the line
+bool findHash(const std::string &line, Key &key) {
+    size_t i = 0;
+    while (i < line.size()) {
+        size_t end = i;
+        while (end < line.size() && hexValue(line[end]) >= 0) ++end;
+        if (end - i == 2 * Allowlist::kKeyBytes) return parseHex(line.data() + i, key.data());
+        i = end + 1;
+    }
+    return false;
+}
+
+bool writeRun(std::vector<Key> &keys, const std::string &path) {
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    FILE *f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    const bool ok = fwrite(keys.data(), sizeof(Key), keys.size(), f) == keys.size();
+    return fclose(f) == 0 && ok;
+}
+
+} // namespace
+
+struct Allowlist::Header {
+    char magic[8];
+    uint32_t format;
+    uint32_t keyBytes;
+    uint64_t count;
+    uint64_t bloomBlocks;
+    uint64_t bloomOffset;
+    uint64_t keysOffset;
+};
+
+bool Allowlist::open(const std::string &path, std::string *error) {
+    close();
+    if (!file.open(path, error, MappedFile::Random)) return false;
+    const Header *h = reinterpret_cast<const Header *>(file.data());
+    if (file.size() < kHeaderBytes || memcmp(h->magic, kMagic, sizeof(kMagic)) != 0 || h->format != kFormat
+        || h->keyBytes != kKeyBytes) {
+        if (error) *error = path + ": not an allowlist (or built by another version)";
+        file.close();
+        return false;
+    }
+    // Checked without overflow: a damaged header must not point outside the file
+    const uint64_t size = file.size();
+    if (h->bloomBlocks == 0 || h->bloomOffset != kHeaderBytes || h->bloomBlocks > (size - kHeaderBytes) / 64
+        || h->keysOffset != kHeaderBytes + h->bloomBlocks * 64 || h->count != (size - h->keysOffset) / kKeyBytes
+        || (size - h->keysOffset) % kKeyBytes != 0) {
+        if (error) *error = path + ": truncated or damaged allowlist";
+        file.close();
+        return false;
+    }
+    bloom = reinterpret_cast<const uint64_t *>(file.data() + h->bloomOffset);
+    bloomBlocks = h->bloomBlocks;
+    keys = file.data() + h->keysOffset;
+    count = h->count;
+    return true;
+}
+
+void Allowlist::close() {
+    file.close();
+    bloom = nullptr;
+    bloomBlocks = 0;
+    keys = nullptr;
+    count = 0;
+}
+
+bool Allowlist::contains(const uint8_t key[kKeyBytes]) const {
+    if (!keys) return false;
+    lookups.fetch_add(1, std::memory_order_relaxed);
+    const uint64_t *block = bloom + blockOf(key, bloomBlocks) * kBlockWords;
+    for (size_t i = 0; i < kBlockWords; ++i) {
+        if (!(block[i] >> (key[8 + i] & 63) & 1)) {
+            bloomRejects.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+    if (!search(key)) return false;
+    hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool Allowlist::containsHex(const std::string &sha256) const {
+    uint8_t key[kKeyBytes];
+    return sha256.size() == 2 * kKeyBytes && parseHex(sha256.data(), key) && contains(key);
+}
+
+bool Allowlist::search(const uint8_t *key) const {
+    const auto at = [this](uint64_t i) { return keys + i * kKeyBytes; };
+    const uint64_t target = prefix(key);
+    uint64_t lo = 0, hi = count; // [lo, hi)
+
+    // Interpolate on the 8-byte prefix: uniform hashes put the guess within
+    // a few entries. Capped, so a skewed list still ends in a binary search.
+    for (int step = 0; step < kInterpolationSteps && hi - lo > 16; ++step) {
+        const uint64_t first = prefix(at(lo)), last = prefix(at(hi - 1));
+        if (target < first || target > last) return false;
+        if (first == last) break;
+        const double fraction = double(target - first) / double(last - first);
+        const uint64_t mid = lo + std::min(hi - 1 - lo, uint64_t(fraction * double(hi - 1 - lo)));
+        const int c = memcmp(at(mid), key, kKeyBytes);
+        if (c == 0) return true;
+        if (c < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    while (lo < hi) {
+        const uint64_t mid = lo + (hi - lo) / 2;
+        const int c = memcmp(at(mid), key, kKeyBytes);
+        if (c == 0) return true;
+        if (c < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return false;
+}
+
+Allowlist::Stats Allowlist::stats() const {
+    Stats s;
+    s.entries = count;
+    s.bloomBytes = bloomBlocks * 64;
+    s.lookups = lookups.load(std::memory_order_relaxed);
+    s.bloomRejects = bloomRejects.load(std::memory_order_relaxed);
+    s.hits = hits.load(std::memory_order_relaxed);
+    return s;
+}
+
+int64_t Allowlist::build(const std::vector<std::string> &inputs, const std::string &output,
+                         const BuildOptions &options, std::string *error) {
+    static_assert(sizeof(Header) <= kHeaderBytes, "header must fit its page");
+    const auto fail = [error](const std::string &message) {
+        if (error) *error = message;
+        return int64_t(-1);
+    };
+    const std::string tempBase = options.tempDir.empty() ? output : options.tempDir + "/allowlist";
+    std::vector<std::string> runs;
+    const auto removeRuns = [&runs]() {
+        for (const std::string &run : runs) std::remove(run.c_str());
+    };
+
+    // Sorted runs of at most runKeys distinct keys
+    std::vector<Key> pending;
+    pending.reserve(std::min<size_t>(options.runKeys, 1u << 20));
+    uint64_t total = 0;
+    const auto flush = [&]() {
+        runs.push_back(tempBase + ".run" + std::to_string(runs.size()));
+        if (!writeRun(pending, runs.back())) return false;
+        total += pending.size();
+        pending.clear();
+        return true;
+    };
+    for (const std::string &input : inputs) {
+        std::ifstream in(input, std::ios::binary);
+        if (!in) {
+            removeRuns();
+            return fail("cannot read " + input);
+        }
+        std::string line;
+        Key key;
+        while (std::getline(in, line)) {
+            if (!findHash(line, key)) continue;
+            pending.push_back(key);
+            if (pending.size() >= std::max<size_t>(options.runKeys, 1) && !flush()) {
+                removeRuns();
+                return fail("cannot write " + runs.back());
+            }
+        }
+    }
+    if (!pending.empty() && !flush()) {
+        removeRuns();
+        return fail("cannot write " + runs.back());
+    }
+
+    // The filter is sized for the keys before cross-run duplicates are dropped
+    const uint64_t bloomBlocks = std::max<uint64_t>(1, (total * std::max(options.bitsPerKey, 1u) + 511) / 512);
+    std::vector<uint64_t> filter(bloomBlocks * kBlockWords);
+    const std::string temp = output + ".tmp";
+    FILE *out = fopen(temp.c_str(), "wb");
+    if (!out) {
+        removeRuns();
+        return fail("cannot write " + temp);
+    }
+    const uint64_t keysOffset = kHeaderBytes + bloomBlocks * 64;
+    bool ok = true;
+    std::vector<uint8_t> zeros(1 << 16);
+    for (uint64_t left = keysOffset; ok && left; left -= std::min<uint64_t>(left, zeros.size())) {
+        ok = fwrite(zeros.data(), 1, size_t(std::min<uint64_t>(left, zeros.size())), out) > 0;
+    }
+
+    // K-way merge, dropping duplicates, while setting the filter's bits
+    std::vector<FILE *> readers;
+    using Head = std::pair<Key, size_t>;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    for (size_t i = 0; i < runs.size(); ++i) {
+        readers.push_back(fopen(runs[i].c_str(), "rb"));
+        Key key;
+        if (!readers.back()) ok = false;
+        else if (fread(key.data(), kKeyBytes, 1, readers.back()) == 1) heads.push({key, i});
+    }
+    uint64_t written = 0;
+    Key previous;
+    while (ok && !heads.empty()) {
+        const Head head = heads.top();
+        heads.pop();
+        Key next;
+        if (fread(next.data(), kKeyBytes, 1, readers[head.second]) == 1) heads.push({next, head.second});
+        if (written && head.first == previous) continue;
+        ok = fwrite(head.first.data(), kKeyBytes, 1, out) == 1;
+        uint64_t *block = filter.data() + blockOf(head.first.data(), bloomBlocks) * kBlockWords;
+        for (size_t i = 0; i < kBlockWords; ++i) block[i] |= uint64_t(1) << (head.first[8 + i] & 63);
+        previous = head.first;
+        ++written;
+    }
+    for (FILE *reader : readers) {
+        if (reader) fclose(reader);
+    }
+    removeRuns();
+
+    Header header = {};
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.format = kFormat;
+    header.keyBytes = kKeyBytes;
+    header.count = written;
+    header.bloomBlocks = bloomBlocks;
+    header.bloomOffset = kHeaderBytes;
+    header.keysOffset = keysOffset;
+    ok = ok && fseek(out, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, out) == 1
+         && fseek(out, long(kHeaderBytes), SEEK_SET) == 0
+         && fwrite(filter.data(), sizeof(uint64_t), filter.size(), out) == filter.size();
+    ok = fclose(out) == 0 && ok;
+    // Replaced only once complete, so a running reader never sees half a
+    // file. rename() replaces atomically on POSIX; Windows wants it gone.
+#ifdef _WIN32
+    std::remove(output.c_str());
+#endif
+    if (!ok || std::rename(temp.c_str(), output.c_str()) != 0) {
+        std::remove(temp.c_str());
+        return fail("cannot write " + output);
+    }
+    return int64_t(written);
+}
@@ -0,0 +1,77 @@
+#ifndef ALLOWLIST_H
+#define ALLOWLIST_H
+
+#include "MappedFile.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Known-good SHA-256 hashes (e.g. the NSRL), read straight from a
+// memory-mapped file built by build(): a fixed header, a blocked Bloom
+// filter, then the hashes sorted ascending. open() checks the header and
+// the size and nothing else, so even a file with hundreds of millions of
+// hashes is ready at once; pages are faulted in as lookups touch them.
+//
+// A lookup reads one 64-byte Bloom block, which rejects almost every
+// unknown hash. The rest (about 1 in 200 at the default 12 bits per hash)
+// and the real hits are confirmed by an interpolation search over the
+// sorted hashes, which are uniform, so it takes a few probes.
+//
+// Read-only once open; contains() is thread-safe.
+class Allowlist {
+public:
+    static constexpr size_t kKeyBytes = 32;
+    static constexpr unsigned kDefaultBitsPerKey = 12;
+
+    struct Stats {
+        uint64_t entries = 0;
+        uint64_t bloomBytes = 0;
+        uint64_t lookups = 0;
+        uint64_t bloomRejects = 0; // lookups answered by the filter alone
+        uint64_t hits = 0;
+    };
+
+    struct BuildOptions {
+        unsigned bitsPerKey = kDefaultBitsPerKey;
+        size_t runKeys = 16u * 1024 * 1024; // keys sorted in memory per temporary run (512 MiB)
+        std::string tempDir;                // for the runs; next to the output by default
+    };
+
+    Allowlist() = default;
+    Allowlist(const Allowlist &) = delete;
+    Allowlist &operator=(const Allowlist &) = delete;
+
+    bool open(const std::string &path, std::string *error = nullptr);
+    void close();
+    bool isOpen() const { return keys != nullptr; }
+
+    bool contains(const uint8_t key[kKeyBytes]) const;
+    bool containsHex(const std::string &sha256) const;
+    Stats stats() const;
+
+    // Writes an allowlist from text files with one SHA-256 per line: the
+    // first 64-hex-digit token counts, so sha256sum output and CSV exports
+    // work as they are; other lines are skipped. Inputs larger than
+    // runKeys are sorted in runs on disk and merged; duplicates are
+    // dropped. Returns the number of distinct hashes written, or -1.
+    static int64_t build(const std::vector<std::string> &inputs, const std::string &output,
+                         const BuildOptions &options, std::string *error = nullptr);
+
+private:
+    struct Header;
+
+    bool search(const uint8_t *key) const;
+
+    MappedFile file;
+    const uint64_t *bloom = nullptr; // bloomBlocks blocks of 8 words
+    uint64_t bloomBlocks = 0;
+    const uint8_t *keys = nullptr;
+    uint64_t count = 0;
+    mutable std::atomic<uint64_t> lookups{0};
+    mutable std::atomic<uint64_t> bloomRejects{0};
+    mutable std::atomic<uint64_t> hits{0};
+};
+
+#endif // ALLOWLIST_H
@@ -0,0 +1,271 @@
+#include "ByteHistogram.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SG_HAVE_X86_KERNELS 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SG_TARGET(isa)
+#else
+#define SG_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace {
+
+// Sub-histograms use 32-bit counters; folding into the 64-bit totals every
+// 1 GiB keeps any single counter far from overflow.
+const size_t kFlushBytes = size_t(1) << 30;
+
+template <int Lanes>
+struct SubHistograms {
+    uint32_t c[Lanes][256];
+
+    SubHistograms() { memset(c, 0, sizeof(c)); }
+
+    void foldInto(uint64_t counts[256]) const {
+        for (int b = 0; b < 256; ++b) {
+            uint64_t sum = 0;
+            for (int l = 0; l < Lanes; ++l) sum += c[l][b];
+            counts[b] += sum;
+        }
+    }
+};
+
+void accumulateScalar(const uint8_t *data, size_t len, uint64_t counts[256]) {
+    while (len) {
+        const size_t n = len < kFlushBytes ? len : kFlushBytes;
+        SubHistograms<4> sub;
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            ++sub.c[0][data[i]];
+            ++sub.c[1][data[i + 1]];
+            ++sub.c[2][data[i + 2]];
+            ++sub.c[3][data[i + 3]];
+        }
+        for (; i < n; ++i) ++sub.c[0][data[i]];
+        sub.foldInto(counts);
+        data += n;
+        len -= n;
+    }
+}
+
+#ifdef SG_HAVE_X86_KERNELS
+
+// Eight bytes of a 64-bit word, one per sub-histogram
+inline void countWord(SubHistograms<8> &sub, uint64_t w) {
+    ++sub.c[0][w & 0xff];
+    ++sub.c[1][(w >> 8) & 0xff];
+    ++sub.c[2][(w >> 16) & 0xff];
+    ++sub.c[3][(w >> 24) & 0xff];
+    ++sub.c[4][(w >> 32) & 0xff];
+    ++sub.c[5][(w >> 40) & 0xff];
+    ++sub.c[6][(w >> 48) & 0xff];
+    ++sub.c[7][w >> 56];
+}
+
+// 16-byte loads split into two words in registers: half the loads of the
+// scalar path and eight independent counter streams.
+SG_TARGET("sse2")
+void accumulateSse2(const uint8_t *data, size_t len, uint64_t counts[256]) {
+    while (len) {
+        const size_t n = len < kFlushBytes ? len : kFlushBytes;
+        SubHistograms<8> sub;
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            countWord(sub, uint64_t(_mm_cvtsi128_si64(v)));
+            countWord(sub, uint64_t(_mm_cvtsi128_si64(_mm_unpackhi_epi64(v, v))));
+        }
+        for (; i < n; ++i) ++sub.c[0][data[i]];
+        sub.foldInto(counts);
+        data += n;
+        len -= n;
+    }
+}
+
+// As SSE2 with 32-byte loads, plus a vector compare that turns a block of
+// one repeated byte (zero padding, fill) into a single add.
+SG_TARGET("avx2")
+void accumulateAvx2(const uint8_t *data, size_t len, uint64_t counts[256]) {
+    while (len) {
+        const size_t n = len < kFlushBytes ? len : kFlushBytes;
+        SubHistograms<8> sub;
+        size_t i = 0;
+        for (; i + 32 <= n; i += 32) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            const __m256i first = _mm256_set1_epi8(char(data[i]));
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, first)) == -1) {
+                sub.c[0][data[i]] += 32;
+                continue;
+            }
+            const __m128i lo = _mm256_castsi256_si128(v);
+            const __m128i hi = _mm256_extracti128_si256(v, 1);
+            countWord(sub, uint64_t(_mm_cvtsi128_si64(lo)));
+            countWord(sub, uint64_t(_mm_extract_epi64(lo, 1)));
+            countWord(sub, uint64_t(_mm_cvtsi128_si64(hi)));
+            countWord(sub, uint64_t(_mm_extract_epi64(hi, 1)));
+        }
+        for (; i < n; ++i) ++sub.c[0][data[i]];
+        sub.foldInto(counts);
+        data += n;
+        len -= n;
+    }
+}
+
+bool cpuHasAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false; // OS saves YMM state
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // SG_HAVE_X86_KERNELS
+
+ByteHistogram::Kernel detectKernel() {
+    if (const char *forced = getenv("SG_HISTOGRAM_KERNEL")) {
+        for (ByteHistogram::Kernel k : {ByteHistogram::Scalar, ByteHistogram::Sse2, ByteHistogram::Avx2}) {
+            if (strcmp(forced, ByteHistogram::kernelName(k)) == 0 && ByteHistogram::kernelSupported(k)) return k;
+        }
+    }
+    if (ByteHistogram::kernelSupported(ByteHistogram::Avx2)) return ByteHistogram::Avx2;
+    if (ByteHistogram::kernelSupported(ByteHistogram::Sse2)) return ByteHistogram::Sse2;
+    return ByteHistogram::Scalar;
+}
+
+} // namespace
+
+bool ByteHistogram::kernelSupported(Kernel kernel) {
+    switch (kernel) {
+    case Scalar:
+        return true;
+#ifdef SG_HAVE_X86_KERNELS
+    case Sse2:
+        return true; // baseline on x86-64
+    case Avx2: {
+        static const bool avx2 = cpuHasAvx2();
+        return avx2;
+    }
+#endif
+    default:
+        return false;
+    }
+}
+
+const char *ByteHistogram::kernelName(Kernel kernel) {
+    switch (kernel) {
+    case Sse2: return "sse2";
+    case Avx2: return "avx2";
+    default: return "scalar";
+    }
+}
+
+ByteHistogram::Kernel ByteHistogram::bestKernel() {
+    static const Kernel best = detectKernel();
+    return best;
+}
+
+void ByteHistogram::accumulate(const uint8_t *data, size_t len, uint64_t counts[256]) {
+    accumulate(bestKernel(), data, len, counts);
+}
+
+void ByteHistogram::accumulate(Kernel kernel, const uint8_t *data, size_t len, uint64_t counts[256]) {
+#ifdef SG_HAVE_X86_KERNELS
+    if (kernel == Avx2 && kernelSupported(Avx2)) {
+        accumulateAvx2(data, len, counts);
+        return;
+    }
+    if (kernel == Sse2) {
+        accumulateSse2(data, len, counts);
+        return;
+    }
+#endif
+    (void)kernel;
+    accumulateScalar(data, len, counts);
+}
+
+double ByteHistogram::entropy(const uint64_t counts[256], uint64_t total) {
+    if (total == 0) return 0;
+    double entropy = 0;
+    for (int b = 0; b < 256; ++b) {
+        if (counts[b] == 0) continue;
+        const double p = double(counts[b]) / double(total);
+        entropy -= p * std::log2(p);
+    }
+    return entropy;
+}
+
+double ByteHistogram::entropy(const uint8_t *data, size_t len) {
+    uint64_t counts[256] = {};
+    accumulate(data, len, counts);
+    return entropy(counts, len);
+}
+
+std::vector<double> ByteHistogram::entropyProfile(const uint8_t *data, size_t len, size_t window, size_t step) {
+    std::vector<double> profile;
+    if (len == 0 || window == 0 || step == 0) return profile;
+    if (len <= window) {
+        profile.push_back(entropy(data, len));
+        return profile;
+    }
+    profile.reserve((len - window) / step + 1);
+
+    // Disjoint or gapped windows: count each one from scratch
+    if (step >= window) {
+        for (size_t off = 0; off + window <= len; off += step) profile.push_back(entropy(data + off, window));
+        return profile;
+    }
+
+    // Overlapping windows: slide the counts by `step` bytes at a time. Every
+    // window has the same total, so H = log2(W) - sum(c * log2 c) / W with
+    // c * log2 c looked up instead of a log2 per bin per window.
+    std::vector<double> clogc(window + 1);
+    for (size_t c = 1; c <= window; ++c) clogc[c] = double(c) * std::log2(double(c));
+    const double logWindow = std::log2(double(window));
+    auto windowEntropy = [&](const uint64_t counts[256]) {
+        double sum = 0;
+        for (int b = 0; b < 256; ++b) sum += clogc[counts[b]];
+        const double h = logWindow - sum / double(window);
+        return h > 0 ? h : 0.0;
+    };
+
+    // Bytes entering and leaving are tallied in separate, two-way split
+    // tables so a run of one value is not one long read-modify-write chain
+    uint64_t counts[256] = {};
+    accumulate(data, window, counts);
+    profile.push_back(windowEntropy(counts));
+    uint32_t in[2][256], out[2][256];
+    for (size_t off = step; off + window <= len; off += step) {
+        const uint8_t *leaving = data + off - step;
+        const uint8_t *entering = data + off - step + window;
+        memset(in, 0, sizeof(in));
+        memset(out, 0, sizeof(out));
+        size_t j = 0;
+        for (; j + 2 <= step; j += 2) {
+            ++out[0][leaving[j]];
+            ++in[0][entering[j]];
+            ++out[1][leaving[j + 1]];
+            ++in[1][entering[j + 1]];
+        }
+        for (; j < step; ++j) {
+            ++out[0][leaving[j]];
+            ++in[0][entering[j]];
+        }
+        for (int b = 0; b < 256; ++b) counts[b] += uint64_t(in[0][b] + in[1][b]) - (out[0][b] + out[1][b]);
+        profile.push_back(windowEntropy(counts));
+    }
+    return profile;
+}
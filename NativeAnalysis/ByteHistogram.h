@@ -0,0 +1,33 @@
+#ifndef BYTEHISTOGRAM_H
+#define BYTEHISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Byte-frequency counting and Shannon entropy. The counting kernel is
+// picked at runtime from the best one the CPU supports (AVX2, SSE2 or
+// portable scalar); every kernel spreads increments over several
+// sub-histograms so runs of one byte value do not serialize on a single
+// counter's store-to-load dependency.
+class ByteHistogram {
+public:
+    enum Kernel { Scalar, Sse2, Avx2 };
+
+    static Kernel bestKernel(); // honours SG_HISTOGRAM_KERNEL=scalar|sse2|avx2
+    static bool kernelSupported(Kernel kernel);
+    static const char *kernelName(Kernel kernel);
+
+    // Adds the byte counts of data to counts (which is not cleared)
+    static void accumulate(const uint8_t *data, size_t len, uint64_t counts[256]);
+    static void accumulate(Kernel kernel, const uint8_t *data, size_t len, uint64_t counts[256]);
+
+    static double entropy(const uint64_t counts[256], uint64_t total);
+    static double entropy(const uint8_t *data, size_t len);
+
+    // Entropy of [i*step, i*step + window) for every window that fits; a
+    // shorter input yields one value for the whole input.
+    static std::vector<double> entropyProfile(const uint8_t *data, size_t len, size_t window, size_t step);
+};
+
+#endif // BYTEHISTOGRAM_H
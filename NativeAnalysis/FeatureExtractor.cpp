@@ -0,0 +1,297 @@
+#include "FeatureExtractor.h"
+#include "ByteHistogram.h"
+#include "HexEncode.h"
+#include "JsonText.h"
+#include "MappedFile.h"
+#include "Md5.h"
+#include "PatternMatcher.h"
+#include "PeParser.h"
+#include "Sha256.h"
+#include "SimilarityDigest.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+// extract_features.py: suspicious_keywords
+const char *const kSuspiciousKeywords[] = {
+    "cmd.exe", "powershell", "http://", "https://",
+    "system32", "regedit", "taskkill", "netstat",
+    "password", "admin", "administrator", "root",
+    "exec", "eval", "execute", "shell", "spawn",
+    "download", "upload", "inject", "payload",
+    "malware", "virus", "trojan", "backdoor",
+    "keylogger", "ransomware", "botnet", "cryptocurrency",
+};
+
+const size_t kNoString = size_t(-1);
+
+const PatternMatcher &suspiciousKeywords() {
+    static const PatternMatcher matcher(
+        std::vector<std::string>(std::begin(kSuspiciousKeywords), std::end(kSuspiciousKeywords)),
+        PatternMatcher::Literal);
+    return matcher;
+}
+
+inline bool printable(uint8_t b) { return b >= 0x20 && b <= 0x7e; }
+
+inline char lowerAscii(char c) { return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c; }
+
+std::string lowerCopy(const std::string &s) {
+    std::string out(s);
+    for (char &c : out) c = lowerAscii(c);
+    return out;
+}
+
+// Printable runs of at least kMinStringLength characters, as ASCII bytes and
+// as UTF-16LE (char, 0x00) pairs, with state carried across blocks. Each
+// kind stops collecting once it has kMaxStrings, since only the first
+// kMaxStrings of ASCII-then-UTF-16 are reported.
+class StringScanner {
+public:
+    StringScanner() : offset(0), prev(0) {}
+
+    bool done() const {
+        return ascii.size() >= FeatureExtractor::kMaxStrings && wide.size() >= FeatureExtractor::kMaxStrings;
+    }
+
+    void feed(const uint8_t *data, size_t len) {
+        for (size_t i = 0; i < len; ++i, ++offset) {
+            const uint8_t b = data[i];
+            if (ascii.size() < FeatureExtractor::kMaxStrings) {
+                if (!printable(b)) flushAscii();
+                else if (asciiRun.size() < FeatureExtractor::kMaxStringLength) asciiRun.push_back(char(b));
+            }
+            if (offset > 0 && wide.size() < FeatureExtractor::kMaxStrings) {
+                // The pair ending here starts at offset - 1; the two byte
+                // parities form independent, never-overlapping runs.
+                const int parity = int((offset - 1) & 1);
+                std::string &run = wideRun[parity];
+                if (!printable(prev) || b != 0) flushWide(parity);
+                else if (run.size() < FeatureExtractor::kMaxStringLength) run.push_back(char(prev));
+            }
+            prev = b;
+        }
+    }
+
+    std::vector<std::string> finish() {
+        flushAscii();
+        flushWide(0); // at most one of the two can still be open
+        flushWide(1);
+        std::vector<std::string> all;
+        all.reserve(ascii.size() + wide.size());
+        all.insert(all.end(), ascii.begin(), ascii.end());
+        all.insert(all.end(), wide.begin(), wide.end());
+        if (all.size() > FeatureExtractor::kMaxStrings) all.resize(FeatureExtractor::kMaxStrings);
+        return all;
+    }
+
+private:
+    void flushAscii() {
+        if (asciiRun.size() >= FeatureExtractor::kMinStringLength && ascii.size() < FeatureExtractor::kMaxStrings) {
+            ascii.push_back(asciiRun);
+        }
+        asciiRun.clear();
+    }
+
+    void flushWide(int parity) {
+        std::string &run = wideRun[parity];
+        if (run.size() >= FeatureExtractor::kMinStringLength && wide.size() < FeatureExtractor::kMaxStrings) {
+            wide.push_back(run);
+        }
+        run.clear();
+    }
+
+    uint64_t offset;
+    uint8_t prev;
+    std::string asciiRun;
+    std::string wideRun[2];
+    std::vector<std::string> ascii;
+    std::vector<std::string> wide;
+};
+
+} // namespace
+
+bool FeatureExtractor::isExecutableName(const std::string &extension) {
+    static const char *const kExecutable[] = {".exe", ".dll", ".bat", ".cmd", ".ps1", ".vbs", ".js", ".msi", ".scr"};
+    for (const char *ext : kExecutable) {
+        if (extension == ext) return true;
+    }
+    return false;
+}
+
+PeInfo FeatureExtractor::parsePe(const uint8_t *data, size_t size) {
+    PeInfo pe;
+    PeImage image;
+    if (!PeParser::parse(data, size, image)) return pe;
+    pe.valid = true;
+    pe.sections = image.sectionCount;
+    pe.timestamp = image.timestamp;
+    pe.characteristics = image.characteristics;
+    pe.hasSecurityDirectory = image.certificateOffset != 0 && image.certificateSize != 0;
+    pe.tlsCallbacks = image.tlsCallbacks.size();
+    pe.overlayPayload = PeParser::overlayPayload(image);
+    for (const PeImage::Section &s : image.sections) {
+        if (s.entropy > PeParser::kPackedEntropy) pe.packedSections.emplace_back(s.name);
+    }
+    pe.json = PeParser::toJson(image);
+    pe.imphash = PeParser::importHash(image);
+    return pe;
+}
+
+bool FeatureExtractor::extract(const std::string &path, FileFeatures &out, std::string *error) {
+    MappedFile file;
+    if (!file.open(path, error)) return false;
+    extract(file, path, out);
+    return true;
+}
+
+bool FeatureExtractor::extract(const MappedFile &file, const std::string &path, FileFeatures &out,
+                               const PatternMatcher *contentPatterns, const std::atomic<bool> *cancel) {
+    const std::string knownSha256 = out.sha256;
+    out = FileFeatures();
+    out.path = path;
+    const size_t slash = path.find_last_of("/\\");
+    const std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    // os.path.splitext: leading dots do not start an extension
+    const size_t firstReal = name.find_first_not_of('.');
+    const size_t dot = name.find_last_of('.');
+    if (dot != std::string::npos && firstReal != std::string::npos && dot > firstReal) {
+        out.extension = lowerCopy(name.substr(dot));
+    }
+    out.isExecutable = isExecutableName(out.extension);
+    out.size = file.size();
+    out.changeTime = file.changeTime();
+    out.modifyTime = file.modifyTime();
+
+    const uint8_t *data = file.data();
+    const size_t size = file.size();
+    out.fileHeader = hexEncode(data, std::min(size, kHeaderBytes));
+
+    // The one pass over the content
+    Sha256 sha256;
+    Md5 md5;
+    SimilarityDigest similarity;
+    StringScanner strings;
+    PatternMatcher::Stream patternStream; // carries hits across block edges
+    if (contentPatterns) out.contentPatternHits.assign(contentPatterns->patternCount(), 0);
+    const bool complete = file.forEachBlock(kBlockSize, [&](const uint8_t *block, size_t len, size_t) {
+        if (cancel && cancel->load(std::memory_order_relaxed)) return false;
+        if (knownSha256.empty()) sha256.update(block, len);
+        md5.update(block, len);
+        similarity.update(block, len);
+        ByteHistogram::accumulate(block, len, out.histogram);
+        if (!strings.done()) strings.feed(block, len);
+        if (contentPatterns) {
+            contentPatterns->scan(patternStream, block, len, [&](const PatternMatcher::Hit &hit) {
+                uint32_t &count = out.contentPatternHits[hit.pattern];
+                if (count != UINT32_MAX) ++count;
+                return true;
+            });
+        }
+        return true;
+    });
+    if (!complete) return false;
+    out.sha256 = knownSha256.empty() ? sha256.hexDigest() : knownSha256;
+    out.md5 = md5.hexDigest();
+    out.similarityDigest = similarity.hexDigest();
+    out.entropy = ByteHistogram::entropy(out.histogram, size);
+    out.strings = strings.finish();
+
+    // First string containing each keyword, case-insensitively: one
+    // automaton pass per string instead of keyword x string searches
+    const PatternMatcher &keywords = suspiciousKeywords();
+    std::vector<size_t> firstString(keywords.patternCount(), kNoString);
+    size_t unmatched = firstString.size();
+    for (size_t i = 0; i < out.strings.size() && unmatched; ++i) {
+        const std::string &s = out.strings[i];
+        keywords.scan(reinterpret_cast<const uint8_t *>(s.data()), s.size(),
+                      [&](const PatternMatcher::Hit &hit) {
+                          if (firstString[hit.pattern] == kNoString) {
+                              firstString[hit.pattern] = i;
+                              --unmatched;
+                          }
+                          return true;
+                      });
+    }
+    for (size_t k = 0; k < firstString.size(); ++k) {
+        if (firstString[k] != kNoString) {
+            out.suspiciousStrings.push_back(std::string(kSuspiciousKeywords[k]) + ": " + out.strings[firstString[k]]);
+        }
+    }
+
+    if (out.extension == ".exe" || out.extension == ".dll" || out.extension == ".sys") {
+        out.pe = parsePe(data, size);
+        out.hasDigitalSignature = out.pe.hasSecurityDirectory;
+    }
+    return true;
+}
+
+std::string FeatureExtractor::toJson(const FileFeatures &f) {
+    std::string out = "{";
+    appendKey(out, "file_path");
+    appendJsonString(out, f.path);
+    appendKey(out, "file_size");
+    out += std::to_string(f.size);
+    appendKey(out, "extension");
+    appendJsonString(out, f.extension);
+    appendKey(out, "sha256");
+    appendJsonString(out, f.sha256);
+    appendKey(out, "md5");
+    appendJsonString(out, f.md5);
+    appendKey(out, "similarity_digest");
+    appendJsonString(out, f.similarityDigest);
+    appendKey(out, "entropy");
+    out += formatDouble("%.4f", f.entropy);
+    appendKey(out, "is_executable");
+    out += f.isExecutable ? "true" : "false";
+    appendKey(out, "ctime");
+    out += formatDouble("%.6f", f.changeTime);
+    appendKey(out, "mtime");
+    out += formatDouble("%.6f", f.modifyTime);
+    appendKey(out, "file_header");
+    appendJsonString(out, f.fileHeader);
+    appendKey(out, "has_digital_signature");
+    out += f.hasDigitalSignature ? "true" : "false";
+
+    appendKey(out, "strings_count");
+    out += std::to_string(f.strings.size());
+    appendKey(out, "strings_sample");
+    out += '[';
+    for (size_t i = 0; i < f.strings.size() && i < 10; ++i) {
+        if (i) out += ", ";
+        appendJsonString(out, f.strings[i]);
+    }
+    out += ']';
+    appendKey(out, "suspicious_strings");
+    out += '[';
+    for (size_t i = 0; i < f.suspiciousStrings.size(); ++i) {
+        if (i) out += ", ";
+        appendJsonString(out, f.suspiciousStrings[i]);
+    }
+    out += ']';
+    appendKey(out, "suspicious_count");
+    out += std::to_string(f.suspiciousStrings.size());
+
+    // analyze_pe_file only reports .exe / .dll
+    if (f.pe.valid && (f.extension == ".exe" || f.extension == ".dll")) {
+        appendKey(out, "pe_sections");
+        out += std::to_string(f.pe.sections);
+        appendKey(out, "pe_timestamp");
+        out += std::to_string(f.pe.timestamp);
+        appendKey(out, "pe_characteristics");
+        out += std::to_string(f.pe.characteristics);
+        appendKey(out, "is_dll");
+        out += (f.pe.characteristics & 0x2000) ? "true" : "false";
+        appendKey(out, "is_system");
+        out += (f.pe.characteristics & 0x1000) ? "true" : "false";
+        appendKey(out, "is_gui");
+        out += (f.pe.characteristics & 0x2) ? "true" : "false";
+        appendKey(out, "imphash");
+        appendJsonString(out, f.pe.imphash);
+        appendKey(out, "pe_details");
+        out += f.pe.json;
+    }
+    out += '}';
+    return out;
+}
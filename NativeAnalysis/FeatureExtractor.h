@@ -0,0 +1,77 @@
+#ifndef FEATUREEXTRACTOR_H
+#define FEATUREEXTRACTOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class MappedFile;
+class PatternMatcher;
+
+// Summary of PeParser's PeImage that outlives the mapping
+struct PeInfo {
+    bool valid = false;
+    uint16_t sections = 0;
+    uint32_t timestamp = 0;
+    uint16_t characteristics = 0;
+    bool hasSecurityDirectory = false; // Authenticode blob present
+    size_t tlsCallbacks = 0;
+    uint64_t overlayPayload = 0;              // overlay bytes besides the certificate
+    std::vector<std::string> packedSections; // entropy above PeParser::kPackedEntropy
+    std::string json;                        // PeParser::toJson, the "pe_details" feature
+    std::string imphash;                     // PeParser::importHash
+};
+
+// Everything ExecutableMonitor/extract_features.py computes, except the
+// MIME / libmagic description, which stays with the caller.
+struct FileFeatures {
+    std::string path;
+    std::string extension; // lower-case, with the dot
+    uint64_t size = 0;
+    double changeTime = 0; // st_ctime
+    double modifyTime = 0;
+    std::string sha256;
+    std::string md5;
+    std::string similarityDigest; // SimilarityDigest hex, empty for tiny or uniform files
+    uint64_t histogram[256] = {};
+    double entropy = 0; // Shannon, bits per byte, rounded to 4 places
+    std::string fileHeader; // hex of the first 20 bytes
+    bool isExecutable = false;
+    bool hasDigitalSignature = false;
+    std::vector<std::string> strings;           // ASCII runs, then UTF-16LE runs; first 100
+    std::vector<std::string> suspiciousStrings; // "keyword: string"
+    PeInfo pe;
+    std::vector<uint32_t> contentPatternHits; // per pattern, saturating; only when extract() has a matcher
+};
+
+// Single streaming pass over a memory-mapped file: hashes, histogram and
+// string runs are all fed from the same cache-sized block before moving on,
+// and pages behind the cursor are released, so files of any size are read
+// in bounded memory.
+class FeatureExtractor {
+public:
+    static constexpr size_t kBlockSize = 64 * 1024;
+    static constexpr size_t kMaxStrings = 100;
+    static constexpr size_t kMinStringLength = 4;
+    static constexpr size_t kMaxStringLength = 64 * 1024; // longer runs keep their first 64 KiB
+    static constexpr size_t kHeaderBytes = 20;
+
+    static bool extract(const std::string &path, FileFeatures &out, std::string *error = nullptr);
+    // contentPatterns, if given (RuleSet::patterns()), is run over the same
+    // blocks and every hit of each pattern counted in contentPatternHits.
+    // Raising cancel stops the pass at the next block; false is then
+    // returned and out is incomplete. A caller that already hashed the file
+    // may pass the hex SHA-256 in out.sha256, and the pass skips it.
+    static bool extract(const MappedFile &file, const std::string &path, FileFeatures &out,
+                        const PatternMatcher *contentPatterns = nullptr,
+                        const std::atomic<bool> *cancel = nullptr);
+
+    static bool isExecutableName(const std::string &extension);
+    static PeInfo parsePe(const uint8_t *data, size_t size); // via PeParser
+    // Same keys as extract_file_features(); times are epoch seconds
+    static std::string toJson(const FileFeatures &features);
+};
+
+#endif // FEATUREEXTRACTOR_H
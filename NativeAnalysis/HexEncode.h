@@ -0,0 +1,19 @@
+#ifndef HEXENCODE_H
+#define HEXENCODE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Lower-case hex, as Python's hexdigest() / binascii.hexlify()
+inline std::string hexEncode(const uint8_t *data, size_t len) {
+    static const char digits[] = "0123456789abcdef";
+    std::string out(len * 2, '0');
+    for (size_t i = 0; i < len; ++i) {
+        out[2 * i] = digits[data[i] >> 4];
+        out[2 * i + 1] = digits[data[i] & 15];
+    }
+    return out;
+}
+
+#endif // HEXENCODE_H
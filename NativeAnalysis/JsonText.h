@@ -0,0 +1,44 @@
+#ifndef JSONTEXT_H
+#define JSONTEXT_H
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+// Minimal JSON writing for the toJson() helpers: enough for flat and
+// nested objects of strings, numbers and bools.
+
+inline void appendJsonString(std::string &out, std::string_view s, bool asciiOnly = false) {
+    out += '"';
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += char(c);
+        } else if (c < 0x20 || (asciiOnly && c >= 0x80)) {
+            // asciiOnly: raw bytes from a file, which need not be UTF-8,
+            // are written as the Latin-1 code point so the text stays valid
+            char esc[8];
+            snprintf(esc, sizeof(esc), "\\u%04x", c);
+            out += esc;
+        } else {
+            out += char(c);
+        }
+    }
+    out += '"';
+}
+
+// Writes `"key": `, with a separating comma unless an object just opened
+inline void appendKey(std::string &out, const char *key) {
+    if (!out.empty() && out.back() != '{') out += ", ";
+    out += '"';
+    out += key;
+    out += "\": ";
+}
+
+inline std::string formatDouble(const char *format, double v) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), format, v);
+    return buf;
+}
+
+#endif // JSONTEXT_H
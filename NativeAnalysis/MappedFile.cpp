@@ -0,0 +1,130 @@
+#include "MappedFile.h"
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+static double fileTimeToEpoch(const FILETIME &ft) {
+    const uint64_t ticks = (uint64_t(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+    return double(ticks) / 1e7 - 11644473600.0; // 100 ns ticks since 1601
+}
+
+bool MappedFile::open(const std::string &path, std::string *error, Access access) {
+    close();
+    const int wlen = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    std::wstring wpath(wlen > 0 ? wlen : 1, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wpath[0], wlen);
+
+    HANDLE file = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING,
+                              access == Random ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    fileHandle = file;
+
+    LARGE_INTEGER size;
+    FILETIME created, written;
+    GetFileSizeEx(file, &size);
+    GetFileTime(file, &created, nullptr, &written);
+    ctime = fileTimeToEpoch(created); // st_ctime is creation time on Windows
+    mtime = fileTimeToEpoch(written);
+    length = size_t(size.QuadPart);
+    if (length == 0) return true;
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        if (error) *error = "cannot map " + path;
+        close();
+        return false;
+    }
+    mappingHandle = mapping;
+    bytes = static_cast<const uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!bytes) {
+        if (error) *error = "cannot map " + path;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes) UnmapViewOfFile(bytes);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+    bytes = nullptr;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+    length = 0;
+}
+
+void MappedFile::release(size_t offset, size_t len) const {
+    // Unlocking pages that were never locked drops them from the working set
+    if (!bytes || offset >= length) return;
+    VirtualUnlock(const_cast<uint8_t *>(bytes) + offset, len < length - offset ? len : length - offset);
+}
+
+#else
+
+bool MappedFile::open(const std::string &path, std::string *error, Access access) {
+    close();
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (error) *error = path + ": " + strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        if (error) *error = path + ": " + strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    ctime = double(st.st_ctim.tv_sec) + st.st_ctim.tv_nsec / 1e9;
+    mtime = double(st.st_mtim.tv_sec) + st.st_mtim.tv_nsec / 1e9;
+    length = size_t(st.st_size);
+    if (length == 0) {
+        ::close(fd);
+        return true;
+    }
+
+    void *map = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if (map == MAP_FAILED) {
+        if (error) *error = path + ": " + strerror(errno);
+        length = 0;
+        return false;
+    }
+    madvise(map, length, access == Random ? MADV_RANDOM : MADV_SEQUENTIAL);
+    bytes = static_cast<const uint8_t *>(map);
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes) munmap(const_cast<uint8_t *>(bytes), length);
+    bytes = nullptr;
+    length = 0;
+}
+
+void MappedFile::release(size_t offset, size_t len) const {
+    if (!bytes) return;
+    const size_t page = size_t(sysconf(_SC_PAGESIZE));
+    const size_t start = offset / page * page;
+    const size_t end = offset + len < length ? offset + len : length;
+    if (end > start) madvise(const_cast<uint8_t *>(bytes) + start, end - start, MADV_DONTNEED);
+}
+
+#endif
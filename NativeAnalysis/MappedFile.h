@@ -0,0 +1,68 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory map of a whole file. Empty files map to a null range.
+class MappedFile {
+public:
+    // Read-ahead hint: Sequential for one pass over the file, Random for
+    // lookups that touch a few scattered pages
+    enum Access { Sequential, Random };
+
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &path, std::string *error = nullptr, Access access = Sequential);
+    void close();
+
+    const uint8_t *data() const { return bytes; }
+    size_t size() const { return length; }
+    double changeTime() const { return ctime; }   // seconds since epoch
+    double modifyTime() const { return mtime; }
+
+    // Hint that [offset, offset + len) is done with (drops page-cache pressure
+    // on multi-GB files); a no-op where unsupported.
+    void release(size_t offset, size_t len) const;
+
+    // Resident pages are released every kReleaseSpan bytes by forEachBlock
+    static const size_t kReleaseSpan = 8 * 1024 * 1024;
+
+    // Calls fn(block, len, offset) on consecutive blocks of at most blockSize
+    // bytes and releases pages behind the cursor as it goes, so resident
+    // memory stays bounded whatever the file size. Returns false if fn did,
+    // which stops the walk.
+    template <typename Fn>
+    bool forEachBlock(size_t blockSize, Fn fn) const;
+
+private:
+    const uint8_t *bytes = nullptr;
+    size_t length = 0;
+    double ctime = 0;
+    double mtime = 0;
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#endif
+};
+
+template <typename Fn>
+bool MappedFile::forEachBlock(size_t blockSize, Fn fn) const {
+    size_t released = 0;
+    for (size_t offset = 0; offset < length; offset += blockSize) {
+        const size_t len = std::min(blockSize, length - offset);
+        if (!fn(bytes + offset, len, offset)) return false;
+        if (offset + len - released >= kReleaseSpan) {
+            release(released, offset + len - released);
+            released = offset + len;
+        }
+    }
+    return true;
+}
+
+#endif // MAPPEDFILE_H
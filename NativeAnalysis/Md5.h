@@ -0,0 +1,25 @@
+#ifndef MD5_H
+#define MD5_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Incremental MD5 (RFC 1321). Only for identification, never for trust.
+class Md5 {
+public:
+    Md5();
+    void update(const uint8_t *data, size_t len);
+    void final(uint8_t digest[16]);
+    std::string hexDigest(); // finalizes
+
+private:
+    void compress(const uint8_t *block);
+
+    uint32_t state[4];
+    uint64_t totalBytes;
+    uint8_t buffer[64];
+    size_t buffered;
+};
+
+#endif // MD5_H
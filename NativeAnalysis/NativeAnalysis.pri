@@ -0,0 +1,34 @@
+# Compiles NativeAnalysis straight into a Qt target:
+#   include(../NativeAnalysis/NativeAnalysis.pri)
+CONFIG += c++17
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/Allowlist.cpp \
+    $$PWD/ByteHistogram.cpp \
+    $$PWD/FeatureExtractor.cpp \
+    $$PWD/MappedFile.cpp \
+    $$PWD/Md5.cpp \
+    $$PWD/PatternMatcher.cpp \
+    $$PWD/PeParser.cpp \
+    $$PWD/RuleSet.cpp \
+    $$PWD/Sha256.cpp \
+    $$PWD/SimilarityDigest.cpp \
+    $$PWD/SimilarityIndex.cpp \
+    $$PWD/VerdictCache.cpp
+
+HEADERS += \
+    $$PWD/Allowlist.h \
+    $$PWD/ByteHistogram.h \
+    $$PWD/FeatureExtractor.h \
+    $$PWD/HexEncode.h \
+    $$PWD/JsonText.h \
+    $$PWD/MappedFile.h \
+    $$PWD/Md5.h \
+    $$PWD/PatternMatcher.h \
+    $$PWD/PeParser.h \
+    $$PWD/RuleSet.h \
+    $$PWD/Sha256.h \
+    $$PWD/SimilarityDigest.h \
+    $$PWD/SimilarityIndex.h \
+    $$PWD/VerdictCache.h
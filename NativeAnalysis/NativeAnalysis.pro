@@ -0,0 +1,11 @@
+# Shared library with a C ABI (secureguard_native.h), loaded from Python
+# by ExecutableMonitor/native_features.py. Plain C++17, no Qt.
+TEMPLATE = lib
+CONFIG -= qt
+CONFIG += shared c++17 hide_symbols
+TARGET = secureguard_native
+
+include(NativeAnalysis.pri)
+
+SOURCES += secureguard_native.cpp
+HEADERS += secureguard_native.h
@@ -0,0 +1,174 @@
+#include "PatternMatcher.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+
+namespace {
+
+inline uint8_t foldCase(uint8_t b) {
+    return (b >= 'A' && b <= 'Z') ? uint8_t(b + ('a' - 'A')) : b;
+}
+
+} // namespace
+
+PatternMatcher::PatternMatcher(const std::vector<std::string> &source, Syntax syntax)
+    : maxLength(0), valid(true), classCount(1)
+{
+    memset(byteClass, 0, sizeof(byteClass));
+
+    // Tokenize, and find each pattern's atom: its trailing literal run
+    std::vector<std::vector<uint8_t>> atoms;
+    for (const std::string &text : source) {
+        Pattern pattern;
+        for (size_t i = 0; i < text.size(); ++i) {
+            uint8_t b = uint8_t(text[i]);
+            bool wildcard = false;
+            if (syntax == Regex) {
+                if (b == '\\' && i + 1 < text.size()) b = uint8_t(text[++i]);
+                else if (b == '.') wildcard = true;
+            }
+            pattern.tokens.push_back({foldCase(b), wildcard});
+        }
+        if (pattern.tokens.empty() || pattern.tokens.back().wildcard) {
+            valid = false;
+            error = "unsupported pattern: \"" + text + "\"";
+        }
+        std::vector<uint8_t> atom;
+        for (auto it = pattern.tokens.rbegin(); it != pattern.tokens.rend() && !it->wildcard; ++it) {
+            atom.insert(atom.begin(), it->byte);
+        }
+        maxLength = std::max(maxLength, pattern.tokens.size());
+        atoms.push_back(atom);
+        patterns.push_back(pattern);
+    }
+
+    for (const auto &atom : atoms) {
+        for (uint8_t b : atom) {
+            if (byteClass[b]) continue;
+            byteClass[b] = uint8_t(classCount);
+            if (b >= 'a' && b <= 'z') byteClass[b - ('a' - 'A')] = uint8_t(classCount);
+            ++classCount;
+        }
+    }
+
+    // Trie over the atoms; -1 marks a missing edge until the BFS below
+    next.assign(size_t(classCount), -1);
+    outputs.emplace_back();
+    for (uint32_t p = 0; p < atoms.size(); ++p) {
+        int32_t s = 0;
+        for (uint8_t b : atoms[p]) {
+            const size_t edge = size_t(s) * classCount + byteClass[b];
+            if (next[edge] < 0) {
+                next[edge] = int32_t(outputs.size());
+                outputs.emplace_back();
+                next.resize(next.size() + size_t(classCount), -1);
+            }
+            s = next[edge];
+        }
+        if (!atoms[p].empty()) outputs[size_t(s)].push_back(p);
+    }
+
+    // BFS: failure links turned straight into DFA edges
+    const size_t stateCount = outputs.size();
+    std::vector<int32_t> fail(stateCount, 0);
+    hasOutput.assign(stateCount, 0);
+    outputLink.assign(stateCount, -1);
+    std::deque<int32_t> queue;
+    for (int c = 0; c < classCount; ++c) {
+        int32_t &edge = next[size_t(c)];
+        if (edge < 0) {
+            edge = 0;
+        } else {
+            fail[size_t(edge)] = 0;
+            queue.push_back(edge);
+        }
+    }
+    hasOutput[0] = 0;
+    while (!queue.empty()) {
+        const int32_t s = queue.front();
+        queue.pop_front();
+        const int32_t f = fail[size_t(s)];
+        outputLink[size_t(s)] = !outputs[size_t(f)].empty() ? f : outputLink[size_t(f)];
+        hasOutput[size_t(s)] = !outputs[size_t(s)].empty() || outputLink[size_t(s)] >= 0;
+        for (int c = 0; c < classCount; ++c) {
+            int32_t &edge = next[size_t(s) * classCount + c];
+            const int32_t viaFail = next[size_t(f) * classCount + c];
+            if (edge < 0) {
+                edge = viaFail;
+            } else {
+                fail[size_t(edge)] = viaFail;
+                queue.push_back(edge);
+            }
+        }
+    }
+}
+
+bool PatternMatcher::verify(const Pattern &pattern, uint64_t start, const Stream &stream, uint64_t chunkStart,
+                            const uint8_t *data) const {
+    const uint64_t historyStart = chunkStart - stream.history.size();
+    if (start < historyStart) return false; // before the input began
+    for (size_t i = 0; i < pattern.tokens.size(); ++i) {
+        const uint64_t at = start + i;
+        const uint8_t b = at >= chunkStart ? data[at - chunkStart] : uint8_t(stream.history[size_t(at - historyStart)]);
+        const Token &t = pattern.tokens[i];
+        if (t.wildcard ? b == '\n' : foldCase(b) != t.byte) return false;
+    }
+    return true;
+}
+
+bool PatternMatcher::scan(Stream &stream, const uint8_t *data, size_t len, const HitCallback &onHit) const {
+    const uint64_t chunkStart = stream.position;
+    int32_t s = stream.state;
+    const int32_t *table = next.data();
+    const int cc = classCount;
+    bool keepGoing = true;
+
+    for (size_t i = 0; i < len && keepGoing; ++i) {
+        s = table[size_t(s) * cc + byteClass[data[i]]];
+        if (!hasOutput[size_t(s)]) continue;
+        const uint64_t end = chunkStart + i + 1; // one past the hit
+        for (int32_t o = s; o >= 0 && keepGoing; o = outputLink[size_t(o)]) {
+            for (uint32_t p : outputs[size_t(o)]) {
+                const Pattern &pattern = patterns[p];
+                if (end < pattern.tokens.size()) continue;
+                const uint64_t start = end - pattern.tokens.size();
+                // Literal-only patterns were fully matched by the DFA
+                if (pattern.tokens.size() > 1 && !verify(pattern, start, stream, chunkStart, data)) continue;
+                if (!onHit({p, start})) {
+                    keepGoing = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Keep enough trailing bytes to verify a match ending in the next chunk
+    const size_t keep = maxLength > 0 ? maxLength - 1 : 0;
+    if (len >= keep) {
+        stream.history.assign(reinterpret_cast<const char *>(data + len - keep), keep);
+    } else {
+        stream.history.append(reinterpret_cast<const char *>(data), len);
+        if (stream.history.size() > keep) stream.history.erase(0, stream.history.size() - keep);
+    }
+    stream.state = s;
+    stream.position += len;
+    return keepGoing;
+}
+
+bool PatternMatcher::scan(const uint8_t *data, size_t len, const HitCallback &onHit) const {
+    Stream stream;
+    return scan(stream, data, len, onHit);
+}
+
+std::vector<PatternMatcher::Hit> PatternMatcher::findAll(const uint8_t *data, size_t len) const {
+    std::vector<Hit> hits;
+    scan(data, len, [&hits](const Hit &hit) {
+        hits.push_back(hit);
+        return true;
+    });
+    return hits;
+}
+
+bool PatternMatcher::containsAny(const uint8_t *data, size_t len) const {
+    return !scan(data, len, [](const Hit &) { return false; });
+}
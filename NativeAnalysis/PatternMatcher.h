@@ -0,0 +1,78 @@
+#ifndef PATTERNMATCHER_H
+#define PATTERNMATCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Case-insensitive (ASCII) multi-pattern matcher: one Aho-Corasick DFA over
+// all patterns, so a buffer is scanned once however many patterns there
+// are. Patterns are either plain literals or the regex subset used by
+// predict.py, where '\' escapes the next byte and an unescaped '.' matches
+// any byte but '\n'. The DFA is built over each pattern's trailing literal
+// run; the rest of the pattern, wildcards included, is checked by looking
+// back from the hit.
+class PatternMatcher {
+public:
+    enum Syntax { Literal, Regex };
+
+    struct Hit {
+        uint32_t pattern; // index into the constructor's list
+        uint64_t offset;  // where the match starts
+    };
+
+    // Scan state carried between chunks of one input
+    struct Stream {
+        int32_t state = 0;
+        uint64_t position = 0;
+        std::string history; // last (longest pattern - 1) bytes seen
+    };
+
+    // Return false to stop scanning
+    using HitCallback = std::function<bool(const Hit &)>;
+
+    PatternMatcher(const std::vector<std::string> &patterns, Syntax syntax);
+
+    // False if a pattern is empty or ends in a wildcard
+    bool isValid() const { return valid; }
+    const std::string &errorString() const { return error; }
+    size_t patternCount() const { return patterns.size(); }
+    size_t maxPatternLength() const { return maxLength; }
+
+    // Returns false if the callback stopped the scan
+    bool scan(Stream &stream, const uint8_t *data, size_t len, const HitCallback &onHit) const;
+    bool scan(const uint8_t *data, size_t len, const HitCallback &onHit) const;
+
+    std::vector<Hit> findAll(const uint8_t *data, size_t len) const;
+    bool containsAny(const uint8_t *data, size_t len) const;
+
+private:
+    struct Token {
+        uint8_t byte; // lower-cased
+        bool wildcard;
+    };
+    struct Pattern {
+        std::vector<Token> tokens;
+    };
+
+    bool verify(const Pattern &pattern, uint64_t start, const Stream &stream, uint64_t chunkStart,
+                const uint8_t *data) const;
+
+    std::vector<Pattern> patterns;
+    size_t maxLength;
+    bool valid;
+    std::string error;
+
+    // DFA over byte classes: every byte that occurs in an atom (case-folded)
+    // gets its own class, all others share class 0
+    uint8_t byteClass[256];
+    int classCount;
+    std::vector<int32_t> next;                      // state * classCount + class
+    std::vector<std::vector<uint32_t>> outputs;     // patterns whose atom ends in state
+    std::vector<uint8_t> hasOutput;                 // outputs, including via suffix links
+    std::vector<int32_t> outputLink;                // nearest proper suffix state with outputs
+};
+
+#endif // PATTERNMATCHER_H
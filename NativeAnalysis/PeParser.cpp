@@ -0,0 +1,556 @@
+#include "PeParser.h"
+#include "ByteHistogram.h"
+#include "JsonText.h"
+#include "Md5.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+const uint32_t kPeSignature = 0x00004550;   // "PE\0\0"
+const uint32_t kRichSignature = 0x68636952; // "Rich"
+const uint32_t kDansSignature = 0x536e6144; // "DanS"
+const uint16_t kMagicPe32 = 0x10b;
+const uint16_t kMagicPe32Plus = 0x20b;
+
+enum Directory { ExportDir = 0, ImportDir = 1, ResourceDir = 2, SecurityDir = 4, TlsDir = 9 };
+
+inline uint16_t le16(const uint8_t *p) { return uint16_t(p[0] | (p[1] << 8)); }
+inline uint32_t le32(const uint8_t *p) {
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+inline uint64_t le64(const uint8_t *p) { return uint64_t(le32(p)) | (uint64_t(le32(p + 4)) << 32); }
+
+struct DataDirectory {
+    uint32_t rva = 0;
+    uint32_t size = 0;
+};
+
+// Bounds-checked access to the image, by file offset or by RVA
+class Reader {
+public:
+    Reader(const uint8_t *data, size_t size) : data(data), size(size) {}
+
+    // Pointer to len bytes at a file offset, or nullptr if they are not all in the file
+    const uint8_t *at(uint64_t offset, uint64_t len) const {
+        return offset <= size && len <= size - offset ? data + offset : nullptr;
+    }
+
+    const uint8_t *atRva(uint64_t rva, uint64_t len) const {
+        uint64_t offset;
+        return offsetOf(rva, offset) ? at(offset, len) : nullptr;
+    }
+
+    bool offsetOf(uint64_t rva, uint64_t &offset) const {
+        if (rva > UINT32_MAX) return false;
+        // Headers are mapped at their file offsets
+        if (rva < headerSize) {
+            offset = rva;
+            return true;
+        }
+        for (const PeImage::Section &s : *sections) {
+            const uint64_t span = std::max(s.virtualSize, s.rawSize);
+            if (rva >= s.virtualAddress && rva < uint64_t(s.virtualAddress) + span) {
+                if (rva - s.virtualAddress >= s.rawSize) return false; // zero-filled, not in the file
+                offset = alignedRaw(s.rawOffset) + (rva - s.virtualAddress);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // NUL-terminated string at an RVA, as a view into the image
+    std::string_view stringAtRva(uint64_t rva) const {
+        uint64_t offset;
+        if (!offsetOf(rva, offset) || offset >= size) return {};
+        const size_t limit = std::min<uint64_t>(size - offset, PeParser::kMaxNameLength);
+        const char *start = reinterpret_cast<const char *>(data + offset);
+        const void *nul = memchr(start, 0, limit);
+        return std::string_view(start, nul ? size_t(static_cast<const char *>(nul) - start) : limit);
+    }
+
+    // The loader rounds PointerToRawData down to 512 bytes
+    uint64_t alignedRaw(uint32_t rawOffset) const {
+        return fileAlignment >= 0x200 ? rawOffset & ~uint32_t(0x1ff) : rawOffset;
+    }
+
+    const uint8_t *data;
+    size_t size;
+    uint32_t headerSize = 0;
+    uint32_t fileAlignment = 0;
+    const std::vector<PeImage::Section> *sections = nullptr;
+};
+
+void parseRich(const Reader &r, uint32_t peOffset, PeImage &out) {
+    // Between the DOS stub and the PE header: "DanS" ^ key, three padding
+    // dwords, (comp.id, count) pairs, then "Rich" and the key in clear
+    const uint32_t limit = std::min<uint64_t>(peOffset, r.size);
+    for (uint32_t pos = 0x80; pos + 8 <= limit; pos += 4) {
+        if (le32(r.data + pos) != kRichSignature) continue;
+        const uint32_t key = le32(r.data + pos + 4);
+        for (uint32_t start = pos; start >= 0x80 + 4;) {
+            start -= 4;
+            if ((le32(r.data + start) ^ key) != kDansSignature) continue;
+            for (uint32_t e = start + 16; e + 8 <= pos; e += 8) {
+                PeImage::RichEntry entry;
+                const uint32_t compId = le32(r.data + e) ^ key;
+                entry.productId = uint16_t(compId >> 16);
+                entry.build = uint16_t(compId);
+                entry.count = le32(r.data + e + 4) ^ key;
+                out.rich.push_back(entry);
+            }
+            out.richKey = key;
+            return;
+        }
+        return;
+    }
+}
+
+void parseSections(const Reader &r, uint64_t tableOffset, PeImage &out) {
+    const size_t count = std::min<size_t>(out.sectionCount, PeParser::kMaxSections);
+    if (count < out.sectionCount) out.truncated = true;
+    uint64_t lastRawEnd = 0;
+    // Sections may overlap; entropy reads at most twice the file in total
+    uint64_t entropyBudget = 2 * uint64_t(r.size);
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t *h = r.at(tableOffset + 40 * i, 40);
+        if (!h) {
+            out.truncated = true;
+            break;
+        }
+        PeImage::Section s;
+        const char *name = reinterpret_cast<const char *>(h);
+        s.name = std::string_view(name, strnlen(name, 8));
+        s.virtualSize = le32(h + 8);
+        s.virtualAddress = le32(h + 12);
+        s.rawSize = le32(h + 16);
+        s.rawOffset = le32(h + 20);
+        s.characteristics = le32(h + 36);
+
+        const uint64_t raw = r.alignedRaw(s.rawOffset);
+        s.rawSize = raw >= r.size ? 0 : uint32_t(std::min<uint64_t>(s.rawSize, r.size - raw));
+        if (s.rawSize) {
+            if (s.rawSize <= entropyBudget) {
+                s.entropy = ByteHistogram::entropy(r.data + raw, s.rawSize);
+                entropyBudget -= s.rawSize;
+            } else {
+                out.truncated = true;
+            }
+            lastRawEnd = std::max(lastRawEnd, raw + s.rawSize);
+        }
+        out.sections.push_back(s);
+    }
+    if (lastRawEnd && lastRawEnd < r.size) {
+        out.overlayOffset = lastRawEnd;
+        out.overlaySize = r.size - lastRawEnd;
+    }
+}
+
+void parseImports(const Reader &r, const DataDirectory &dir, PeImage &out) {
+    const unsigned thunkSize = out.pe32Plus ? 8 : 4;
+    const uint64_t ordinalFlag = out.pe32Plus ? (uint64_t(1) << 63) : 0x80000000u;
+    for (uint64_t d = dir.rva;; d += 20) {
+        const uint8_t *desc = r.atRva(d, 20);
+        if (!desc) {
+            out.truncated = true;
+            return;
+        }
+        static const uint8_t zero[20] = {};
+        if (memcmp(desc, zero, sizeof(zero)) == 0) return; // terminator
+        if (out.imports.size() >= PeParser::kMaxImportModules) {
+            out.truncated = true;
+            return;
+        }
+
+        PeImage::ImportModule module;
+        module.dll = r.stringAtRva(le32(desc + 12));
+        // Prefer the lookup table; bound images may have overwritten the IAT
+        const uint32_t thunks = le32(desc) ? le32(desc) : le32(desc + 16);
+        for (uint64_t t = thunks;; t += thunkSize) {
+            const uint8_t *entry = r.atRva(t, thunkSize);
+            if (!entry) {
+                out.truncated = true;
+                break;
+            }
+            const uint64_t value = thunkSize == 8 ? le64(entry) : le32(entry);
+            if (value == 0) break;
+            if (out.importCount >= PeParser::kMaxImports) {
+                out.truncated = true;
+                break;
+            }
+            PeImage::Import function;
+            if (value & ordinalFlag) {
+                function.ordinal = uint16_t(value);
+            } else {
+                const uint8_t *hint = r.atRva(uint32_t(value & 0x7fffffff), 2);
+                if (hint) {
+                    function.ordinal = le16(hint);
+                    function.name = r.stringAtRva(uint32_t(value & 0x7fffffff) + 2);
+                }
+            }
+            module.functions.push_back(function);
+            ++out.importCount;
+        }
+        out.imports.push_back(std::move(module));
+    }
+}
+
+void parseExports(const Reader &r, const DataDirectory &dir, PeImage &out) {
+    const uint8_t *ed = r.atRva(dir.rva, 40);
+    if (!ed) {
+        out.truncated = true;
+        return;
+    }
+    out.exportName = r.stringAtRva(le32(ed + 12));
+    const uint32_t base = le32(ed + 16);
+    out.exportCount = le32(ed + 20);
+    const uint32_t nameCount = le32(ed + 24);
+    const uint32_t functions = le32(ed + 28);
+    const uint32_t names = le32(ed + 32);
+    const uint32_t ordinals = le32(ed + 36);
+
+    const size_t count = std::min<size_t>(nameCount, PeParser::kMaxExports);
+    if (count < nameCount) out.truncated = true;
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t *nameRva = r.atRva(uint64_t(names) + 4 * i, 4);
+        const uint8_t *ordinal = r.atRva(uint64_t(ordinals) + 2 * i, 2);
+        if (!nameRva || !ordinal) {
+            out.truncated = true;
+            return;
+        }
+        PeImage::Export e;
+        e.name = r.stringAtRva(le32(nameRva));
+        const uint16_t index = le16(ordinal);
+        e.ordinal = base + index;
+        if (index < out.exportCount) {
+            if (const uint8_t *address = r.atRva(uint64_t(functions) + 4 * index, 4)) e.rva = le32(address);
+        }
+        e.forwarded = e.rva >= dir.rva && e.rva < uint64_t(dir.rva) + dir.size;
+        out.exports.push_back(e);
+    }
+}
+
+// Type / name / language directory tree. Entries point anywhere in the
+// section, so loops are possible; the visit budget ends them.
+void parseResourceTable(const Reader &r, const DataDirectory &dir, uint32_t tableOffset, int level,
+                        uint32_t keys[3], size_t &budget, PeImage &out) {
+    const uint8_t *table = r.atRva(uint64_t(dir.rva) + tableOffset, 16);
+    if (!table) {
+        out.truncated = true;
+        return;
+    }
+    const uint32_t entries = uint32_t(le16(table + 12)) + le16(table + 14);
+    for (uint32_t i = 0; i < entries; ++i) {
+        if (budget == 0) {
+            out.truncated = true;
+            return;
+        }
+        --budget;
+        const uint8_t *entry = r.atRva(uint64_t(dir.rva) + tableOffset + 16 + 8 * uint64_t(i), 8);
+        if (!entry) {
+            out.truncated = true;
+            return;
+        }
+        const uint32_t nameField = le32(entry);
+        const uint32_t target = le32(entry + 4);
+        keys[level] = (nameField & 0x80000000u) ? 0 : (nameField & 0xffff);
+
+        if (target & 0x80000000u) {
+            if (level < 2) parseResourceTable(r, dir, target & 0x7fffffff, level + 1, keys, budget, out);
+            continue; // deeper than type / name / language is malformed
+        }
+        const uint8_t *data = r.atRva(uint64_t(dir.rva) + target, 16);
+        if (!data) {
+            out.truncated = true;
+            continue;
+        }
+        PeImage::Resource res;
+        res.type = keys[0];
+        res.id = level >= 1 ? keys[1] : 0;
+        res.language = level >= 2 ? keys[2] : 0;
+        res.rva = le32(data);
+        res.size = le32(data + 4);
+        out.resources.push_back(res);
+    }
+}
+
+void parseTls(const Reader &r, const DataDirectory &dir, PeImage &out) {
+    const unsigned pointerSize = out.pe32Plus ? 8 : 4;
+    const uint8_t *tls = r.atRva(dir.rva, out.pe32Plus ? 40 : 24);
+    if (!tls) {
+        out.truncated = true;
+        return;
+    }
+    const uint64_t callbacks = out.pe32Plus ? le64(tls + 24) : le32(tls + 12);
+    if (callbacks == 0 || callbacks < out.imageBase) return;
+    const uint64_t rva = callbacks - out.imageBase;
+    for (size_t i = 0;; ++i) {
+        const uint8_t *p = r.atRva(rva + pointerSize * i, pointerSize);
+        if (!p) {
+            out.truncated = true;
+            return;
+        }
+        const uint64_t va = pointerSize == 8 ? le64(p) : le32(p);
+        if (va == 0) return;
+        if (i >= PeParser::kMaxTlsCallbacks) {
+            out.truncated = true;
+            return;
+        }
+        out.tlsCallbacks.push_back(va);
+    }
+}
+
+} // namespace
+
+bool PeParser::parse(const uint8_t *data, size_t size, PeImage &out) {
+    out = PeImage();
+    Reader r(data, size);
+    if (!r.at(0, 0x40) || data[0] != 'M' || data[1] != 'Z') return false;
+    const uint32_t peOffset = le32(data + 0x3c);
+    const uint8_t *signature = r.at(peOffset, 24);
+    if (!signature || le32(signature) != kPeSignature) return false;
+
+    const uint8_t *coff = signature + 4;
+    out.valid = true;
+    out.machine = le16(coff);
+    out.sectionCount = le16(coff + 2);
+    out.timestamp = le32(coff + 4);
+    out.characteristics = le16(coff + 18);
+    parseRich(r, peOffset, out);
+
+    const uint16_t optionalSize = le16(coff + 16);
+    const uint64_t optionalOffset = uint64_t(peOffset) + 24;
+    const uint8_t *optional = r.at(optionalOffset, optionalSize);
+    DataDirectory dirs[16];
+    if (optional && optionalSize >= 2) {
+        const uint16_t magic = le16(optional);
+        out.pe32Plus = magic == kMagicPe32Plus;
+        const size_t countAt = out.pe32Plus ? 108 : 92;
+        if ((magic == kMagicPe32 || magic == kMagicPe32Plus) && optionalSize >= countAt + 4) {
+            out.entryPoint = le32(optional + 16);
+            out.imageBase = out.pe32Plus ? le64(optional + 24) : le32(optional + 28);
+            r.fileAlignment = le32(optional + 36);
+            out.sizeOfImage = le32(optional + 56);
+            out.sizeOfHeaders = le32(optional + 60);
+            out.checksum = le32(optional + 64);
+            out.subsystem = le16(optional + 68);
+            out.dllCharacteristics = le16(optional + 70);
+            out.directoryCount = le32(optional + countAt);
+            const size_t usable = std::min<size_t>({out.directoryCount, 16, (optionalSize - countAt - 4) / 8});
+            for (size_t i = 0; i < usable; ++i) {
+                dirs[i].rva = le32(optional + countAt + 4 + 8 * i);
+                dirs[i].size = le32(optional + countAt + 8 + 8 * i);
+            }
+        }
+    } else if (optionalSize) {
+        out.truncated = true;
+    }
+
+    // Sections first: every RVA below is resolved through them
+    r.headerSize = out.sizeOfHeaders;
+    r.sections = &out.sections;
+    parseSections(r, optionalOffset + optionalSize, out);
+
+    if (dirs[ImportDir].rva) parseImports(r, dirs[ImportDir], out);
+    if (dirs[ExportDir].rva && dirs[ExportDir].size) parseExports(r, dirs[ExportDir], out);
+    if (dirs[ResourceDir].rva && dirs[ResourceDir].size) {
+        uint32_t keys[3] = {};
+        size_t budget = kMaxResourceEntries;
+        parseResourceTable(r, dirs[ResourceDir], 0, 0, keys, budget, out);
+    }
+    if (dirs[TlsDir].rva) parseTls(r, dirs[TlsDir], out);
+    if (dirs[SecurityDir].rva && dirs[SecurityDir].size) {
+        out.certificateOffset = dirs[SecurityDir].rva;
+        out.certificateSize = dirs[SecurityDir].size;
+    }
+    return true;
+}
+
+uint64_t PeParser::overlayPayload(const PeImage &image) {
+    if (!image.overlaySize) return 0;
+    const uint64_t end = image.overlayOffset + image.overlaySize;
+    const uint64_t certStart = image.certificateOffset;
+    const uint64_t certEnd = certStart + image.certificateSize;
+    // The certificate table is appended after the sections when signing
+    if (!image.certificateSize || certStart < image.overlayOffset || certStart >= end) return image.overlaySize;
+    return image.overlaySize - (std::min(certEnd, end) - certStart);
+}
+
+std::string PeParser::importHash(const PeImage &image) {
+    if (!image.importCount) return std::string();
+    std::string text;
+    for (const PeImage::ImportModule &m : image.imports) {
+        std::string dll(m.dll);
+        std::transform(dll.begin(), dll.end(), dll.begin(), [](unsigned char c) { return char(tolower(c)); });
+        const size_t dot = dll.rfind('.');
+        if (dot != std::string::npos) {
+            const std::string ext = dll.substr(dot + 1);
+            if (ext == "dll" || ext == "ocx" || ext == "sys") dll.resize(dot);
+        }
+        for (const PeImage::Import &f : m.functions) {
+            if (!text.empty()) text += ',';
+            text += dll;
+            text += '.';
+            if (f.name.empty()) {
+                text += "ord" + std::to_string(f.ordinal);
+            } else {
+                for (char c : f.name) text += char(tolower(static_cast<unsigned char>(c)));
+            }
+        }
+    }
+    Md5 md5;
+    md5.update(reinterpret_cast<const uint8_t *>(text.data()), text.size());
+    return md5.hexDigest();
+}
+
+const char *PeParser::resourceTypeName(uint32_t type) {
+    switch (type) {
+    case 1: return "CURSOR";
+    case 2: return "BITMAP";
+    case 3: return "ICON";
+    case 4: return "MENU";
+    case 5: return "DIALOG";
+    case 6: return "STRING";
+    case 7: return "FONTDIR";
+    case 8: return "FONT";
+    case 9: return "ACCELERATOR";
+    case 10: return "RCDATA";
+    case 11: return "MESSAGETABLE";
+    case 12: return "GROUP_CURSOR";
+    case 14: return "GROUP_ICON";
+    case 16: return "VERSION";
+    case 17: return "DLGINCLUDE";
+    case 19: return "PLUGPLAY";
+    case 20: return "VXD";
+    case 21: return "ANICURSOR";
+    case 22: return "ANIICON";
+    case 23: return "HTML";
+    case 24: return "MANIFEST";
+    default: return nullptr;
+    }
+}
+
+std::string PeParser::toJson(const PeImage &pe) {
+    std::string out = "{";
+    appendKey(out, "machine");
+    out += std::to_string(pe.machine);
+    appendKey(out, "pe32_plus");
+    out += pe.pe32Plus ? "true" : "false";
+    appendKey(out, "entry_point");
+    out += std::to_string(pe.entryPoint);
+    appendKey(out, "image_base");
+    out += std::to_string(pe.imageBase);
+    appendKey(out, "subsystem");
+    out += std::to_string(pe.subsystem);
+    appendKey(out, "dll_characteristics");
+    out += std::to_string(pe.dllCharacteristics);
+    appendKey(out, "size_of_image");
+    out += std::to_string(pe.sizeOfImage);
+    appendKey(out, "checksum");
+    out += std::to_string(pe.checksum);
+
+    appendKey(out, "sections");
+    out += '[';
+    for (size_t i = 0; i < pe.sections.size() && i < kJsonListLimit; ++i) {
+        const PeImage::Section &s = pe.sections[i];
+        out += i ? ", {" : "{";
+        appendKey(out, "name");
+        appendJsonString(out, s.name, true);
+        appendKey(out, "virtual_address");
+        out += std::to_string(s.virtualAddress);
+        appendKey(out, "virtual_size");
+        out += std::to_string(s.virtualSize);
+        appendKey(out, "raw_size");
+        out += std::to_string(s.rawSize);
+        appendKey(out, "characteristics");
+        out += std::to_string(s.characteristics);
+        appendKey(out, "entropy");
+        out += formatDouble("%.4f", s.entropy);
+        out += '}';
+    }
+    out += ']';
+
+    // "dll!function", or "dll!#ordinal" for imports by ordinal
+    appendKey(out, "import_count");
+    out += std::to_string(pe.importCount);
+    appendKey(out, "imports");
+    out += '[';
+    size_t listed = 0;
+    for (const PeImage::ImportModule &m : pe.imports) {
+        for (const PeImage::Import &f : m.functions) {
+            if (listed == kJsonListLimit) break;
+            if (listed++) out += ", ";
+            std::string name(m.dll);
+            name += '!';
+            name += f.name.empty() ? "#" + std::to_string(f.ordinal) : std::string(f.name);
+            appendJsonString(out, name, true);
+        }
+    }
+    out += ']';
+
+    appendKey(out, "export_name");
+    appendJsonString(out, pe.exportName, true);
+    appendKey(out, "export_count");
+    out += std::to_string(pe.exportCount);
+    appendKey(out, "exports");
+    out += '[';
+    for (size_t i = 0; i < pe.exports.size() && i < kJsonListLimit; ++i) {
+        if (i) out += ", ";
+        appendJsonString(out, pe.exports[i].name, true);
+    }
+    out += ']';
+
+    // Resources summarised per type; icon-heavy files have thousands
+    appendKey(out, "resource_count");
+    out += std::to_string(pe.resources.size());
+    appendKey(out, "resource_types");
+    out += '{';
+    std::vector<std::pair<uint32_t, size_t>> types;
+    for (const PeImage::Resource &res : pe.resources) {
+        auto it = std::find_if(types.begin(), types.end(), [&](const auto &t) { return t.first == res.type; });
+        if (it == types.end()) types.push_back({res.type, 1});
+        else ++it->second;
+    }
+    for (const auto &t : types) {
+        const char *name = resourceTypeName(t.first);
+        appendKey(out, name ? name : std::to_string(t.first).c_str());
+        out += std::to_string(t.second);
+    }
+    out += '}';
+
+    appendKey(out, "tls_callbacks");
+    out += '[';
+    for (size_t i = 0; i < pe.tlsCallbacks.size(); ++i) {
+        if (i) out += ", ";
+        out += std::to_string(pe.tlsCallbacks[i]);
+    }
+    out += ']';
+    appendKey(out, "overlay_offset");
+    out += std::to_string(pe.overlayOffset);
+    appendKey(out, "overlay_size");
+    out += std::to_string(pe.overlaySize);
+    appendKey(out, "overlay_payload_size");
+    out += std::to_string(overlayPayload(pe));
+    appendKey(out, "certificate_size");
+    out += std::to_string(pe.certificateSize);
+
+    appendKey(out, "rich");
+    out += '[';
+    for (size_t i = 0; i < pe.rich.size() && i < kJsonListLimit; ++i) {
+        const PeImage::RichEntry &e = pe.rich[i];
+        out += i ? ", {" : "{";
+        appendKey(out, "product");
+        out += std::to_string(e.productId);
+        appendKey(out, "build");
+        out += std::to_string(e.build);
+        appendKey(out, "count");
+        out += std::to_string(e.count);
+        out += '}';
+    }
+    out += ']';
+    appendKey(out, "truncated");
+    out += pe.truncated ? "true" : "false";
+    out += '}';
+    return out;
+}
@@ -0,0 +1,112 @@
+#ifndef PEPARSER_H
+#define PEPARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// What PeParser reads from a PE32 / PE32+ image. Names are views into the
+// parsed buffer (normally a MappedFile), which must outlive the PeImage.
+struct PeImage {
+    struct Section {
+        std::string_view name; // up to 8 bytes, NUL padding dropped
+        uint32_t virtualAddress = 0;
+        uint32_t virtualSize = 0;
+        uint32_t rawOffset = 0;
+        uint32_t rawSize = 0; // clipped to the file
+        uint32_t characteristics = 0;
+        double entropy = 0;   // of the raw data, bits per byte
+    };
+    struct Import {
+        std::string_view name; // empty when imported by ordinal
+        uint16_t ordinal = 0;  // the hint, or the ordinal when name is empty
+    };
+    struct ImportModule {
+        std::string_view dll;
+        std::vector<Import> functions;
+    };
+    struct Export {
+        std::string_view name;
+        uint32_t ordinal = 0;
+        uint32_t rva = 0;
+        bool forwarded = false; // rva points at a "dll.function" string
+    };
+    struct Resource {
+        uint32_t type = 0; // RT_* id, 0 when named
+        uint32_t id = 0;   // 0 when named
+        uint32_t language = 0;
+        uint32_t rva = 0;
+        uint32_t size = 0;
+    };
+    struct RichEntry {
+        uint16_t productId = 0;
+        uint16_t build = 0;
+        uint32_t count = 0;
+    };
+
+    bool valid = false; // MZ and PE signatures and a COFF header present
+    bool pe32Plus = false;
+    uint16_t machine = 0;
+    uint32_t timestamp = 0;
+    uint16_t characteristics = 0;
+    uint16_t subsystem = 0;
+    uint16_t dllCharacteristics = 0;
+    uint32_t entryPoint = 0;
+    uint64_t imageBase = 0;
+    uint32_t sizeOfImage = 0;
+    uint32_t sizeOfHeaders = 0;
+    uint32_t checksum = 0;
+    uint16_t sectionCount = 0;     // as declared in the COFF header
+    uint32_t directoryCount = 0;   // NumberOfRvaAndSizes
+    std::vector<Section> sections; // those whose header lies in the file
+    std::vector<ImportModule> imports;
+    size_t importCount = 0; // functions over all modules
+    std::string_view exportName;
+    uint32_t exportCount = 0;    // NumberOfFunctions
+    std::vector<Export> exports; // named exports
+    std::vector<Resource> resources;
+    std::vector<uint64_t> tlsCallbacks; // virtual addresses
+    uint64_t overlayOffset = 0; // first byte after the last section's raw data
+    uint64_t overlaySize = 0;
+    uint32_t certificateOffset = 0; // Authenticode table; a file offset, not an RVA
+    uint32_t certificateSize = 0;
+    uint32_t richKey = 0; // XOR key of the Rich header, 0 if there is none
+    std::vector<RichEntry> rich;
+    bool truncated = false; // a table ran off the file or hit a limit below
+};
+
+// Bounds-checked PE parser working in place on a memory-mapped image: every
+// field is read straight from the mapping and nothing is copied. Hostile
+// input is expected; the limits below keep it cheap, and a table that
+// breaks them or points outside the file is cut short and flagged.
+class PeParser {
+public:
+    static constexpr size_t kMaxSections = 1024;
+    static constexpr size_t kMaxImportModules = 1024;
+    static constexpr size_t kMaxImports = 16384;
+    static constexpr size_t kMaxExports = 16384;
+    static constexpr size_t kMaxResourceEntries = 16384; // directory entries visited
+    static constexpr size_t kMaxTlsCallbacks = 64;
+    static constexpr size_t kMaxNameLength = 1024;
+    // Sections above this are reported as likely packed or encrypted
+    static constexpr double kPackedEntropy = 7.2;
+
+    // False if data is not a PE image; out is filled as far as it parses
+    static bool parse(const uint8_t *data, size_t size, PeImage &out);
+    // JSON object for the "pe_details" feature; long lists are cut at
+    // kJsonListLimit entries, the counts stay exact
+    static std::string toJson(const PeImage &image);
+    static constexpr size_t kJsonListLimit = 512;
+
+    static const char *resourceTypeName(uint32_t type); // "ICON", or nullptr
+    // pefile's imphash: MD5 of "dll.function" pairs, lower-case, in import
+    // order; empty without imports. Ordinals are "ordN" for every DLL
+    // (pefile resolves a few ws2_32 / oleaut32 ordinals to names).
+    static std::string importHash(const PeImage &image);
+    // Overlay bytes that are not the trailing Authenticode table
+    static uint64_t overlayPayload(const PeImage &image);
+};
+
+#endif // PEPARSER_H
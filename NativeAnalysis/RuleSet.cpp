@@ -0,0 +1,738 @@
+#include "RuleSet.h"
+#include "FeatureExtractor.h"
+#include "JsonText.h"
+#include "Sha256.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+// Indices into RuleSet::kVariables
+enum Variable {
+    FileSize, Entropy, Ext, IsExecutable, Signed, Strings, SuspiciousStrings, Mime, MagicType,
+    PeValid, PeSections, PeTimestamp, PeIsDll, PeSigned, PeTlsCallbacks, PeOverlaySize,
+    PePackedSections, PePackedSectionNames, PeImphash,
+};
+
+struct Value {
+    bool isText = false;
+    double number = 0;
+    std::string text;
+
+    static Value of(double n) {
+        Value v;
+        v.number = n;
+        return v;
+    }
+    static Value of(const std::string &s) {
+        Value v;
+        v.isText = true;
+        v.text = s;
+        return v;
+    }
+    bool truthy() const { return isText ? !text.empty() : number != 0; }
+};
+
+enum Compare { Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual };
+
+const int kAny = -1;
+const int kAll = -2;
+
+char lowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+}
+
+std::string lowerCopy(std::string s) {
+    for (char &c : s) c = lowerAscii(c);
+    return s;
+}
+
+// server.py's format_size
+std::string formatSize(double bytes) {
+    if (bytes > 1024 * 1024) return formatDouble("%.2f", bytes / (1024 * 1024)) + " MB";
+    return formatDouble("%.2f", bytes / 1024) + " KB";
+}
+
+std::string formatValue(const Value &v, bool size) {
+    if (v.isText) return v.text;
+    if (size) return formatSize(v.number);
+    if (v.number == std::floor(v.number) && std::fabs(v.number) < 1e15) return formatDouble("%.0f", v.number);
+    return formatDouble("%g", v.number);
+}
+
+} // namespace
+
+const char *const RuleSet::kVariables[] = {
+    "filesize", "entropy", "ext", "is_executable", "signed", "strings", "suspicious_strings", "mime", "magic_type",
+    "pe.valid", "pe.sections", "pe.timestamp", "pe.is_dll", "pe.signed", "pe.tls_callbacks", "pe.overlay_size",
+    "pe.packed_sections", "pe.packed_section_names", "pe.imphash",
+};
+const size_t RuleSet::kVariableCount = sizeof(kVariables) / sizeof(kVariables[0]);
+
+struct RuleSet::Node {
+    enum Kind { Constant, Var, Found, Count, Of, Not, And, Or, Cmp, In, Contains, IContains };
+    Kind kind = Constant;
+    Value constant;
+    int variable = 0;
+    int op = Equal;
+    int quantifier = kAny;         // Of: kAny, kAll or a count
+    std::vector<uint32_t> strings; // Found / Count: one; Of: the set
+    std::vector<int> children;     // node indices; In: the value, then the list
+};
+
+struct RuleSet::Rule {
+    struct String {
+        std::string name;               // without the '$'
+        std::vector<uint32_t> patterns; // ascii and / or wide form
+    };
+    struct Segment {
+        std::string text;
+        int variable = -1; // filled in after text
+        bool size = false;
+    };
+
+    std::string name;
+    std::vector<std::string> tags;
+    bool suspicious = false;
+    std::vector<String> strings;
+    std::vector<Segment> description;
+    int condition = -1;
+};
+
+// Recursive-descent parser for the rule language; fills a RuleSet
+class RuleCompiler {
+public:
+    RuleCompiler(const std::string &source, RuleSet &set) : src(source), set(set) {}
+
+    bool compile(std::string *error) {
+        skipSpace();
+        while (pos < src.size()) {
+            if (!parseRule()) break;
+            skipSpace();
+        }
+        if (!failure.empty()) {
+            if (error) *error = "line " + std::to_string(line) + ": " + failure;
+            return false;
+        }
+        if (!patterns.empty()) {
+            set.matcher.reset(new PatternMatcher(patterns, PatternMatcher::Regex));
+            if (!set.matcher->isValid()) {
+                if (error) *error = set.matcher->errorString();
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    bool fail(const std::string &message) {
+        if (failure.empty()) failure = message;
+        return false;
+    }
+
+    void skipSpace() {
+        while (pos < src.size()) {
+            const char c = src[pos];
+            if (c == '\n') {
+                ++line;
+                ++pos;
+            } else if (c == ' ' || c == '\t' || c == '\r') {
+                ++pos;
+            } else if (src.compare(pos, 2, "//") == 0) {
+                while (pos < src.size() && src[pos] != '\n') ++pos;
+            } else if (src.compare(pos, 2, "/*") == 0) {
+                const size_t end = src.find("*/", pos + 2);
+                const size_t stop = end == std::string::npos ? src.size() : end + 2;
+                line += int(std::count(src.begin() + long(pos), src.begin() + long(stop), '\n'));
+                pos = stop;
+            } else {
+                break;
+            }
+        }
+    }
+
+    static bool identChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    // An identifier, with dotted parts (pe.sections)
+    std::string identifier() {
+        skipSpace();
+        const size_t start = pos;
+        while (pos < src.size() && (identChar(src[pos]) || (src[pos] == '.' && pos > start))) ++pos;
+        return src.substr(start, pos - start);
+    }
+
+    bool accept(const char *token) {
+        skipSpace();
+        const size_t len = strlen(token);
+        if (src.compare(pos, len, token) != 0) return false;
+        // Keywords must not run into an identifier (e.g. "or" in "order")
+        if (identChar(token[len - 1]) && pos + len < src.size() && identChar(src[pos + len])) return false;
+        pos += len;
+        return true;
+    }
+
+    bool expect(const char *token) {
+        return accept(token) || fail(std::string("expected '") + token + "'");
+    }
+
+    bool peek(const char *token) {
+        const size_t saved = pos;
+        const int savedLine = line;
+        const bool found = accept(token);
+        pos = saved;
+        line = savedLine;
+        return found;
+    }
+
+    bool parseRule() {
+        if (!expect("rule")) return false;
+        RuleSet::Rule rule;
+        rule.name = identifier();
+        if (rule.name.empty() || rule.name.find('.') != std::string::npos) return fail("expected a rule name");
+        for (const RuleSet::Rule &other : set.rules) {
+            if (other.name == rule.name) return fail("duplicate rule " + rule.name);
+        }
+        if (accept(":")) {
+            for (std::string tag = identifier(); !tag.empty(); tag = identifier()) {
+                rule.suspicious = rule.suspicious || tag == "suspicious";
+                rule.tags.push_back(tag);
+            }
+        }
+        if (!expect("{")) return false;
+        if (accept("meta")) {
+            if (!expect(":") || !parseMeta(rule)) return false;
+        }
+        if (accept("strings")) {
+            if (!expect(":") || !parseStrings(rule)) return false;
+        }
+        current = &rule;
+        if (!expect("condition") || !expect(":")) return false;
+        rule.condition = parseOr();
+        current = nullptr;
+        if (rule.condition < 0 || !expect("}")) return false;
+        set.rules.push_back(std::move(rule));
+        return true;
+    }
+
+    bool parseMeta(RuleSet::Rule &rule) {
+        while (!peek("strings") && !peek("condition")) {
+            const std::string key = identifier();
+            if (key.empty() || !expect("=")) return fail("expected 'key = value' in meta");
+            skipSpace();
+            if (pos < src.size() && src[pos] == '"') {
+                std::string text;
+                if (!parseText(text)) return false;
+                if (key == "description" && !parseDescription(text, rule)) return false;
+            } else if (identifier().empty()) {
+                return fail("expected a meta value");
+            }
+        }
+        return true;
+    }
+
+    // "{variable}" and "{variable:size}" placeholders; "{{" is a brace
+    bool parseDescription(const std::string &text, RuleSet::Rule &rule) {
+        RuleSet::Rule::Segment segment;
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text.compare(i, 2, "{{") == 0) {
+                segment.text += '{';
+                ++i;
+            } else if (text[i] == '{') {
+                const size_t end = text.find('}', i);
+                if (end == std::string::npos) return fail("unclosed '{' in description");
+                std::string name = text.substr(i + 1, end - i - 1);
+                const size_t colon = name.find(':');
+                if (colon != std::string::npos) {
+                    if (name.substr(colon + 1) != "size") return fail("unknown format in {" + name + "}");
+                    segment.size = true;
+                    name.resize(colon);
+                }
+                segment.variable = variableIndex(name);
+                if (segment.variable < 0) return fail("unknown variable " + name + " in description");
+                rule.description.push_back(segment);
+                segment = RuleSet::Rule::Segment();
+                i = end;
+            } else {
+                segment.text += text[i];
+            }
+        }
+        if (!segment.text.empty()) rule.description.push_back(segment);
+        return true;
+    }
+
+    static int variableIndex(const std::string &name) {
+        for (size_t i = 0; i < RuleSet::kVariableCount; ++i) {
+            if (name == RuleSet::kVariables[i]) return int(i);
+        }
+        return -1;
+    }
+
+    bool parseStrings(RuleSet::Rule &rule) {
+        while (accept("$")) {
+            RuleSet::Rule::String string;
+            string.name = identifier();
+            if (string.name.empty() || string.name.find('.') != std::string::npos) return fail("expected a string name");
+            for (const RuleSet::Rule::String &other : rule.strings) {
+                if (other.name == string.name) return fail("duplicate string $" + string.name);
+            }
+            if (!expect("=")) return false;
+            skipSpace();
+            // Each byte (or escaped pair, or '.') of the pattern as one token
+            std::vector<std::string> tokens;
+            if (pos < src.size() && src[pos] == '"') {
+                std::string text;
+                if (!parseText(text)) return false;
+                for (char c : text) tokens.push_back(c == '\\' || c == '.' ? std::string("\\") + c : std::string(1, c));
+            } else if (pos < src.size() && src[pos] == '/') {
+                if (!parseRegex(tokens)) return false;
+            } else {
+                return fail("expected \"text\" or /regex/ for $" + string.name);
+            }
+            if (tokens.empty()) return fail("empty string $" + string.name);
+            if (tokens.back() == ".") return fail("$" + string.name + " ends in a wildcard");
+
+            bool ascii = false, wide = false;
+            for (;;) {
+                if (accept("ascii")) ascii = true;
+                else if (accept("wide")) wide = true;
+                else if (accept("nocase")) continue; // matching is always case-insensitive
+                else break;
+            }
+            if (ascii || !wide) string.patterns.push_back(addPattern(tokens, false));
+            if (wide) string.patterns.push_back(addPattern(tokens, true));
+            rule.strings.push_back(std::move(string));
+        }
+        return true;
+    }
+
+    uint32_t addPattern(const std::vector<std::string> &tokens, bool wide) {
+        std::string pattern;
+        for (const std::string &token : tokens) {
+            pattern += token;
+            if (wide) pattern += std::string("\\\0", 2); // UTF-16LE: each character, then a zero byte
+        }
+        patterns.push_back(pattern);
+        return uint32_t(patterns.size() - 1);
+    }
+
+    bool parseText(std::string &out) {
+        ++pos; // opening quote
+        while (pos < src.size() && src[pos] != '"') {
+            char c = src[pos++];
+            if (c == '\n') return fail("unterminated string");
+            if (c == '\\' && pos < src.size()) {
+                const char e = src[pos++];
+                if (e == 'n') c = '\n';
+                else if (e == 'r') c = '\r';
+                else if (e == 't') c = '\t';
+                else if (e == '0') c = '\0';
+                else if (e == 'x' && pos + 1 < src.size() && isxdigit(uint8_t(src[pos])) && isxdigit(uint8_t(src[pos + 1]))) {
+                    c = char(std::stoi(src.substr(pos, 2), nullptr, 16));
+                    pos += 2;
+                } else {
+                    c = e;
+                }
+            }
+            out += c;
+        }
+        if (pos >= src.size()) return fail("unterminated string");
+        ++pos;
+        return true;
+    }
+
+    bool parseRegex(std::vector<std::string> &tokens) {
+        ++pos; // opening slash
+        while (pos < src.size() && src[pos] != '/') {
+            const char c = src[pos++];
+            if (c == '\n') return fail("unterminated regex");
+            if (c == '\\' && pos < src.size()) {
+                const char e = src[pos++];
+                tokens.push_back(e == '/' ? std::string("/") : std::string("\\") + e);
+            } else {
+                tokens.push_back(std::string(1, c));
+            }
+        }
+        if (pos >= src.size()) return fail("unterminated regex");
+        ++pos;
+        return true;
+    }
+
+    int add(RuleSet::Node node) {
+        set.nodes.push_back(std::move(node));
+        return int(set.nodes.size() - 1);
+    }
+
+    int binary(RuleSet::Node::Kind kind, int left, int right) {
+        if (left < 0 || right < 0) return -1;
+        RuleSet::Node node;
+        node.kind = kind;
+        node.children = {left, right};
+        return add(node);
+    }
+
+    int parseOr() {
+        int left = parseAnd();
+        while (left >= 0 && accept("or")) left = binary(RuleSet::Node::Or, left, parseAnd());
+        return left;
+    }
+
+    int parseAnd() {
+        int left = parseNot();
+        while (left >= 0 && accept("and")) left = binary(RuleSet::Node::And, left, parseNot());
+        return left;
+    }
+
+    int parseNot() {
+        if (!accept("not")) return parseComparison();
+        const int operand = parseNot();
+        if (operand < 0) return -1;
+        RuleSet::Node node;
+        node.kind = RuleSet::Node::Not;
+        node.children = {operand};
+        return add(node);
+    }
+
+    int parseComparison() {
+        const int left = parsePrimary();
+        if (left < 0) return -1;
+        static const struct { const char *token; int op; } kOps[] = {
+            {"<=", LessEqual}, {">=", GreaterEqual}, {"==", Equal}, {"!=", NotEqual}, {"<", Less}, {">", Greater},
+        };
+        for (const auto &op : kOps) {
+            if (accept(op.token)) {
+                const int right = parsePrimary();
+                if (right < 0) return -1;
+                RuleSet::Node node;
+                node.kind = RuleSet::Node::Cmp;
+                node.op = op.op;
+                node.children = {left, right};
+                return add(node);
+            }
+        }
+        if (accept("icontains")) return binary(RuleSet::Node::IContains, left, parsePrimary());
+        if (accept("contains")) return binary(RuleSet::Node::Contains, left, parsePrimary());
+        if (accept("in")) {
+            RuleSet::Node node;
+            node.kind = RuleSet::Node::In;
+            node.children.push_back(left);
+            if (!expect("(")) return -1;
+            do {
+                const int item = parsePrimary();
+                if (item < 0) return -1;
+                node.children.push_back(item);
+            } while (accept(","));
+            if (!expect(")")) return -1;
+            return add(node);
+        }
+        return left;
+    }
+
+    // One string of the current rule by name, or all matching "name*"
+    bool stringSet(const std::string &name, std::vector<uint32_t> &out) {
+        const bool prefix = !name.empty() && name.back() == '*';
+        const std::string stem = prefix ? name.substr(0, name.size() - 1) : name;
+        for (size_t i = 0; i < current->strings.size(); ++i) {
+            const std::string &s = current->strings[i].name;
+            if (prefix ? s.compare(0, stem.size(), stem) == 0 : s == stem) out.push_back(uint32_t(i));
+        }
+        return !out.empty() || fail("no string $" + name + " in rule " + current->name);
+    }
+
+    std::string stringName() {
+        std::string name = identifier();
+        if (pos < src.size() && src[pos] == '*') {
+            name += '*';
+            ++pos;
+        }
+        return name;
+    }
+
+    int parseOf(int quantifier) {
+        if (!expect("of")) return -1;
+        RuleSet::Node node;
+        node.kind = RuleSet::Node::Of;
+        node.quantifier = quantifier;
+        if (accept("them")) {
+            for (size_t i = 0; i < current->strings.size(); ++i) node.strings.push_back(uint32_t(i));
+            if (node.strings.empty()) return fail("'them' in rule " + current->name + ", which has no strings"), -1;
+        } else {
+            if (!expect("(")) return -1;
+            do {
+                if (!expect("$") || !stringSet(stringName(), node.strings)) return -1;
+            } while (accept(","));
+            if (!expect(")")) return -1;
+        }
+        if (quantifier > int(node.strings.size())) return fail("more strings required than listed"), -1;
+        return add(node);
+    }
+
+    int parsePrimary() {
+        skipSpace();
+        if (pos >= src.size()) return fail("unexpected end of rules"), -1;
+        const char c = src[pos];
+        RuleSet::Node node;
+        if (c == '(') {
+            ++pos;
+            const int inner = parseOr();
+            return inner >= 0 && expect(")") ? inner : -1;
+        }
+        if (c == '"') {
+            std::string text;
+            if (!parseText(text)) return -1;
+            node.constant = Value::of(text);
+            return add(node);
+        }
+        if (c == '$' || c == '#') {
+            ++pos;
+            node.kind = c == '$' ? RuleSet::Node::Found : RuleSet::Node::Count;
+            if (!stringSet(identifier(), node.strings)) return -1;
+            return add(node);
+        }
+        if (c >= '0' && c <= '9') {
+            size_t used = 0;
+            double n = 0;
+            try {
+                n = src.compare(pos, 2, "0x") == 0 ? double(std::stoull(src.substr(pos), &used, 16))
+                                                    : std::stod(src.substr(pos, 64), &used);
+            } catch (...) {
+                return fail("bad number"), -1;
+            }
+            pos += used;
+            if (accept("KB")) n *= 1024;
+            else if (accept("MB")) n *= 1024 * 1024;
+            else if (accept("GB")) n *= 1024.0 * 1024 * 1024;
+            if (accept("of")) {
+                pos -= 2; // parseOf expects it
+                return parseOf(int(n));
+            }
+            node.constant = Value::of(n);
+            return add(node);
+        }
+        if (accept("true")) {
+            node.constant = Value::of(1);
+            return add(node);
+        }
+        if (accept("false")) {
+            node.constant = Value::of(0.0);
+            return add(node);
+        }
+        if (accept("any")) return parseOf(kAny);
+        if (accept("all")) return parseOf(kAll);
+        const std::string name = identifier();
+        if (name.empty()) return fail(std::string("unexpected '") + c + "'"), -1;
+        node.kind = RuleSet::Node::Var;
+        node.variable = variableIndex(name);
+        if (node.variable < 0) return fail("unknown variable " + name), -1;
+        return add(node);
+    }
+
+    const std::string &src;
+    RuleSet &set;
+    size_t pos = 0;
+    int line = 1;
+    std::string failure;
+    std::vector<std::string> patterns;
+    RuleSet::Rule *current = nullptr;
+};
+
+namespace {
+
+struct Context {
+    const RuleSet::Rule *rule;
+    const std::vector<uint32_t> *hits;
+    const std::vector<Value> *variables;
+};
+
+uint64_t stringHits(const Context &ctx, uint32_t string) {
+    uint64_t n = 0;
+    for (uint32_t pattern : ctx.rule->strings[string].patterns) {
+        if (pattern < ctx.hits->size()) n += (*ctx.hits)[pattern];
+    }
+    return n;
+}
+
+bool equalValues(const Value &a, const Value &b) {
+    if (a.isText != b.isText) return false;
+    return a.isText ? a.text == b.text : a.number == b.number;
+}
+
+} // namespace
+
+RuleSet::~RuleSet() = default;
+
+size_t RuleSet::ruleCount() const {
+    return rules.size();
+}
+
+size_t RuleSet::stringCount() const {
+    size_t n = 0;
+    for (const Rule &rule : rules) n += rule.strings.size();
+    return n;
+}
+
+std::shared_ptr<const RuleSet> RuleSet::compile(const std::string &source, std::string *error) {
+    std::shared_ptr<RuleSet> set(new RuleSet);
+    RuleCompiler compiler(source, *set);
+    if (!compiler.compile(error)) return nullptr;
+    Sha256 sha;
+    sha.update(reinterpret_cast<const uint8_t *>(source.data()), source.size());
+    set->sourceHash = sha.hexDigest();
+    return set;
+}
+
+std::shared_ptr<const RuleSet> RuleSet::load(const std::string &path, std::string *error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        if (error) *error = "cannot read " + path;
+        return nullptr;
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+    std::string compileError;
+    std::shared_ptr<const RuleSet> set = compile(text.str(), &compileError);
+    if (!set && error) *error = path + ": " + compileError;
+    return set;
+}
+
+namespace {
+
+Value evaluateNode(const std::vector<RuleSet::Node> &nodes, int index, const Context &ctx);
+
+bool truthy(const std::vector<RuleSet::Node> &nodes, int index, const Context &ctx) {
+    return evaluateNode(nodes, index, ctx).truthy();
+}
+
+Value evaluateNode(const std::vector<RuleSet::Node> &nodes, int index, const Context &ctx) {
+    const RuleSet::Node &n = nodes[size_t(index)];
+    switch (n.kind) {
+    case RuleSet::Node::Constant:
+        return n.constant;
+    case RuleSet::Node::Var:
+        return (*ctx.variables)[size_t(n.variable)];
+    case RuleSet::Node::Found:
+        return Value::of(stringHits(ctx, n.strings[0]) > 0 ? 1 : 0);
+    case RuleSet::Node::Count:
+        return Value::of(double(stringHits(ctx, n.strings[0])));
+    case RuleSet::Node::Of: {
+        int found = 0;
+        for (uint32_t s : n.strings) found += stringHits(ctx, s) > 0;
+        const int needed = n.quantifier == kAny ? 1 : n.quantifier == kAll ? int(n.strings.size()) : n.quantifier;
+        return Value::of(found >= needed ? 1 : 0);
+    }
+    case RuleSet::Node::Not:
+        return Value::of(truthy(nodes, n.children[0], ctx) ? 0 : 1);
+    case RuleSet::Node::And:
+        return Value::of(truthy(nodes, n.children[0], ctx) && truthy(nodes, n.children[1], ctx) ? 1 : 0);
+    case RuleSet::Node::Or:
+        return Value::of(truthy(nodes, n.children[0], ctx) || truthy(nodes, n.children[1], ctx) ? 1 : 0);
+    case RuleSet::Node::Cmp: {
+        const Value a = evaluateNode(nodes, n.children[0], ctx), b = evaluateNode(nodes, n.children[1], ctx);
+        if (a.isText != b.isText) return Value::of(n.op == NotEqual ? 1 : 0);
+        const int c = a.isText ? a.text.compare(b.text) : (a.number < b.number ? -1 : a.number > b.number ? 1 : 0);
+        bool result = false;
+        switch (n.op) {
+        case Less: result = c < 0; break;
+        case LessEqual: result = c <= 0; break;
+        case Greater: result = c > 0; break;
+        case GreaterEqual: result = c >= 0; break;
+        case Equal: result = c == 0; break;
+        default: result = c != 0; break;
+        }
+        return Value::of(result ? 1 : 0);
+    }
+    case RuleSet::Node::In: {
+        const Value v = evaluateNode(nodes, n.children[0], ctx);
+        for (size_t i = 1; i < n.children.size(); ++i) {
+            if (equalValues(v, evaluateNode(nodes, n.children[i], ctx))) return Value::of(1);
+        }
+        return Value::of(0.0);
+    }
+    case RuleSet::Node::Contains:
+    case RuleSet::Node::IContains: {
+        Value a = evaluateNode(nodes, n.children[0], ctx), b = evaluateNode(nodes, n.children[1], ctx);
+        if (!a.isText || !b.isText) return Value::of(0.0);
+        if (n.kind == RuleSet::Node::IContains) {
+            a.text = lowerCopy(a.text);
+            b.text = lowerCopy(b.text);
+        }
+        return Value::of(a.text.find(b.text) != std::string::npos ? 1 : 0);
+    }
+    }
+    return Value();
+}
+
+} // namespace
+
+std::vector<RuleSet::Match> RuleSet::evaluate(const FileFeatures &f, const Externals &externals) const {
+    std::vector<Value> vars(kVariableCount);
+    vars[FileSize] = Value::of(double(f.size));
+    vars[Entropy] = Value::of(f.entropy);
+    vars[Ext] = Value::of(f.extension);
+    vars[IsExecutable] = Value::of(f.isExecutable ? 1 : 0);
+    vars[Signed] = Value::of(f.hasDigitalSignature ? 1 : 0);
+    vars[Strings] = Value::of(double(f.strings.size()));
+    vars[SuspiciousStrings] = Value::of(double(f.suspiciousStrings.size()));
+    vars[Mime] = Value::of(externals.mime);
+    vars[MagicType] = Value::of(externals.magicType);
+    // Zero or empty for files that are not PE images
+    vars[PeValid] = Value::of(f.pe.valid ? 1 : 0);
+    vars[PeSections] = Value::of(f.pe.valid ? double(f.pe.sections) : 0);
+    vars[PeTimestamp] = Value::of(f.pe.valid ? double(f.pe.timestamp) : 0);
+    vars[PeIsDll] = Value::of(f.pe.valid && (f.pe.characteristics & 0x2000) ? 1 : 0);
+    vars[PeSigned] = Value::of(f.pe.valid && f.pe.hasSecurityDirectory ? 1 : 0);
+    vars[PeTlsCallbacks] = Value::of(double(f.pe.tlsCallbacks));
+    vars[PeOverlaySize] = Value::of(double(f.pe.overlayPayload));
+    vars[PePackedSections] = Value::of(double(f.pe.packedSections.size()));
+    std::string names;
+    for (const std::string &name : f.pe.packedSections) names += (names.empty() ? "" : ", ") + name;
+    vars[PePackedSectionNames] = Value::of(names);
+    vars[PeImphash] = Value::of(f.pe.imphash);
+
+    std::vector<Match> matches;
+    for (const Rule &rule : rules) {
+        const Context ctx{&rule, &f.contentPatternHits, &vars};
+        if (!truthy(nodes, rule.condition, ctx)) continue;
+        Match m;
+        m.name = rule.name;
+        m.tags = rule.tags;
+        m.suspicious = rule.suspicious;
+        for (const Rule::Segment &segment : rule.description) {
+            m.description += segment.text;
+            if (segment.variable >= 0) m.description += formatValue(vars[size_t(segment.variable)], segment.size);
+        }
+        matches.push_back(std::move(m));
+    }
+    return matches;
+}
+
+std::string RuleSet::toJson(const std::vector<Match> &matches) {
+    const bool suspicious = std::any_of(matches.begin(), matches.end(), [](const Match &m) { return m.suspicious; });
+    std::string out = "{";
+    appendKey(out, "suspicious");
+    out += suspicious ? "true" : "false";
+    appendKey(out, "matched");
+    out += '[';
+    for (size_t i = 0; i < matches.size(); ++i) {
+        if (i) out += ", ";
+        out += '{';
+        appendKey(out, "name");
+        appendJsonString(out, matches[i].name);
+        appendKey(out, "tags");
+        out += '[';
+        for (size_t t = 0; t < matches[i].tags.size(); ++t) {
+            if (t) out += ", ";
+            appendJsonString(out, matches[i].tags[t]);
+        }
+        out += ']';
+        appendKey(out, "description");
+        appendJsonString(out, matches[i].description);
+        out += '}';
+    }
+    out += "]}";
+    return out;
+}
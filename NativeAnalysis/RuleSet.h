@@ -0,0 +1,90 @@
+#ifndef RULESET_H
+#define RULESET_H
+
+#include "PatternMatcher.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct FileFeatures;
+
+// Detection rules in a small YARA-like language, compiled once:
+//
+//   rule Script_Host : suspicious {
+//       meta:
+//           description = "Starts {ext} content through a script host."
+//       strings:
+//           $a = "wscript" wide ascii
+//           $b = /eval\(/
+//       condition:
+//           any of them and filesize < 10MB
+//   }
+//
+// Every string of every rule becomes one pattern of a single PatternMatcher,
+// which FeatureExtractor runs in its pass over the file; evaluate() then
+// only reads the per-pattern hit counts and the features. Strings match
+// ASCII case-insensitively; /.../ uses PatternMatcher's regex subset ('\'
+// escapes, '.' is any byte but '\n'). Conditions combine $x (found), #x
+// (count), "any / all / N of them" or "of ($a, $b*)", and / or / not,
+// comparisons, "in (...)", contains / icontains, numbers (with KB / MB),
+// strings, true / false and the variables listed in kVariables. A rule
+// tagged "suspicious" makes the verdict suspicious; its description, with
+// {variable} or {variable:size} filled in, explains why.
+//
+// Immutable once compiled, so one RuleSet can serve many threads while a
+// reload compiles its replacement.
+class RuleSet {
+public:
+    // What the caller supplies besides the features (MIME by name and the
+    // libmagic / content description); empty when unknown
+    struct Externals {
+        std::string mime;
+        std::string magicType;
+    };
+
+    struct Match {
+        std::string name;
+        std::vector<std::string> tags;
+        std::string description; // placeholders filled in; may be empty
+        bool suspicious = false; // tagged "suspicious"
+    };
+
+    static const char *const kVariables[];
+    static const size_t kVariableCount;
+
+    ~RuleSet();
+
+    static std::shared_ptr<const RuleSet> compile(const std::string &source, std::string *error = nullptr);
+    static std::shared_ptr<const RuleSet> load(const std::string &path, std::string *error = nullptr);
+
+    // Patterns for FeatureExtractor::extract; null when no rule has strings
+    const PatternMatcher *patterns() const { return matcher.get(); }
+    size_t ruleCount() const;
+    size_t stringCount() const;
+    const std::string &fingerprint() const { return sourceHash; } // SHA-256 of the source
+
+    // Rules that match, in file order. features.contentPatternHits must come
+    // from a pass with patterns().
+    std::vector<Match> evaluate(const FileFeatures &features, const Externals &externals) const;
+
+    // {"suspicious": bool, "matched": [{"name", "tags", "description"}]}
+    static std::string toJson(const std::vector<Match> &matches);
+
+    struct Node;
+    struct Rule;
+
+private:
+    RuleSet() = default;
+
+    std::vector<Rule> rules;
+    std::vector<Node> nodes;
+    std::unique_ptr<PatternMatcher> matcher;
+    std::string sourceHash;
+
+    friend class RuleCompiler;
+};
+
+#endif // RULESET_H
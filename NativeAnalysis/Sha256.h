@@ -0,0 +1,25 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Incremental SHA-256 (FIPS 180-4)
+class Sha256 {
+public:
+    Sha256();
+    void update(const uint8_t *data, size_t len);
+    void final(uint8_t digest[32]);
+    std::string hexDigest(); // finalizes
+
+private:
+    void compress(const uint8_t *block);
+
+    uint32_t state[8];
+    uint64_t totalBytes;
+    uint8_t buffer[64];
+    size_t buffered;
+};
+
+#endif // SHA256_H
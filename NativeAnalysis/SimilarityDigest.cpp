@@ -0,0 +1,165 @@
+#include "SimilarityDigest.h"
+#include "HexEncode.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Pearson permutation (for the checksum) and the per-byte-pair body
+// distances, built once
+struct Tables {
+    uint8_t pearson[256];
+    uint8_t bodyDistance[256][256]; // summed over the four 2-bit codes of two body bytes
+
+    Tables() {
+        // Fixed Fisher-Yates shuffle, so digests are stable across builds
+        for (int i = 0; i < 256; ++i) pearson[i] = uint8_t(i);
+        uint64_t state = 0x9e3779b97f4a7c15ull;
+        for (int i = 255; i > 0; --i) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            std::swap(pearson[i], pearson[state % uint64_t(i + 1)]);
+        }
+        for (int a = 0; a < 256; ++a) {
+            for (int b = 0; b < 256; ++b) {
+                int d = 0;
+                for (int shift = 0; shift < 8; shift += 2) {
+                    const int diff = std::abs(((a >> shift) & 3) - ((b >> shift) & 3));
+                    d += diff == 3 ? 6 : diff; // opposite quartiles weigh extra
+                }
+                bodyDistance[a][b] = uint8_t(d);
+            }
+        }
+    }
+};
+
+const Tables &tables() {
+    static const Tables t;
+    return t;
+}
+
+// Bucket of a byte triplet: multiplicative hashing, one multiplier per
+// triplet position, top 7 bits
+inline uint32_t triplet(uint32_t multiplier, uint8_t a, uint8_t b, uint8_t c) {
+    return ((uint32_t(a) | uint32_t(b) << 8 | uint32_t(c) << 16) * multiplier) >> 25;
+}
+
+// TLSH's length code: finer steps for small files
+uint8_t lengthCode(uint64_t len) {
+    const double l = double(len);
+    double code;
+    if (len <= 656) code = std::log(l) / std::log(1.5);
+    else if (len <= 3199) code = std::log(l) / std::log(1.3) - 8.72777;
+    else code = std::log(l) / std::log(1.1) - 62.5472;
+    return uint8_t(std::min(255.0, std::floor(code)));
+}
+
+int modDiff(int a, int b, int range) {
+    const int d = std::abs(a - b);
+    return std::min(d, range - d);
+}
+
+} // namespace
+
+SimilarityDigest::SimilarityDigest() : counts(), window(), checksum(0), length(0) {
+    tables();
+}
+
+void SimilarityDigest::update(const uint8_t *data, size_t len) {
+    const uint8_t *t = tables().pearson;
+    uint8_t w1 = window[0], w2 = window[1], w3 = window[2], w4 = window[3];
+    uint8_t sum = checksum;
+    uint64_t seen = length;
+    for (size_t i = 0; i < len; ++i, ++seen) {
+        const uint8_t c = data[i];
+        if (seen >= 4) {
+            // Checksum over byte pairs, then the six triplets of the 5-byte
+            // window ending at c. TLSH chains Pearson hashes for both; the
+            // serial lookups cost more than the rest of the pass.
+            sum = uint8_t(sum + t[c ^ t[w1]]);
+            ++counts[triplet(0x9e3779b1u, c, w1, w2)];
+            ++counts[triplet(0x85ebca77u, c, w1, w3)];
+            ++counts[triplet(0xc2b2ae3du, c, w2, w3)];
+            ++counts[triplet(0x27d4eb2fu, c, w2, w4)];
+            ++counts[triplet(0x165667b1u, c, w1, w4)];
+            ++counts[triplet(0xd3a2646du, c, w3, w4)];
+        }
+        w4 = w3;
+        w3 = w2;
+        w2 = w1;
+        w1 = c;
+    }
+    window[0] = w1;
+    window[1] = w2;
+    window[2] = w3;
+    window[3] = w4;
+    checksum = sum;
+    length = seen;
+}
+
+bool SimilarityDigest::final(Digest &out) const {
+    if (length < kMinLength) return false;
+    uint32_t sorted[kBuckets];
+    memcpy(sorted, counts, sizeof(sorted));
+    std::nth_element(sorted, sorted + 95, sorted + kBuckets);
+    const uint32_t q3 = sorted[95];
+    std::nth_element(sorted, sorted + 63, sorted + 95);
+    const uint32_t q2 = sorted[63];
+    std::nth_element(sorted, sorted + 31, sorted + 63);
+    const uint32_t q1 = sorted[31];
+    const size_t nonZero = size_t(std::count_if(counts, counts + kBuckets, [](uint32_t c) { return c != 0; }));
+    // Too few distinct triplets (e.g. a run of one byte) to place quartiles
+    if (q3 == 0 || nonZero <= kBuckets / 2) return false;
+
+    out = Digest();
+    out.bytes[0] = checksum;
+    out.bytes[1] = lengthCode(length);
+    const uint8_t q1Ratio = uint8_t((uint64_t(q1) * 100 / q3) % 16);
+    const uint8_t q2Ratio = uint8_t((uint64_t(q2) * 100 / q3) % 16);
+    out.bytes[2] = uint8_t(q1Ratio << 4 | q2Ratio);
+    for (size_t i = 0; i < kBuckets; ++i) {
+        const uint32_t c = counts[i];
+        const uint8_t code = c <= q1 ? 0 : c <= q2 ? 1 : c <= q3 ? 2 : 3;
+        out.bytes[3 + i / 4] |= uint8_t(code << (2 * (i % 4)));
+    }
+    return true;
+}
+
+std::string SimilarityDigest::hexDigest() const {
+    Digest d;
+    return final(d) ? hexEncode(d.bytes, kDigestBytes) : std::string();
+}
+
+int SimilarityDigest::distance(const Digest &a, const Digest &b) {
+    int d = 0;
+    if (a.bytes[0] != b.bytes[0]) d += 1;
+
+    const int lengthDiff = modDiff(a.bytes[1], b.bytes[1], 256);
+    d += lengthDiff <= 1 ? lengthDiff : lengthDiff * 12;
+
+    const int q1Diff = modDiff(a.bytes[2] >> 4, b.bytes[2] >> 4, 16);
+    d += q1Diff <= 1 ? q1Diff : (q1Diff - 1) * 12;
+    const int q2Diff = modDiff(a.bytes[2] & 15, b.bytes[2] & 15, 16);
+    d += q2Diff <= 1 ? q2Diff : (q2Diff - 1) * 12;
+
+    const Tables &t = tables();
+    for (size_t i = 3; i < kDigestBytes; ++i) d += t.bodyDistance[a.bytes[i]][b.bytes[i]];
+    return d;
+}
+
+bool SimilarityDigest::parseHex(const std::string &hex, Digest &out) {
+    if (hex.size() != kDigestBytes * 2) return false;
+    for (size_t i = 0; i < hex.size(); ++i) {
+        const char c = hex[i];
+        int v;
+        if (c >= '0' && c <= '9') v = c - '0';
+        else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+        else return false;
+        if (i % 2 == 0) out.bytes[i / 2] = uint8_t(v << 4);
+        else out.bytes[i / 2] |= uint8_t(v);
+    }
+    return true;
+}
@@ -0,0 +1,46 @@
+#ifndef SIMILARITYDIGEST_H
+#define SIMILARITYDIGEST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Locality-sensitive digest in the style of TLSH: every 5-byte window adds
+// six byte triplets to 128 buckets, and the digest keeps each bucket's
+// quartile (2 bits) plus a small header (checksum, log length, quartile
+// ratios). Files that differ in a few places get digests a small distance
+// apart, where SHA-256 changes completely. The layout and the distance
+// follow TLSH, but the triplet and checksum hashes are our own (cheaper),
+// so digests are not comparable with the tlsh library's.
+//
+// Fed incrementally, so it runs inside FeatureExtractor's single pass.
+class SimilarityDigest {
+public:
+    static constexpr size_t kBuckets = 128;
+    static constexpr size_t kBodyBytes = kBuckets / 4;
+    static constexpr size_t kDigestBytes = 3 + kBodyBytes; // checksum, length, ratios, body
+    static constexpr size_t kMinLength = 50;                 // shorter inputs have no digest
+
+    struct Digest {
+        uint8_t bytes[kDigestBytes] = {};
+    };
+
+    SimilarityDigest();
+    void update(const uint8_t *data, size_t len);
+    // False if the input was too short or too uniform to describe
+    bool final(Digest &out) const;
+    std::string hexDigest() const; // empty when final() fails
+
+    // 0 for identical digests. TLSH's scale: under ~100 is usually the same
+    // family, unrelated files land in the hundreds
+    static int distance(const Digest &a, const Digest &b);
+    static bool parseHex(const std::string &hex, Digest &out);
+
+private:
+    uint32_t counts[kBuckets];
+    uint8_t window[4]; // the previous bytes, newest first
+    uint8_t checksum;
+    uint64_t length;
+};
+
+#endif // SIMILARITYDIGEST_H
@@ -0,0 +1,94 @@
+#include "SimilarityIndex.h"
+#include <algorithm>
+
+SimilarityIndex::SimilarityIndex(size_t capacity)
+    : capacity(std::max<size_t>(1, capacity)), nextSeq(0), postingCount(0), additions(0), queries(0) {}
+
+uint32_t SimilarityIndex::bandKey(const SimilarityDigest::Digest &digest, size_t band) {
+    const uint8_t *body = digest.bytes + 3;
+    return uint32_t(band) << 16 | uint32_t(body[2 * band]) << 8 | body[2 * band + 1];
+}
+
+void SimilarityIndex::add(const SimilarityDigest::Digest &digest, int64_t id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (nextSeq == UINT32_MAX) {
+        entries.clear();
+        postings.clear();
+        postingCount = 0;
+        nextSeq = 0;
+    }
+    const uint32_t seq = nextSeq++;
+    Entry entry;
+    entry.digest = digest;
+    entry.id = id;
+    if (entries.size() < capacity) entries.push_back(entry);
+    else entries[seq % capacity] = entry;
+    for (size_t band = 0; band < kBands; ++band) postings[bandKey(digest, band)].push_back(seq);
+    postingCount += kBands;
+    ++additions;
+    // Evicted seqs stay in the lists until they are half of all postings
+    if (postingCount > 2 * kBands * entries.size()) compact();
+}
+
+void SimilarityIndex::compact() {
+    for (auto it = postings.begin(); it != postings.end();) {
+        std::vector<uint32_t> &seqs = it->second;
+        const auto firstLive = std::find_if(seqs.begin(), seqs.end(), [&](uint32_t s) { return live(s); });
+        postingCount -= size_t(firstLive - seqs.begin());
+        seqs.erase(seqs.begin(), firstLive);
+        if (seqs.empty()) it = postings.erase(it);
+        else ++it;
+    }
+}
+
+std::vector<SimilarityIndex::Match> SimilarityIndex::query(const SimilarityDigest::Digest &digest, size_t k,
+                                                           int maxDistance) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++queries;
+    std::vector<uint32_t> candidates;
+    for (size_t band = 0; band < kBands; ++band) {
+        const auto it = postings.find(bandKey(digest, band));
+        if (it == postings.end()) continue;
+        const std::vector<uint32_t> &seqs = it->second;
+        // Newest first; everything before an evicted seq is evicted too
+        size_t scanned = 0;
+        for (auto s = seqs.rbegin(); s != seqs.rend() && scanned < kMaxBucketScan && live(*s); ++s, ++scanned) {
+            candidates.push_back(*s);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::vector<std::pair<Match, uint32_t>> scored; // with seq, to prefer newer on ties
+    for (uint32_t seq : candidates) {
+        const Entry &e = entries[seq % capacity];
+        const int d = SimilarityDigest::distance(digest, e.digest);
+        if (d <= maxDistance) scored.push_back({{e.id, d}, seq});
+    }
+    const size_t n = std::min(k, scored.size());
+    std::partial_sort(scored.begin(), scored.begin() + n, scored.end(), [](const auto &a, const auto &b) {
+        return a.first.distance != b.first.distance ? a.first.distance < b.first.distance : a.second > b.second;
+    });
+    std::vector<Match> out;
+    out.reserve(n);
+    for (size_t i = 0; i < n; ++i) out.push_back(scored[i].first);
+    return out;
+}
+
+void SimilarityIndex::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    postings.clear();
+    postingCount = 0;
+    nextSeq = 0;
+}
+
+SimilarityIndex::Stats SimilarityIndex::stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats s;
+    s.entries = entries.size();
+    s.capacity = capacity;
+    s.additions = additions;
+    s.queries = queries;
+    return s;
+}
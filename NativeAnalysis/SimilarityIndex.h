@@ -0,0 +1,67 @@
+#ifndef SIMILARITYINDEX_H
+#define SIMILARITYINDEX_H
+
+#include "SimilarityDigest.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Nearest-neighbour lookup over SimilarityDigests. The digest body is cut
+// into kBands 16-bit bands, and each band value keeps a posting list of the
+// entries that have it (locality-sensitive hashing). A query only scores
+// entries that share at least one band with it, newest first and at most
+// kMaxBucketScan per band, so it stays in the milliseconds with a million
+// entries. Close variants share most bands, so they are rarely missed.
+//
+// Holds the last `capacity` digests; older ones drop out as new ones are
+// added. All calls are thread-safe.
+class SimilarityIndex {
+public:
+    static constexpr size_t kBands = SimilarityDigest::kBodyBytes / 2;
+    static constexpr size_t kMaxBucketScan = 2048;
+
+    struct Match {
+        int64_t id;
+        int distance;
+    };
+
+    struct Stats {
+        size_t entries = 0;
+        size_t capacity = 0;
+        uint64_t additions = 0;
+        uint64_t queries = 0;
+    };
+
+    explicit SimilarityIndex(size_t capacity = 1000000);
+
+    void add(const SimilarityDigest::Digest &digest, int64_t id);
+    // Up to k entries within maxDistance, closest first
+    std::vector<Match> query(const SimilarityDigest::Digest &digest, size_t k, int maxDistance);
+    void clear();
+    Stats stats();
+
+private:
+    struct Entry {
+        SimilarityDigest::Digest digest;
+        int64_t id = 0;
+    };
+
+    static uint32_t bandKey(const SimilarityDigest::Digest &digest, size_t band);
+    bool live(uint32_t seq) const { return nextSeq - seq <= entries.size(); }
+    void compact();
+
+    std::mutex mutex;
+    size_t capacity;
+    std::vector<Entry> entries; // ring, slot = seq % capacity
+    uint32_t nextSeq;           // the index starts over if it wraps
+    // band key -> seqs, oldest first; evicted seqs are skipped on lookup
+    // and dropped by compact()
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings;
+    size_t postingCount;
+    uint64_t additions;
+    uint64_t queries;
+};
+
+#endif // SIMILARITYINDEX_H
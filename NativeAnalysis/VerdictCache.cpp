@@ -0,0 +1,338 @@
+#include "VerdictCache.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kMagic[8] = {'S', 'G', 'V', 'C', 'A', 'C', 'H', 'E'};
+const uint32_t kFormat = 1;         // bump when the layout below changes
+const size_t kHeaderBytes = 4096;   // header is padded to one page
+const uint64_t kMinHeapBytes = 64 * 1024;
+
+uint64_t alignUp(uint64_t n) {
+    return (n + 7) & ~uint64_t(7);
+}
+
+uint32_t slotCountFor(uint32_t maxEntries) {
+    uint32_t n = 16;
+    while (n < uint64_t(maxEntries) * 2) n <<= 1;
+    return n;
+}
+
+} // namespace
+
+struct VerdictCache::Header {
+    char magic[8];
+    uint32_t format;
+    uint32_t dirty; // set while the table or heap is being changed
+    uint32_t slotCount;
+    uint32_t maxEntries;
+    uint64_t heapSize;
+    uint64_t heapUsed; // bump pointer; space behind it may be garbage
+    uint64_t liveBytes;
+    uint64_t clock;    // last-use stamp source
+    uint32_t entries;
+    uint32_t reserved;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t insertions;
+    uint64_t evictions;
+    char version[128];
+};
+
+// length == 0 marks an empty slot
+struct VerdictCache::Slot {
+    uint8_t key[kKeyBytes];
+    uint64_t offset; // into the heap
+    uint32_t length;
+    uint32_t reserved;
+    uint64_t lastUsed;
+};
+
+VerdictCache::~VerdictCache() {
+    close();
+}
+
+bool VerdictCache::parseKey(const std::string &hex, uint8_t key[kKeyBytes]) {
+    if (hex.size() != kKeyBytes * 2) return false;
+    for (size_t i = 0; i < hex.size(); ++i) {
+        const char c = hex[i];
+        int v;
+        if (c >= '0' && c <= '9') v = c - '0';
+        else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+        else return false;
+        if (i % 2 == 0) key[i / 2] = uint8_t(v << 4);
+        else key[i / 2] |= uint8_t(v);
+    }
+    return true;
+}
+
+bool VerdictCache::open(const std::string &path, const std::string &version, const Limits &limits,
+                        std::string *error) {
+    static_assert(sizeof(Header) <= kHeaderBytes, "header must fit its page");
+    std::lock_guard<std::mutex> lock(mutex);
+    close();
+
+    const uint32_t slotCount = slotCountFor(std::max<uint32_t>(limits.maxEntries, 1));
+    const uint64_t fixedBytes = kHeaderBytes + uint64_t(slotCount) * sizeof(Slot);
+    if (limits.maxBytes < fixedBytes + kMinHeapBytes || version.size() >= sizeof(Header::version)) {
+        if (error) *error = "cache limits too small or version too long";
+        return false;
+    }
+    mappedSize = size_t(limits.maxBytes);
+
+#ifdef _WIN32
+    const int wlen = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    std::wstring wpath(wlen > 0 ? wlen : 1, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wpath[0], wlen);
+    // No sharing: the owning process has the file to itself
+    HANDLE file = CreateFileW(wpath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    fileHandle = file;
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    const bool resized = uint64_t(size.QuadPart) != limits.maxBytes;
+    if (resized) {
+        LARGE_INTEGER want;
+        want.QuadPart = LONGLONG(limits.maxBytes);
+        if (!SetFilePointerEx(file, want, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+            if (error) *error = "cannot size " + path;
+            close();
+            return false;
+        }
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+    if (!mapping) {
+        if (error) *error = "cannot map " + path;
+        close();
+        return false;
+    }
+    mappingHandle = mapping;
+    base = static_cast<uint8_t *>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0));
+    if (!base) {
+        if (error) *error = "cannot map " + path;
+        close();
+        return false;
+    }
+#else
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        if (error) *error = path + ": " + strerror(errno);
+        return false;
+    }
+    if (flock(fd, LOCK_EX | LOCK_NB) < 0) {
+        if (error) *error = path + ": in use by another process";
+        close();
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        if (error) *error = path + ": " + strerror(errno);
+        close();
+        return false;
+    }
+    const bool resized = uint64_t(st.st_size) != limits.maxBytes;
+    if (resized && ftruncate(fd, off_t(limits.maxBytes)) < 0) {
+        if (error) *error = path + ": " + strerror(errno);
+        close();
+        return false;
+    }
+    void *map = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        if (error) *error = path + ": " + strerror(errno);
+        close();
+        return false;
+    }
+    base = static_cast<uint8_t *>(map);
+#endif
+
+    header = reinterpret_cast<Header *>(base);
+    slots = reinterpret_cast<Slot *>(base + kHeaderBytes);
+    heap = base + fixedBytes;
+    const bool valid = !resized && memcmp(header->magic, kMagic, sizeof(kMagic)) == 0
+                       && header->format == kFormat && header->dirty == 0 && header->slotCount == slotCount
+                       && header->maxEntries == limits.maxEntries
+                       && header->heapSize == limits.maxBytes - fixedBytes
+                       && strncmp(header->version, version.c_str(), sizeof(header->version)) == 0;
+    if (!valid) initialize(version, limits);
+    return true;
+}
+
+void VerdictCache::initialize(const std::string &version, const Limits &limits) {
+    const uint32_t slotCount = slotCountFor(std::max<uint32_t>(limits.maxEntries, 1));
+    memset(base, 0, kHeaderBytes + size_t(slotCount) * sizeof(Slot));
+    memcpy(header->magic, kMagic, sizeof(kMagic));
+    header->format = kFormat;
+    header->slotCount = slotCount;
+    header->maxEntries = limits.maxEntries;
+    header->heapSize = limits.maxBytes - kHeaderBytes - uint64_t(slotCount) * sizeof(Slot);
+    memcpy(header->version, version.c_str(), version.size());
+}
+
+void VerdictCache::close() {
+#ifdef _WIN32
+    if (base) UnmapViewOfFile(base);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    if (base) munmap(base, mappedSize);
+    if (fd >= 0) ::close(fd); // also drops the lock
+    fd = -1;
+#endif
+    base = nullptr;
+    header = nullptr;
+    slots = nullptr;
+    heap = nullptr;
+    mappedSize = 0;
+}
+
+int64_t VerdictCache::find(const uint8_t *key) const {
+    // Keys are SHA-256 digests, so any 8 bytes are already well mixed
+    uint64_t home;
+    memcpy(&home, key, sizeof(home));
+    const uint32_t mask = header->slotCount - 1;
+    for (uint32_t i = uint32_t(home) & mask;; i = (i + 1) & mask) {
+        const Slot &s = slots[i];
+        if (s.length == 0) return -int64_t(i) - 1;
+        if (memcmp(s.key, key, kKeyBytes) == 0) return i;
+    }
+}
+
+bool VerdictCache::get(const uint8_t key[kKeyBytes], std::string &value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!base) return false;
+    const int64_t i = find(key);
+    if (i < 0) {
+        ++header->misses;
+        return false;
+    }
+    Slot &s = slots[i];
+    value.assign(reinterpret_cast<const char *>(heap + s.offset), s.length);
+    s.lastUsed = ++header->clock;
+    ++header->hits;
+    return true;
+}
+
+bool VerdictCache::put(const uint8_t key[kKeyBytes], const std::string &value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!base || value.empty() || value.size() > header->heapSize / 8 || value.size() > UINT32_MAX) return false;
+    const uint64_t length = value.size();
+    header->dirty = 1;
+
+    int64_t i = find(key);
+    if (i >= 0 && slots[i].length >= length) {
+        // Fits where the old value was
+        Slot &s = slots[i];
+        header->liveBytes -= s.length - length;
+        memcpy(heap + s.offset, value.data(), length);
+        s.length = uint32_t(length);
+        s.lastUsed = ++header->clock;
+    } else {
+        const bool fresh = i < 0;
+        if ((fresh && header->entries + 1 > header->maxEntries)
+            || header->heapUsed + alignUp(length) > header->heapSize) {
+            evict(alignUp(length));
+            i = find(key); // compaction moved everything
+        }
+        Slot &s = slots[i < 0 ? -i - 1 : i];
+        if (i >= 0) {
+            header->liveBytes -= s.length; // the old copy is now garbage
+        } else {
+            memcpy(s.key, key, kKeyBytes);
+            ++header->entries;
+        }
+        s.offset = header->heapUsed;
+        s.length = uint32_t(length);
+        s.lastUsed = ++header->clock;
+        memcpy(heap + s.offset, value.data(), length);
+        header->heapUsed += alignUp(length);
+        header->liveBytes += length;
+    }
+    ++header->insertions;
+    header->dirty = 0;
+    return true;
+}
+
+void VerdictCache::evict(uint64_t incomingBytes) {
+    std::vector<Slot> live;
+    live.reserve(header->entries);
+    for (uint32_t i = 0; i < header->slotCount; ++i) {
+        if (slots[i].length) live.push_back(slots[i]);
+    }
+
+    // Keep the most recently used entries, up to 3/4 of each limit
+    std::sort(live.begin(), live.end(), [](const Slot &a, const Slot &b) { return a.lastUsed > b.lastUsed; });
+    const uint64_t byteBudget = std::min(header->heapSize * 3 / 4, header->heapSize - incomingBytes);
+    const size_t entryBudget = size_t(header->maxEntries) * 3 / 4;
+    size_t kept = 0;
+    uint64_t keptBytes = 0;
+    while (kept < live.size() && kept < entryBudget && keptBytes + alignUp(live[kept].length) <= byteBudget) {
+        keptBytes += alignUp(live[kept].length);
+        ++kept;
+    }
+    header->evictions += live.size() - kept;
+    live.resize(kept);
+
+    // Slide survivors down in heap order; a destination never passes its source
+    std::sort(live.begin(), live.end(), [](const Slot &a, const Slot &b) { return a.offset < b.offset; });
+    uint64_t used = 0;
+    uint64_t liveBytes = 0;
+    for (Slot &s : live) {
+        if (s.offset != used) memmove(heap + used, heap + s.offset, s.length);
+        s.offset = used;
+        used += alignUp(s.length);
+        liveBytes += s.length;
+    }
+
+    memset(slots, 0, size_t(header->slotCount) * sizeof(Slot));
+    for (const Slot &s : live) slots[-find(s.key) - 1] = s;
+    header->entries = uint32_t(live.size());
+    header->heapUsed = used;
+    header->liveBytes = liveBytes;
+}
+
+void VerdictCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!base) return;
+    header->dirty = 1;
+    memset(slots, 0, size_t(header->slotCount) * sizeof(Slot));
+    header->entries = 0;
+    header->heapUsed = 0;
+    header->liveBytes = 0;
+    header->dirty = 0;
+}
+
+VerdictCache::Stats VerdictCache::stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats s;
+    if (!base) return s;
+    s.entries = header->entries;
+    s.maxEntries = header->maxEntries;
+    s.valueBytes = header->liveBytes;
+    s.heapBytes = header->heapSize;
+    s.hits = header->hits;
+    s.misses = header->misses;
+    s.insertions = header->insertions;
+    s.evictions = header->evictions;
+    return s;
+}
@@ -0,0 +1,82 @@
+#ifndef VERDICTCACHE_H
+#define VERDICTCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Persistent verdicts keyed by content SHA-256, in one memory-mapped file:
+// a fixed header, an open-addressing (linear probing) slot table, and a
+// heap of values. A lookup is a few probes and one copy, with no parsing.
+//
+// The table is at most half full. When a put would exceed the entry or byte
+// limit, the least recently used entries are dropped until both are at 3/4
+// and the heap is compacted in place.
+//
+// The file is tied to a version string (the rule / model version); a file
+// written for another version, layout or set of limits, or one left
+// mid-update by a crash, is wiped on open. One process owns the file at a
+// time; within it, all calls are thread-safe.
+class VerdictCache {
+public:
+    struct Limits {
+        uint64_t maxBytes = 64ull * 1024 * 1024; // whole file
+        uint32_t maxEntries = 16384;
+    };
+
+    struct Stats {
+        uint32_t entries = 0;
+        uint32_t maxEntries = 0;
+        uint64_t valueBytes = 0; // live values
+        uint64_t heapBytes = 0;  // heap capacity
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t insertions = 0;
+        uint64_t evictions = 0;
+    };
+
+    static const size_t kKeyBytes = 32;
+
+    VerdictCache() = default;
+    ~VerdictCache();
+    VerdictCache(const VerdictCache &) = delete;
+    VerdictCache &operator=(const VerdictCache &) = delete;
+
+    bool open(const std::string &path, const std::string &version, const Limits &limits,
+              std::string *error = nullptr);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+
+    bool get(const uint8_t key[kKeyBytes], std::string &value);
+    // False if the value is empty or larger than an eighth of the heap
+    bool put(const uint8_t key[kKeyBytes], const std::string &value);
+    void clear();
+    Stats stats();
+
+    // 64 hex digits to a key
+    static bool parseKey(const std::string &hex, uint8_t key[kKeyBytes]);
+
+private:
+    struct Header;
+    struct Slot;
+
+    void initialize(const std::string &version, const Limits &limits);
+    int64_t find(const uint8_t *key) const; // slot index, or -(empty slot) - 1
+    void evict(uint64_t incomingBytes);
+
+    std::mutex mutex;
+    uint8_t *base = nullptr;
+    size_t mappedSize = 0;
+    Header *header = nullptr;
+    Slot *slots = nullptr;
+    uint8_t *heap = nullptr;
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+#endif // VERDICTCACHE_H
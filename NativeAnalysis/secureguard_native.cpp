@@ -0,0 +1,347 @@
+#include "secureguard_native.h"
+#include "Allowlist.h"
+#include "ByteHistogram.h"
+#include "FeatureExtractor.h"
+#include "MappedFile.h"
+#include "PatternMatcher.h"
+#include "RuleSet.h"
+#include "SimilarityIndex.h"
+#include "VerdictCache.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+static char *copyOut(const std::string &s) {
+    char *out = static_cast<char *>(malloc(s.size() + 1));
+    if (out) memcpy(out, s.c_str(), s.size() + 1);
+    return out;
+}
+
+int sg_abi_version(void) {
+    return SG_NATIVE_ABI_VERSION;
+}
+
+char *sg_extract_features_json(const char *path) {
+    if (!path) return nullptr;
+    try {
+        FileFeatures features;
+        if (!FeatureExtractor::extract(path, features)) return nullptr;
+        return copyOut(FeatureExtractor::toJson(features));
+    } catch (...) {
+        return nullptr; // never let an exception cross the C boundary
+    }
+}
+
+int sg_file_entropy(const char *path, double *entropy) {
+    if (!path || !entropy) return -1;
+    MappedFile file;
+    if (!file.open(path)) return -1;
+    *entropy = ByteHistogram::entropy(file.data(), file.size());
+    return 0;
+}
+
+long long sg_entropy_profile(const char *path, unsigned long long window, unsigned long long step,
+                             double *out, unsigned long long capacity) {
+    if (!path || window == 0 || step == 0) return -1;
+    try {
+        MappedFile file;
+        if (!file.open(path)) return -1;
+        const std::vector<double> profile = ByteHistogram::entropyProfile(file.data(), file.size(), window, step);
+        const size_t n = profile.size() < capacity ? profile.size() : size_t(capacity);
+        if (out && n) memcpy(out, profile.data(), n * sizeof(double));
+        return (long long)profile.size();
+    } catch (...) {
+        return -1;
+    }
+}
+
+const char *sg_histogram_kernel(void) {
+    return ByteHistogram::kernelName(ByteHistogram::bestKernel());
+}
+
+struct sg_matcher {
+    PatternMatcher matcher;
+};
+
+sg_matcher *sg_matcher_create(const char *const *patterns, const unsigned long long *lengths, int count,
+                              int syntax) {
+    if (!patterns || count <= 0) return nullptr;
+    try {
+        std::vector<std::string> list;
+        for (int i = 0; i < count; ++i) {
+            if (!patterns[i]) return nullptr;
+            list.push_back(lengths ? std::string(patterns[i], size_t(lengths[i])) : std::string(patterns[i]));
+        }
+        sg_matcher *m = new sg_matcher{
+            PatternMatcher(list, syntax == SG_MATCH_REGEX ? PatternMatcher::Regex : PatternMatcher::Literal)};
+        if (!m->matcher.isValid()) {
+            delete m;
+            return nullptr;
+        }
+        return m;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void sg_matcher_free(sg_matcher *matcher) {
+    delete matcher;
+}
+
+long long sg_matcher_scan(const sg_matcher *matcher, const void *data, unsigned long long len, sg_match *out,
+                          unsigned long long capacity, int first_only) {
+    if (!matcher || (!data && len)) return -1;
+    unsigned long long found = 0;
+    matcher->matcher.scan(static_cast<const uint8_t *>(data), size_t(len),
+                          [&](const PatternMatcher::Hit &hit) {
+                              if (out && found < capacity) out[found] = {hit.pattern, hit.offset};
+                              ++found;
+                              return !first_only;
+                          });
+    return (long long)found;
+}
+
+long long sg_matcher_scan_file(const sg_matcher *matcher, const char *path, sg_match *out,
+                               unsigned long long capacity, int first_only) {
+    if (!matcher || !path) return -1;
+    MappedFile file;
+    if (!file.open(path)) return -1;
+    // Block by block, so a multi-GB file never becomes resident at once; the
+    // stream's history catches matches that straddle two blocks
+    PatternMatcher::Stream stream;
+    unsigned long long found = 0;
+    file.forEachBlock(FeatureExtractor::kBlockSize, [&](const uint8_t *block, size_t len, size_t) {
+        return matcher->matcher.scan(stream, block, len, [&](const PatternMatcher::Hit &hit) {
+            if (out && found < capacity) out[found] = {hit.pattern, hit.offset};
+            ++found;
+            return !first_only;
+        });
+    });
+    return (long long)found;
+}
+
+struct sg_cache {
+    VerdictCache cache;
+};
+
+sg_cache *sg_cache_open(const char *path, const char *version, unsigned long long max_bytes,
+                        unsigned int max_entries) {
+    if (!path || !version) return nullptr;
+    try {
+        sg_cache *c = new sg_cache;
+        VerdictCache::Limits limits;
+        limits.maxBytes = max_bytes;
+        limits.maxEntries = max_entries;
+        if (!c->cache.open(path, version, limits)) {
+            delete c;
+            return nullptr;
+        }
+        return c;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void sg_cache_close(sg_cache *cache) {
+    delete cache;
+}
+
+char *sg_cache_get(sg_cache *cache, const char *sha256_hex, unsigned long long *len) {
+    uint8_t key[VerdictCache::kKeyBytes];
+    if (!cache || !sha256_hex || !VerdictCache::parseKey(sha256_hex, key)) return nullptr;
+    try {
+        std::string value;
+        if (!cache->cache.get(key, value)) return nullptr;
+        if (len) *len = value.size();
+        return copyOut(value);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+int sg_cache_put(sg_cache *cache, const char *sha256_hex, const char *value, unsigned long long len) {
+    uint8_t key[VerdictCache::kKeyBytes];
+    if (!cache || !sha256_hex || !value || !VerdictCache::parseKey(sha256_hex, key)) return -1;
+    try {
+        return cache->cache.put(key, std::string(value, size_t(len))) ? 0 : -1;
+    } catch (...) {
+        return -1;
+    }
+}
+
+void sg_cache_clear(sg_cache *cache) {
+    if (cache) cache->cache.clear();
+}
+
+int sg_cache_stats_get(sg_cache *cache, sg_cache_stats *out) {
+    if (!cache || !out) return -1;
+    const VerdictCache::Stats s = cache->cache.stats();
+    out->entries = s.entries;
+    out->max_entries = s.maxEntries;
+    out->value_bytes = s.valueBytes;
+    out->heap_bytes = s.heapBytes;
+    out->hits = s.hits;
+    out->misses = s.misses;
+    out->insertions = s.insertions;
+    out->evictions = s.evictions;
+    return 0;
+}
+
+int sg_similarity_distance(const char *digest_a, const char *digest_b) {
+    SimilarityDigest::Digest a, b;
+    if (!digest_a || !digest_b) return -1;
+    if (!SimilarityDigest::parseHex(digest_a, a) || !SimilarityDigest::parseHex(digest_b, b)) return -1;
+    return SimilarityDigest::distance(a, b);
+}
+
+struct sg_similarity_index {
+    explicit sg_similarity_index(size_t capacity) : index(capacity) {}
+    SimilarityIndex index;
+};
+
+sg_similarity_index *sg_similarity_index_create(unsigned long long capacity) {
+    try {
+        return new sg_similarity_index(size_t(capacity));
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void sg_similarity_index_free(sg_similarity_index *index) {
+    delete index;
+}
+
+int sg_similarity_index_add(sg_similarity_index *index, const char *digest, long long id) {
+    SimilarityDigest::Digest d;
+    if (!index || !digest || !SimilarityDigest::parseHex(digest, d)) return -1;
+    try {
+        index->index.add(d, id);
+        return 0;
+    } catch (...) {
+        return -1;
+    }
+}
+
+int sg_similarity_index_query(sg_similarity_index *index, const char *digest, int max_distance,
+                              sg_similarity_match *out, int capacity) {
+    SimilarityDigest::Digest d;
+    if (!index || !digest || !SimilarityDigest::parseHex(digest, d) || capacity < 0 || (capacity && !out)) return -1;
+    try {
+        const std::vector<SimilarityIndex::Match> matches = index->index.query(d, size_t(capacity), max_distance);
+        for (size_t i = 0; i < matches.size(); ++i) {
+            out[i].id = matches[i].id;
+            out[i].distance = matches[i].distance;
+        }
+        return int(matches.size());
+    } catch (...) {
+        return -1;
+    }
+}
+
+int sg_similarity_index_stats_get(sg_similarity_index *index, sg_similarity_stats *out) {
+    if (!index || !out) return -1;
+    const SimilarityIndex::Stats s = index->index.stats();
+    out->entries = s.entries;
+    out->capacity = s.capacity;
+    out->additions = s.additions;
+    out->queries = s.queries;
+    return 0;
+}
+
+struct sg_allowlist {
+    Allowlist list;
+};
+
+sg_allowlist *sg_allowlist_open(const char *path) {
+    if (!path) return nullptr;
+    try {
+        sg_allowlist *a = new sg_allowlist;
+        if (!a->list.open(path)) {
+            delete a;
+            return nullptr;
+        }
+        return a;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void sg_allowlist_close(sg_allowlist *allowlist) {
+    delete allowlist;
+}
+
+int sg_allowlist_contains(const sg_allowlist *allowlist, const char *sha256_hex) {
+    if (!allowlist || !sha256_hex || strlen(sha256_hex) != 2 * Allowlist::kKeyBytes) return -1;
+    return allowlist->list.containsHex(sha256_hex) ? 1 : 0;
+}
+
+int sg_allowlist_stats_get(const sg_allowlist *allowlist, sg_allowlist_stats *out) {
+    if (!allowlist || !out) return -1;
+    const Allowlist::Stats s = allowlist->list.stats();
+    out->entries = s.entries;
+    out->bloom_bytes = s.bloomBytes;
+    out->lookups = s.lookups;
+    out->bloom_rejects = s.bloomRejects;
+    out->hits = s.hits;
+    return 0;
+}
+
+struct sg_rules {
+    std::shared_ptr<const RuleSet> set;
+};
+
+sg_rules *sg_rules_compile(const char *source, char **error) {
+    if (error) *error = nullptr;
+    if (!source) return nullptr;
+    try {
+        std::string message;
+        std::shared_ptr<const RuleSet> set = RuleSet::compile(source, &message);
+        if (!set) {
+            if (error) *error = copyOut(message);
+            return nullptr;
+        }
+        return new sg_rules{set};
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void sg_rules_free(sg_rules *rules) {
+    delete rules;
+}
+
+int sg_rules_info_get(const sg_rules *rules, sg_rules_info *out) {
+    if (!rules || !out) return -1;
+    out->rules = rules->set->ruleCount();
+    out->strings = rules->set->stringCount();
+    const std::string &fingerprint = rules->set->fingerprint();
+    memset(out->fingerprint, 0, sizeof(out->fingerprint));
+    memcpy(out->fingerprint, fingerprint.data(), std::min(fingerprint.size(), sizeof(out->fingerprint) - 1));
+    return 0;
+}
+
+char *sg_extract_features_rules_json(const char *path, const sg_rules *rules, const char *mime,
+                                     const char *magic_type) {
+    if (!path || !rules) return nullptr;
+    try {
+        MappedFile file;
+        if (!file.open(path)) return nullptr;
+        FileFeatures features;
+        FeatureExtractor::extract(file, path, features, rules->set->patterns());
+        RuleSet::Externals externals;
+        externals.mime = mime ? mime : "";
+        externals.magicType = magic_type ? magic_type : "";
+        std::string json = FeatureExtractor::toJson(features);
+        json.pop_back(); // the closing brace
+        json += ", \"rules\": " + RuleSet::toJson(rules->set->evaluate(features, externals)) + "}";
+        return copyOut(json);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void sg_free(char *ptr) {
+    free(ptr);
+}
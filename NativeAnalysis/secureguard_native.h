@@ -0,0 +1,171 @@
+#ifndef SECUREGUARD_NATIVE_H
+#define SECUREGUARD_NATIVE_H
+
+/* C ABI of the NativeAnalysis library, for ctypes and other FFI callers.
+ * Strings returned by the library are owned by the caller and must be
+ * released with sg_free(). */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#define SG_NATIVE_API __declspec(dllexport)
+#else
+#define SG_NATIVE_API __attribute__((visibility("default")))
+#endif
+
+/* Bumped whenever a function is added or a result changes shape */
+#define SG_NATIVE_ABI_VERSION 8
+
+SG_NATIVE_API int sg_abi_version(void);
+
+/* extract_file_features()-style JSON for the file at `path` (UTF-8), or
+ * NULL if it cannot be read. */
+SG_NATIVE_API char *sg_extract_features_json(const char *path);
+
+/* Shannon entropy of the whole file in bits per byte. Returns 0 on
+ * success, -1 if the file cannot be read. */
+SG_NATIVE_API int sg_file_entropy(const char *path, double *entropy);
+
+/* Entropy of each `window`-byte window, advancing `step` bytes at a time.
+ * Writes up to `capacity` values to `out` and returns how many windows the
+ * file has (which may exceed capacity), or -1 on error. */
+SG_NATIVE_API long long sg_entropy_profile(const char *path, unsigned long long window,
+                                           unsigned long long step, double *out,
+                                           unsigned long long capacity);
+
+/* Name of the histogram kernel in use: "avx2", "sse2" or "scalar" */
+SG_NATIVE_API const char *sg_histogram_kernel(void);
+
+/* Multi-pattern matcher: every pattern is found in one pass, ASCII
+ * case-insensitively. With SG_MATCH_REGEX patterns use predict.py's regex
+ * subset ('\\' escapes, unescaped '.' is any byte but '\n'). */
+typedef struct sg_matcher sg_matcher;
+
+typedef struct sg_match {
+    unsigned int pattern;      /* index into the patterns given at creation */
+    unsigned long long offset; /* where the match starts */
+} sg_match;
+
+#define SG_MATCH_LITERAL 0
+#define SG_MATCH_REGEX 1
+
+/* `lengths` may be NULL for NUL-terminated patterns. Returns NULL if a
+ * pattern is empty or ends in a wildcard. */
+SG_NATIVE_API sg_matcher *sg_matcher_create(const char *const *patterns, const unsigned long long *lengths,
+                                            int count, int syntax);
+SG_NATIVE_API void sg_matcher_free(sg_matcher *matcher);
+
+/* Scan a buffer or a file. Writes up to `capacity` hits to `out`, in input
+ * order, and returns the total number found (which may exceed capacity),
+ * or -1 on error. With `first_only` the scan stops at the first hit. */
+SG_NATIVE_API long long sg_matcher_scan(const sg_matcher *matcher, const void *data, unsigned long long len,
+                                        sg_match *out, unsigned long long capacity, int first_only);
+SG_NATIVE_API long long sg_matcher_scan_file(const sg_matcher *matcher, const char *path, sg_match *out,
+                                             unsigned long long capacity, int first_only);
+
+/* Persistent verdict cache keyed by SHA-256 (VerdictCache.h). A file made
+ * for another `version` or other limits is wiped on open. NULL if the file
+ * cannot be opened or another process holds it. */
+typedef struct sg_cache sg_cache;
+
+typedef struct sg_cache_stats {
+    unsigned int entries;
+    unsigned int max_entries;
+    unsigned long long value_bytes;
+    unsigned long long heap_bytes;
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long insertions;
+    unsigned long long evictions;
+} sg_cache_stats;
+
+SG_NATIVE_API sg_cache *sg_cache_open(const char *path, const char *version, unsigned long long max_bytes,
+                                      unsigned int max_entries);
+SG_NATIVE_API void sg_cache_close(sg_cache *cache);
+/* The stored value for a hex SHA-256 (free with sg_free), or NULL on a miss */
+SG_NATIVE_API char *sg_cache_get(sg_cache *cache, const char *sha256_hex, unsigned long long *len);
+/* 0 if stored, -1 if the key is malformed or the value is too large */
+SG_NATIVE_API int sg_cache_put(sg_cache *cache, const char *sha256_hex, const char *value,
+                               unsigned long long len);
+SG_NATIVE_API void sg_cache_clear(sg_cache *cache);
+SG_NATIVE_API int sg_cache_stats_get(sg_cache *cache, sg_cache_stats *out);
+
+/* Nearest neighbours by similarity digest (SimilarityIndex.h). Digests are
+ * the "similarity_digest" hex strings of sg_extract_features_json; ids are
+ * the caller's. Holds the last `capacity` digests. */
+typedef struct sg_similarity_index sg_similarity_index;
+
+typedef struct sg_similarity_match {
+    long long id;
+    int distance; /* 0 = same digest; under ~100 is usually a variant */
+} sg_similarity_match;
+
+typedef struct sg_similarity_stats {
+    unsigned long long entries;
+    unsigned long long capacity;
+    unsigned long long additions;
+    unsigned long long queries;
+} sg_similarity_stats;
+
+/* Distance between two digests, or -1 if either is malformed */
+SG_NATIVE_API int sg_similarity_distance(const char *digest_a, const char *digest_b);
+SG_NATIVE_API sg_similarity_index *sg_similarity_index_create(unsigned long long capacity);
+SG_NATIVE_API void sg_similarity_index_free(sg_similarity_index *index);
+/* 0 if added, -1 if the digest is malformed */
+SG_NATIVE_API int sg_similarity_index_add(sg_similarity_index *index, const char *digest, long long id);
+/* Writes up to `capacity` entries within `max_distance` to `out`, closest
+ * first, and returns how many; -1 if the digest is malformed */
+SG_NATIVE_API int sg_similarity_index_query(sg_similarity_index *index, const char *digest, int max_distance,
+                                            sg_similarity_match *out, int capacity);
+SG_NATIVE_API int sg_similarity_index_stats_get(sg_similarity_index *index, sg_similarity_stats *out);
+
+/* Known-good SHA-256 allowlist (Allowlist.h), memory-mapped read-only.
+ * NULL if the file is missing or not an allowlist. */
+typedef struct sg_allowlist sg_allowlist;
+
+typedef struct sg_allowlist_stats {
+    unsigned long long entries;
+    unsigned long long bloom_bytes;
+    unsigned long long lookups;
+    unsigned long long bloom_rejects; /* answered by the Bloom filter alone */
+    unsigned long long hits;
+} sg_allowlist_stats;
+
+SG_NATIVE_API sg_allowlist *sg_allowlist_open(const char *path);
+SG_NATIVE_API void sg_allowlist_close(sg_allowlist *allowlist);
+/* 1 if the hex SHA-256 is listed, 0 if not, -1 if it is malformed */
+SG_NATIVE_API int sg_allowlist_contains(const sg_allowlist *allowlist, const char *sha256_hex);
+SG_NATIVE_API int sg_allowlist_stats_get(const sg_allowlist *allowlist, sg_allowlist_stats *out);
+
+/* Detection rules (RuleSet.h), compiled once and read-only afterwards, so
+ * one handle may serve several threads. */
+typedef struct sg_rules sg_rules;
+
+typedef struct sg_rules_info {
+    unsigned long long rules;
+    unsigned long long strings;
+    char fingerprint[65]; /* hex SHA-256 of the source */
+} sg_rules_info;
+
+/* NULL on a syntax error, described in *error (free with sg_free) when
+ * `error` is not NULL */
+SG_NATIVE_API sg_rules *sg_rules_compile(const char *source, char **error);
+SG_NATIVE_API void sg_rules_free(sg_rules *rules);
+SG_NATIVE_API int sg_rules_info_get(const sg_rules *rules, sg_rules_info *out);
+
+/* sg_extract_features_json plus a "rules" key with RuleSet::toJson of the
+ * rules that match; the rules' strings are searched in the same pass.
+ * `mime` and `magic_type` (may be NULL) are the caller's MIME guess and
+ * libmagic description. */
+SG_NATIVE_API char *sg_extract_features_rules_json(const char *path, const sg_rules *rules, const char *mime,
+                                                   const char *magic_type);
+
+SG_NATIVE_API void sg_free(char *ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SECUREGUARD_NATIVE_H */
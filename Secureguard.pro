@@ -1,4 +1,4 @@
-QT += core gui widgets network
+QT += core gui widgets network concurrent
 
 TARGET = SecureGuard
 TEMPLATE = app
@@ -6,9 +6,20 @@ TEMPLATE = app
 SOURCES += \
     SecureGuard.cpp \
     MainWindow.cpp \
-    ExecutableMonitorPage.cpp
+    ExecutableMonitorPage.cpp \
+    ExecEventStream.cpp \
+    DetectedFilesModel.cpp \
+    ExecSearchIndex.cpp \
+    ExecUpdateQueue.cpp \
+    ExecFeedCodec.cpp
 
 HEADERS += \
     MainWindow.h \
-    ExecutableMonitorPage.h
+    ExecutableMonitorPage.h \
+    ExecEventStream.h \
+    DetectedFilesModel.h \
+    ExecSearchIndex.h \
+    ExecUpdateQueue.h \
+    ExecFeedCodec.h \
+    ExecFeedKeys.h
 
@@ -1,4 +1,5 @@
-from fastapi import FastAPI
+from fastapi import FastAPI, HTTPException, Query, Request
+from fastapi.responses import Response
 from fastapi.middleware.cors import CORSMiddleware
 from pydantic import BaseModel
 import uvicorn
@@ -7,6 +8,21 @@ import numpy as np
 from feature_extr import FeatureExtraction
 import os, sys, importlib
 
+try:
+    import cbor2
+except ImportError:
+    cbor2 = None
+
+CBOR_MEDIA_TYPE = "application/cbor"
+
+# Ensure ExecutableMonitor modules are importable (history store, watcher)
+BASE_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+EM_DIR = os.path.join(BASE_DIR, "ExecutableMonitor")
+if EM_DIR not in sys.path:
+    sys.path.append(EM_DIR)
+
+from scan_store import UrlHistory
+
 
 app = FastAPI()
 app.add_middleware(
@@ -21,13 +37,16 @@ app.add_middleware(
 # Load phishing detection model (GradientBoostingClassifier)
 phishing_model = pickle.load(open("gbc_final_model.pkl", "rb"))
 
+# Every verdict is kept, so the GUI's scan results survive a restart
+url_history = UrlHistory()
+
 
 class UrlPayload(BaseModel):
     url: str
 
 
 @app.post("/analyze_url")
-def analyze_url(payload: UrlPayload):
+def analyze_url(payload: UrlPayload, request: Request):
     url = payload.url
 
     # Extract up to 30 features for the URL
@@ -96,63 +115,69 @@ def analyze_url(payload: UrlPayload):
         classification = "Phishing"
         conclusion = "⚠️ Caution: The URL you entered has been identified as a phishing website. Phishing websites are designed to steal sensitive information such as login credentials, credit card details, or personal data. It is strongly recommended that you do not enter any personal information on this site and avoid interacting with it."
 
+    url_history.add(url, classification, {
+        "features": [None if f is None else int(f) for f in features],
+        "conclusion": conclusion,
+    })
+
+    # CBOR clients get a compact form: factor names with raw values, from
+    # which they derive the description text themselves.
+    if cbor2 is not None and CBOR_MEDIA_TYPE in request.headers.get("accept", ""):
+        compact = {
+            "classification": classification,
+            "conclusion": conclusion,
+            "factors": [[FEATURE_INFO[i][0], None if features[i] is None else int(features[i])]
+                        for i in range(max_features)],
+        }
+        return Response(content=cbor2.dumps(compact), media_type=CBOR_MEDIA_TYPE)
+
     return {
         "classification": classification,
         "features_table": feature_descriptions,
         "conclusion": conclusion,
     }
 
+
+@app.get("/api/urls")
+def api_urls(limit: int = Query(50, ge=1), before: int = Query(None, ge=1), classification: str = Query(None)):
+    """Past scans, newest first: {"urls": [{"id", "url", "classification",
+    "scanned"}], "next"}; pass next as before for older ones."""
+    return url_history.page(limit, before, classification)
+
+
+@app.get("/api/urls/{scan_id}")
+def api_url(scan_id: int):
+    scan = url_history.get(scan_id)
+    if scan is None:
+        raise HTTPException(status_code=404, detail="no such scan")
+    return scan
+
 # -------------------------
 # Executable Monitor wiring
 # -------------------------
 
-# Ensure ExecutableMonitor module is importable
-BASE_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
-EM_DIR = os.path.join(BASE_DIR, "ExecutableMonitor")
-if EM_DIR not in sys.path:
-    sys.path.append(EM_DIR)
-
 try:
     em = importlib.import_module("server")
 except Exception as e:
     em = None
 
-@app.get("/api/files")
-def api_files():
-    if em is None:
+# Serve the watcher's routes (/api/files, /api/events, /api/status) and its
+# startup/shutdown hooks from this process, so the GUI needs only one port.
+if em is not None:
+    app.include_router(em.app.router)
+else:
+    @app.get("/api/files")
+    def api_files():
         return []
-    return em.analyzed_files
 
-@app.get("/api/status")
-def api_status():
-    if em is None:
-        return {"monitoring": False, "watched_dir": None, "gemini_enabled": False, "file_count": 0}
-    api_key = os.getenv("GEMINI_API_KEY")
-    return {
-        "monitoring": True,
-        "watched_dir": getattr(em, "WATCHED_DIR", None),
-        "gemini_enabled": bool(api_key) and api_key != "your_api_key_here",
-        "file_count": len(getattr(em, "analyzed_files", [])),
-    }
-
-@app.on_event("startup")
-def start_exec_monitor():
-    if em is not None:
-        try:
-            em.start_monitoring()
-        except Exception:
-            pass
+    @app.get("/api/files/page")
+    def api_files_page():
+        return {"epoch": None, "cursor": 0, "files": [], "next": None, "total": 0}
 
-@app.on_event("shutdown")
-def stop_exec_monitor():
-    if em is not None:
-        try:
-            em.stop_monitoring()
-        except Exception:
-            pass
+    @app.get("/api/status")
+    def api_status():
+        return {"monitoring": False, "watched_dir": None, "gemini_enabled": False, "file_count": 0}
 
 
 if __name__ == "__main__":
     uvicorn.run(app, host="0.0.0.0", port=8000)
-
-
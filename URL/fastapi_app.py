@@ -1,4 +1,5 @@
-from fastapi import FastAPI
+from fastapi import FastAPI, Request
+from fastapi.responses import Response
 from fastapi.middleware.cors import CORSMiddleware
 from pydantic import BaseModel
 import uvicorn
@@ -6,6 +7,13 @@ import pickle
 import numpy as np
 from feature_extr import FeatureExtraction
 
+try:
+    import cbor2
+except ImportError:
+    cbor2 = None
+
+CBOR_MEDIA_TYPE = "application/cbor"
+
 
 app = FastAPI()
 app.add_middleware(
@@ -26,7 +34,7 @@ class UrlPayload(BaseModel):
 
 
 @app.post("/analyze_url")
-def analyze_url(payload: UrlPayload):
+def analyze_url(payload: UrlPayload, request: Request):
     url = payload.url
 
     # Extract up to 30 features for the URL
@@ -95,6 +103,17 @@ def analyze_url(payload: UrlPayload):
         classification = "Phishing"
         conclusion = "⚠️ Caution: The URL you entered has been identified as a phishing website. Phishing websites are designed to steal sensitive information such as login credentials, credit card details, or personal data. It is strongly recommended that you do not enter any personal information on this site and avoid interacting with it."
 
+    # CBOR clients get a compact form: factor names with raw values, from
+    # which they derive the description text themselves.
+    if cbor2 is not None and CBOR_MEDIA_TYPE in request.headers.get("accept", ""):
+        compact = {
+            "classification": classification,
+            "conclusion": conclusion,
+            "factors": [[FEATURE_INFO[i][0], None if features[i] is None else int(features[i])]
+                        for i in range(max_features)],
+        }
+        return Response(content=cbor2.dumps(compact), media_type=CBOR_MEDIA_TYPE)
+
     return {
         "classification": classification,
         "features_table": feature_descriptions,
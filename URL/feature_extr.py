@@ -13,14 +13,93 @@ from datetime import date, datetime
 import time
 from dateutil.parser import parse as date_parse
 from urllib.parse import urlparse
+import inspect
+import threading
+from concurrent.futures import Future, TimeoutError as LookupTimeout
 
 from urllib3.util import url
 
+try:
+    import dns.exception
+    import dns.resolver  # dnspython: DNS with a timeout
+except ImportError:
+    dns = None
+
+
+# External lookups a scan needs, each started at once and given its own
+# deadline (seconds), so a scan waits for the slowest of them at most.
+# Features that need a lookup which missed its deadline are NEUTRAL
+# instead of stalling the scan; a lookup that fails outright still counts
+# against the URL, as before. Every lookup is handed its deadline as the
+# library's own timeout, so it also gives up by then.
+def fetch_page(url, timeout):
+    return requests.get(url, timeout=timeout)
+
+
+# python-whois takes a socket timeout from 0.9 on; older versions block
+_WHOIS_TIMEOUT = 'timeout' in inspect.signature(whois.whois).parameters
+
+
+def lookup_whois(domain, timeout):
+    if _WHOIS_TIMEOUT:
+        return whois.whois(domain, timeout=timeout)
+    return whois.whois(domain)
+
+
+def resolve(domain, timeout):
+    try:
+        return str(ipaddress.ip_address(domain))
+    except ValueError:
+        pass
+    if dns is None:
+        return socket.gethostbyname(domain)  # no timeout without dnspython
+    try:
+        return dns.resolver.resolve(domain, 'A', lifetime=timeout)[0].to_text()
+    except dns.exception.Timeout:
+        raise socket.timeout(f"no DNS answer for {domain} within {timeout:g} s")
+
+
+def check_page_rank(domain, timeout):
+    return requests.post("https://www.checkpagerank.net/index.php", {"name": domain}, timeout=timeout)
+
+
+def alexa_rank(url, timeout):
+    return urllib.request.urlopen("http://data.alexa.com/data?cli=10&dat=s&url=" + url, timeout=timeout).read()
+
+
+LOOKUPS = {
+    'page': fetch_page,
+    'whois': lookup_whois,
+    'dns': resolve,
+    'rank': check_page_rank,
+    'traffic': alexa_rank,
+}
+DEADLINES = {'page': 1.5, 'whois': 1.5, 'dns': 1.0, 'rank': 1.0, 'traffic': 1.0}
+NEUTRAL = 0  # "no strong indication" either way
+
+
+def start_lookup(name, lookup, arg, timeout):
+    """Runs lookup(arg, timeout) on a thread of its own. Not a shared pool:
+    a lookup that overruns its timeout anyway (an old python-whois, DNS
+    without dnspython) then holds only its own thread, never the lookups
+    of later scans."""
+    future = Future()
+
+    def run():
+        future.set_running_or_notify_cancel()
+        try:
+            future.set_result(lookup(arg, timeout))
+        except BaseException as e:
+            future.set_exception(e)
+
+    threading.Thread(target=run, name=f"url-lookup-{name}", daemon=True).start()
+    return future
+
 
 class FeatureExtraction:
     features = []
 
-    def __init__(self, url):
+    def __init__(self, url, deadlines=None):
         self.features = []
         self.url = url
         self.domain = ""
@@ -28,12 +107,7 @@ class FeatureExtraction:
         self.urlparse = ""
         self.response = ""
         self.soup = ""
-
-        try:
-            self.response = requests.get(url)
-            self.soup = BeautifulSoup(response.text, 'html.parser')
-        except:
-            pass
+        self.timed_out = set()  # lookups that missed their deadline
 
         try:
             self.urlparse = urlparse(url)
@@ -41,8 +115,11 @@ class FeatureExtraction:
         except:
             pass
 
+        self.lookups = self.run_lookups(deadlines or DEADLINES)
+        self.whois_response = self.lookups.get('whois', "")
         try:
-            self.whois_response = whois.whois(self.domain)
+            self.response = self.lookups['page']
+            self.soup = BeautifulSoup(self.response.text, 'html.parser')
         except:
             pass
 
@@ -54,30 +131,54 @@ class FeatureExtraction:
         self.features.append(self.prefixSuffix())
         self.features.append(self.SubDomains())
         self.features.append(self.Https())
-        self.features.append(self.DomainRegLen())
-        self.features.append(self.Favicon())
+        self.features.append(self.feature(self.DomainRegLen, 'whois'))
+        self.features.append(self.feature(self.Favicon, 'page'))
 
         self.features.append(self.NonStdPort())
         self.features.append(self.HTTPSDomainURL())
-        self.features.append(self.RequestURL())
-        self.features.append(self.AnchorURL())
-        self.features.append(self.LinksInScriptTags())
-        self.features.append(self.ServerFormHandler())
-        self.features.append(self.InfoEmail())
-        self.features.append(self.AbnormalURL())
-        self.features.append(self.WebsiteForwarding())
-        self.features.append(self.StatusBarCust())
-
-        self.features.append(self.DisableRightClick())
-        self.features.append(self.UsingPopupWindow())
-        self.features.append(self.IframeRedirection())
-        self.features.append(self.AgeofDomain())
-        self.features.append(self.DNSRecording())
-        self.features.append(self.WebsiteTraffic())
-        self.features.append(self.PageRank())
+        self.features.append(self.feature(self.RequestURL, 'page'))
+        self.features.append(self.feature(self.AnchorURL, 'page'))
+        self.features.append(self.feature(self.LinksInScriptTags, 'page'))
+        self.features.append(self.feature(self.ServerFormHandler, 'page'))
+        self.features.append(self.feature(self.InfoEmail, 'page'))
+        self.features.append(self.feature(self.AbnormalURL, 'page', 'whois'))
+        self.features.append(self.feature(self.WebsiteForwarding, 'page'))
+        self.features.append(self.feature(self.StatusBarCust, 'page'))
+
+        self.features.append(self.feature(self.DisableRightClick, 'page'))
+        self.features.append(self.feature(self.UsingPopupWindow, 'page'))
+        self.features.append(self.feature(self.IframeRedirection, 'page'))
+        self.features.append(self.feature(self.AgeofDomain, 'whois'))
+        self.features.append(self.feature(self.DNSRecording, 'whois'))
+        self.features.append(self.feature(self.WebsiteTraffic, 'traffic'))
+        self.features.append(self.feature(self.PageRank, 'rank'))
         self.features.append(self.GoogleIndex())
-        self.features.append(self.LinksPointingToPage())
-        self.features.append(self.StatsReport())
+        self.features.append(self.feature(self.LinksPointingToPage, 'page'))
+        self.features.append(self.feature(self.StatsReport, 'dns'))
+
+    def run_lookups(self, deadlines):
+        """Starts every lookup at once and collects each by its own deadline.
+        Returns {name: result} of those that answered in time; failures are
+        left out and timeouts noted in self.timed_out."""
+        args = {'page': self.url, 'whois': self.domain, 'dns': self.domain, 'rank': self.domain,
+                'traffic': self.url}
+        started = time.monotonic()
+        futures = {name: start_lookup(name, lookup, args[name], deadlines[name]) for name, lookup in LOOKUPS.items()}
+        results = {}
+        for name, future in futures.items():
+            try:
+                results[name] = future.result(max(0.0, started + deadlines[name] - time.monotonic()))
+            except (LookupTimeout, requests.Timeout, socket.timeout):
+                self.timed_out.add(name)
+            except Exception:
+                pass
+        return results
+
+    def feature(self, method, *lookups):
+        """method(), or NEUTRAL when a lookup it needs timed out."""
+        if self.timed_out.intersection(lookups):
+            return NEUTRAL
+        return method()
 
     # 1.UsingIp
     def UsingIp(self):
@@ -425,8 +526,7 @@ class FeatureExtraction:
     # 26. WebsiteTraffic
     def WebsiteTraffic(self):
         try:
-            rank = BeautifulSoup(urllib.request.urlopen("http://data.alexa.com/data?cli=10&dat=s&url=" + url).read(),
-                                 "xml").find("REACH")['RANK']
+            rank = BeautifulSoup(self.lookups['traffic'], "xml").find("REACH")['RANK']
             if (int(rank) < 100000):
                 return 1
             return 0
@@ -434,9 +534,9 @@ class FeatureExtraction:
             return -1
 
     # 27. PageRank
-    def PageRank(self, rank_checker_response=None):
+    def PageRank(self):
         try:
-            prank_checker_response = requests.post("https://www.checkpagerank.net/index.php", {"name": self.domain})
+            rank_checker_response = self.lookups['rank']
 
             global_rank = int(re.findall(r"Global Rank: ([0-9]+)", rank_checker_response.text)[0])
             if global_rank > 0 and global_rank < 100000:
@@ -448,6 +548,8 @@ class FeatureExtraction:
     # 28. GoogleIndex
     def GoogleIndex(self):
         try:
+            # search() is a lazy generator and is never iterated: no query is
+            # sent, and the value is always 1
             site = search(self.url, 5)
             if site:
                 return 1
@@ -474,8 +576,8 @@ class FeatureExtraction:
         try:
             url_match = re.search(
                 'at\.ua|usa\.cc|baltazarpresentes\.com\.br|pe\.hu|esy\.es|hol\.es|sweddy\.com|myjino\.ru|96\.lt|ow\.ly',
-                url)
-            ip_address = socket.gethostbyname(self.domain)
+                self.url)
+            ip_address = self.lookups['dns']
             ip_match = re.search(
                 '146\.112\.61\.108|213\.174\.157\.151|121\.50\.168\.88|192\.185\.217\.116|78\.46\.211\.158|181\.174\.165\.13|46\.242\.145\.103|121\.50\.168\.40|83\.125\.22\.219|46\.242\.145\.98|'
                 '107\.151\.148\.44|107\.151\.148\.107|64\.70\.19\.203|199\.184\.144\.27|107\.151\.148\.108|107\.151\.148\.109|119\.28\.52\.61|54\.83\.43\.69|52\.69\.166\.231|216\.58\.192\.225|'
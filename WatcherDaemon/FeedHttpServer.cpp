@@ -0,0 +1,385 @@
+#include "FeedHttpServer.h"
+#include "FileFeed.h"
+#include "../ExecFeedKeys.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+#include <QUrlQuery>
+#include <QJsonDocument>
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborValue>
+
+namespace {
+const int kMaxHeaderBytes = 16 * 1024;
+const int kKeepaliveMs = 15000;
+// A stream this far behind is cut; the client reconnects and catches up
+// through /api/files instead of us buffering without bound.
+const qint64 kMaxStreamBacklog = 4 * 1024 * 1024;
+const QByteArray kCborMediaType = "application/cbor";
+const QLatin1String kRecordPrefix("/api/files/");
+
+const char *reasonPhrase(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 422: return "Unprocessable Entity";
+    default: return "Error";
+    }
+}
+
+// Same transformation as wire_format.compact()
+QCborValue compact(const QJsonValue &value) {
+    static const QHash<QString, int> keyIds = [] {
+        QHash<QString, int> ids;
+        for (int i = 0; i < ExecFeedKeys::kCount; ++i) ids.insert(QString::fromLatin1(ExecFeedKeys::kNames[i]), i);
+        return ids;
+    }();
+
+    if (value.isObject()) {
+        QCborMap map;
+        const QJsonObject obj = value.toObject();
+        for (auto it = obj.constBegin(); it != obj.constEnd(); ++it) {
+            const int id = keyIds.value(it.key(), -1);
+            map.insert(id >= 0 ? QCborValue(id) : QCborValue(it.key()), compact(it.value()));
+        }
+        return map;
+    }
+    if (value.isArray()) {
+        QCborArray array;
+        for (const QJsonValue &v : value.toArray()) array.append(compact(v));
+        return array;
+    }
+    return QCborValue::fromJsonValue(value);
+}
+
+QByteArray sseEvent(const QByteArray &event, const QJsonObject &data, const QByteArray &id = QByteArray()) {
+    QByteArray out = "event: " + event + "\n";
+    if (!id.isEmpty()) out += "id: " + id + "\n";
+    out += "data: " + QJsonDocument(data).toJson(QJsonDocument::Compact) + "\n\n";
+    return out;
+}
+} // namespace
+
+FeedHttpServer::FeedHttpServer(FileFeed *feed, QObject *parent)
+    : QObject(parent), feed(feed), server(new QTcpServer(this)), keepaliveTimer(new QTimer(this)),
+      flushScheduled(false), queued(0), active(0), queueChanged(false)
+{
+    connect(server, &QTcpServer::newConnection, this, &FeedHttpServer::onNewConnection);
+    connect(feed, &FileFeed::changed, this, &FeedHttpServer::onFeedChanged);
+    connect(keepaliveTimer, &QTimer::timeout, this, &FeedHttpServer::sendKeepalives);
+    keepaliveTimer->start(kKeepaliveMs);
+}
+
+bool FeedHttpServer::listen(const QHostAddress &address, quint16 port) {
+    return server->listen(address, port);
+}
+
+QString FeedHttpServer::errorString() const {
+    return server->errorString();
+}
+
+void FeedHttpServer::onNewConnection() {
+    while (QTcpSocket *socket = server->nextPendingConnection()) {
+        requestBuffers.insert(socket, QByteArray());
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            requestBuffers.remove(socket);
+            streams.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void FeedHttpServer::onReadyRead(QTcpSocket *socket) {
+    auto it = requestBuffers.find(socket);
+    if (it == requestBuffers.end()) {
+        socket->readAll(); // request already handled; ignore anything else
+        return;
+    }
+    it->append(socket->readAll());
+    const qsizetype end = it->indexOf("\r\n\r\n");
+    if (end < 0) {
+        if (it->size() > kMaxHeaderBytes) {
+            requestBuffers.erase(it);
+            respond(socket, 400, "application/json", R"({"detail":"Request header too large"})");
+        }
+        return;
+    }
+
+    const QList<QByteArray> lines = it->left(end).split('\n');
+    requestBuffers.erase(it);
+
+    Request req;
+    const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    if (requestLine.size() < 2) {
+        respond(socket, 400, "application/json", R"({"detail":"Bad request line"})");
+        return;
+    }
+    req.method = requestLine.at(0);
+    req.target = requestLine.at(1);
+    for (qsizetype i = 1; i < lines.size(); ++i) {
+        const qsizetype colon = lines.at(i).indexOf(':');
+        if (colon <= 0) continue;
+        req.headers.insert(lines.at(i).left(colon).trimmed().toLower(), lines.at(i).mid(colon + 1).trimmed());
+    }
+    handle(socket, req);
+}
+
+void FeedHttpServer::handle(QTcpSocket *socket, const Request &req) {
+    if (req.method == "OPTIONS") {
+        // CORS preflight, as FastAPI's middleware allows everything
+        respond(socket, 204, QByteArray(), QByteArray(),
+                {{"Access-Control-Allow-Methods", "GET, OPTIONS"}, {"Access-Control-Allow-Headers", "*"}});
+        return;
+    }
+    if (req.method != "GET") {
+        respond(socket, 405, "application/json", R"({"detail":"Method Not Allowed"})");
+        return;
+    }
+
+    const QString path = QUrl::fromEncoded(req.target).path();
+    if (path == "/api/files") serveFiles(socket, req);
+    else if (path == "/api/files/page") servePage(socket, req);
+    else if (path.startsWith(kRecordPrefix)) serveRecord(socket, req, path.mid(kRecordPrefix.size()));
+    else if (path == "/api/events") serveEvents(socket, req);
+    else if (path == "/api/status") serveStatus(socket);
+    else respond(socket, 404, "application/json", R"({"detail":"Not Found"})");
+}
+
+void FeedHttpServer::serveFiles(QTcpSocket *socket, const Request &req) {
+    const QUrlQuery query(QUrl::fromEncoded(req.target));
+    const bool cbor = req.headers.value("accept").contains(kCborMediaType);
+
+    // Legacy clients without a cursor still get the full array
+    if (!query.hasQueryItem("since")) {
+        const QJsonArray files = feed->allFiles();
+        if (cbor) respond(socket, 200, kCborMediaType, compact(files).toCbor());
+        else respond(socket, 200, "application/json", QJsonDocument(files).toJson(QJsonDocument::Compact));
+        return;
+    }
+
+    bool ok = false;
+    const qlonglong since = query.queryItemValue("since").toLongLong(&ok);
+    if (!ok || since < 0) {
+        respond(socket, 422, "application/json", R"({"detail":"since must be a non-negative integer"})");
+        return;
+    }
+
+    int limit = 0;
+    if (query.hasQueryItem("limit")) {
+        limit = query.queryItemValue("limit").toInt(&ok);
+        if (!ok || limit < 1) {
+            respond(socket, 422, "application/json", R"({"detail":"limit must be a positive integer"})");
+            return;
+        }
+    }
+
+    // A cursor from another run (or from the future) is meaningless; send a
+    // full snapshot and tell the client to drop its cache. A client that
+    // passes limit pages through history instead: it gets the reset with no
+    // records, also when more than limit records changed.
+    bool reset = query.queryItemValue("epoch") != feed->epoch() || quint64(since) > feed->cursor();
+    if (!reset && limit && feed->changedCountSince(quint64(since)) > limit) reset = true;
+    const quint64 cursor = feed->cursor();
+    QJsonArray delta;
+    if (!reset || !limit) {
+        for (const QJsonObject &record : feed->changedSince(reset ? 0 : quint64(since))) delta.append(record);
+    }
+
+    const QList<QPair<QByteArray, QByteArray>> headers = {
+        {"X-Feed-Epoch", feed->epoch().toLatin1()},
+        {"X-Feed-Cursor", QByteArray::number(cursor)},
+        {"X-Feed-Reset", reset ? "1" : "0"},
+    };
+    if (cbor) {
+        respond(socket, 200, kCborMediaType, compact(delta).toCbor(), headers);
+        return;
+    }
+    QJsonObject envelope;
+    envelope.insert("epoch", feed->epoch());
+    envelope.insert("cursor", qint64(cursor));
+    envelope.insert("reset", reset);
+    envelope.insert("files", delta);
+    respond(socket, 200, "application/json", QJsonDocument(envelope).toJson(QJsonDocument::Compact), headers);
+}
+
+void FeedHttpServer::servePage(QTcpSocket *socket, const Request &req) {
+    const QUrlQuery query(QUrl::fromEncoded(req.target));
+    FileFeed::PageQuery pageQuery;
+    bool ok = true;
+    if (query.hasQueryItem("limit")) pageQuery.limit = query.queryItemValue("limit").toInt(&ok);
+    if (!ok || pageQuery.limit < 1) {
+        respond(socket, 422, "application/json", R"({"detail":"limit must be a positive integer"})");
+        return;
+    }
+    const QString order = query.queryItemValue("order");
+    if (!order.isEmpty() && order != "asc" && order != "desc") {
+        respond(socket, 400, "application/json", R"({"detail":"order must be asc or desc"})");
+        return;
+    }
+    pageQuery.descending = order != "asc";
+    pageQuery.cursor = query.queryItemValue("cursor");
+    if (query.hasQueryItem("sort")) pageQuery.sort = query.queryItemValue("sort");
+    pageQuery.type = query.queryItemValue("type");
+    pageQuery.summary = query.queryItemValue("summary") != "false";
+
+    FileFeed::Page page;
+    QString error;
+    if (!feed->page(pageQuery, page, &error)) {
+        QJsonObject detail;
+        detail.insert("detail", error);
+        respond(socket, 400, "application/json", QJsonDocument(detail).toJson(QJsonDocument::Compact));
+        return;
+    }
+    const QList<QPair<QByteArray, QByteArray>> headers = {
+        {"X-Feed-Epoch", feed->epoch().toLatin1()},
+        {"X-Feed-Cursor", QByteArray::number(feed->cursor())},
+        {"X-Page-Next", page.next.toLatin1()},
+        {"X-Page-Total", QByteArray::number(page.total)},
+    };
+    if (req.headers.value("accept").contains(kCborMediaType)) {
+        respond(socket, 200, kCborMediaType, compact(page.files).toCbor(), headers);
+        return;
+    }
+    QJsonObject envelope;
+    envelope.insert("epoch", feed->epoch());
+    envelope.insert("cursor", qint64(feed->cursor()));
+    envelope.insert("files", page.files);
+    envelope.insert("next", page.next.isEmpty() ? QJsonValue() : QJsonValue(page.next));
+    envelope.insert("total", page.total);
+    respond(socket, 200, "application/json", QJsonDocument(envelope).toJson(QJsonDocument::Compact), headers);
+}
+
+void FeedHttpServer::serveRecord(QTcpSocket *socket, const Request &req, const QString &id) {
+    bool ok = false;
+    const QJsonObject record = feed->record(id.toInt(&ok));
+    if (!ok) {
+        respond(socket, 422, "application/json", R"({"detail":"file id must be an integer"})");
+        return;
+    }
+    if (record.isEmpty()) {
+        respond(socket, 404, "application/json", R"({"detail":"no such file (or no longer kept)"})");
+        return;
+    }
+    if (req.headers.value("accept").contains(kCborMediaType)) {
+        respond(socket, 200, kCborMediaType, compact(record).toCbor());
+    } else {
+        respond(socket, 200, "application/json", QJsonDocument(record).toJson(QJsonDocument::Compact));
+    }
+}
+
+void FeedHttpServer::serveEvents(QTcpSocket *socket, const Request &req) {
+    // Resume point is "<epoch>:<seq>" from Last-Event-ID. With limit, a reset
+    // (or a gap of more than limit changes) replays nothing: the stream
+    // starts at the present and the client reloads its first page.
+    const QByteArray lastId = req.headers.value("last-event-id");
+    const qsizetype colon = lastId.indexOf(':');
+    bool ok = false;
+    quint64 since = colon > 0 ? lastId.mid(colon + 1).toULongLong(&ok) : 0;
+    const int limit = QUrlQuery(QUrl::fromEncoded(req.target)).queryItemValue("limit").toInt();
+    bool reset = !ok || QString::fromLatin1(lastId.left(colon)) != feed->epoch() || since > feed->cursor();
+    if (!reset && limit > 0 && feed->changedCountSince(since) > limit) reset = true;
+    if (reset) since = limit > 0 ? feed->cursor() : 0;
+
+    socket->write("HTTP/1.1 200 OK\r\n"
+                  "Content-Type: text/event-stream\r\n"
+                  "Cache-Control: no-cache\r\n"
+                  "Access-Control-Allow-Origin: *\r\n"
+                  "Connection: close\r\n\r\n");
+    QJsonObject hello;
+    hello.insert("epoch", feed->epoch());
+    hello.insert("reset", reset);
+    socket->write(sseEvent("hello", hello));
+    socket->write(queueEvent());
+    streams.insert(socket, since);
+    writeEvents(socket);
+}
+
+void FeedHttpServer::serveStatus(QTcpSocket *socket) {
+    QJsonObject status;
+    status.insert("monitoring", true);
+    status.insert("gemini_enabled", false);
+    status.insert("file_count", feed->fileCount());
+    status.insert("history", feed->stats());
+    if (statusProvider) {
+        const QJsonObject extra = statusProvider();
+        for (auto it = extra.constBegin(); it != extra.constEnd(); ++it) status.insert(it.key(), it.value());
+    }
+    respond(socket, 200, "application/json", QJsonDocument(status).toJson(QJsonDocument::Compact));
+}
+
+void FeedHttpServer::respond(QTcpSocket *socket, int status, const QByteArray &contentType, const QByteArray &body,
+                             const QList<QPair<QByteArray, QByteArray>> &extraHeaders) {
+    QByteArray head = "HTTP/1.1 " + QByteArray::number(status) + ' ' + reasonPhrase(status) + "\r\n";
+    if (!contentType.isEmpty()) head += "Content-Type: " + contentType + "\r\n";
+    head += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    head += "Access-Control-Allow-Origin: *\r\n";
+    for (const auto &h : extraHeaders) head += h.first + ": " + h.second + "\r\n";
+    head += "Connection: close\r\n\r\n";
+    socket->write(head);
+    socket->write(body);
+    socket->disconnectFromHost(); // waits for pending writes
+}
+
+void FeedHttpServer::setQueueDepth(int queuedCount, int activeCount) {
+    if (queuedCount == queued && activeCount == active) return;
+    queued = queuedCount;
+    active = activeCount;
+    queueChanged = true;
+    scheduleFlush();
+}
+
+QByteArray FeedHttpServer::queueEvent() const {
+    QJsonObject depth;
+    depth.insert("queued", queued);
+    depth.insert("active", active);
+    return sseEvent("queue", depth);
+}
+
+void FeedHttpServer::onFeedChanged() {
+    scheduleFlush();
+}
+
+void FeedHttpServer::scheduleFlush() {
+    if (flushScheduled || streams.isEmpty()) return;
+    flushScheduled = true;
+    QTimer::singleShot(0, this, &FeedHttpServer::flushStreams);
+}
+
+void FeedHttpServer::flushStreams() {
+    flushScheduled = false;
+    const QList<QTcpSocket *> sockets = streams.keys();
+    for (QTcpSocket *socket : sockets) writeEvents(socket);
+    // Only the latest depth matters, so a burst of changes sends one event
+    if (queueChanged) {
+        queueChanged = false;
+        const QByteArray event = queueEvent();
+        for (auto it = streams.constBegin(); it != streams.constEnd(); ++it) it.key()->write(event);
+    }
+}
+
+void FeedHttpServer::writeEvents(QTcpSocket *socket) {
+    auto it = streams.find(socket);
+    if (it == streams.end()) return;
+    if (socket->bytesToWrite() > kMaxStreamBacklog) {
+        streams.erase(it);
+        socket->abort();
+        return;
+    }
+    const QByteArray epoch = feed->epoch().toLatin1();
+    QByteArray out;
+    for (const QJsonObject &record : feed->changedSince(*it)) {
+        out += sseEvent("file", record, epoch + ':' + QByteArray::number(record.value("seq").toInteger()));
+    }
+    *it = feed->cursor();
+    if (!out.isEmpty()) socket->write(out);
+}
+
+void FeedHttpServer::sendKeepalives() {
+    for (auto it = streams.constBegin(); it != streams.constEnd(); ++it) it.key()->write(": keepalive\n\n");
+}
@@ -0,0 +1,78 @@
+#ifndef FEEDHTTPSERVER_H
+#define FEEDHTTPSERVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QByteArray>
+#include <QHostAddress>
+#include <QJsonObject>
+#include <functional>
+
+class QTcpServer;
+class QTcpSocket;
+class QTimer;
+class FileFeed;
+
+// Minimal HTTP/1.1 front end for the daemon, serving the same endpoints as
+// ExecutableMonitor/server.py so the GUI can use either backend:
+//   GET /api/files[?since=&epoch=&limit=]  JSON, or compact CBOR on Accept
+//   GET /api/files/page?limit=&cursor=&sort=&order=&type=&summary=
+//                                   one page of history, by keyset cursor
+//   GET /api/files/<id>             one full record
+//   GET /api/events[?limit=]        Server-Sent Events, resumable, plus the
+//                                   analysis queue depth
+//   GET /api/status
+// Plain requests are answered and closed; event streams stay open and are
+// flushed at most once per event-loop pass however many records changed.
+class FeedHttpServer : public QObject {
+    Q_OBJECT
+public:
+    FeedHttpServer(FileFeed *feed, QObject *parent = nullptr);
+
+    bool listen(const QHostAddress &address, quint16 port);
+    QString errorString() const;
+    // Extra fields merged into /api/status
+    void setStatusProvider(std::function<QJsonObject()> provider) { statusProvider = std::move(provider); }
+    // Analysis backlog, sent to streams as a 'queue' event: once after hello
+    // and then whenever it changes
+    void setQueueDepth(int queued, int active);
+
+private slots:
+    void onNewConnection();
+    void onFeedChanged();
+    void flushStreams();
+    void sendKeepalives();
+
+private:
+    struct Request {
+        QByteArray method;
+        QByteArray target;
+        QHash<QByteArray, QByteArray> headers; // names lower-cased
+    };
+
+    void onReadyRead(QTcpSocket *socket);
+    void handle(QTcpSocket *socket, const Request &req);
+    void serveFiles(QTcpSocket *socket, const Request &req);
+    void servePage(QTcpSocket *socket, const Request &req);
+    void serveRecord(QTcpSocket *socket, const Request &req, const QString &id);
+    void serveEvents(QTcpSocket *socket, const Request &req);
+    void serveStatus(QTcpSocket *socket);
+    void respond(QTcpSocket *socket, int status, const QByteArray &contentType, const QByteArray &body,
+                 const QList<QPair<QByteArray, QByteArray>> &extraHeaders = {});
+    void writeEvents(QTcpSocket *socket);
+    void scheduleFlush();
+    QByteArray queueEvent() const;
+
+    FileFeed *feed;
+    QTcpServer *server;
+    QTimer *keepaliveTimer;
+    QHash<QTcpSocket *, QByteArray> requestBuffers; // sockets still sending headers
+    QHash<QTcpSocket *, quint64> streams;           // open event streams -> cursor
+    bool flushScheduled;
+    int queued;
+    int active;
+    bool queueChanged; // not yet sent to open streams
+    std::function<QJsonObject()> statusProvider;
+};
+
+#endif // FEEDHTTPSERVER_H
@@ -0,0 +1,151 @@
+#include "FileAnalyzer.h"
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QMimeDatabase>
+#include <QStringList>
+#include "Allowlist.h"
+#include "FeatureExtractor.h"
+#include "MappedFile.h"
+#include "RuleSet.h"
+#include "Sha256.h"
+#include <cmath>
+
+namespace {
+
+QString epochToIso(double seconds) {
+    return QDateTime::fromMSecsSinceEpoch(qint64(seconds * 1000.0)).toString(Qt::ISODateWithMs);
+}
+
+QString formatSize(qint64 size) {
+    if (size > 1024 * 1024) return QString::number(size / (1024.0 * 1024.0), 'f', 2) + " MB";
+    return QString::number(size / 1024.0, 'f', 2) + " KB";
+}
+
+bool hashFile(const MappedFile &file, const std::atomic<bool> *cancel, std::string &hex) {
+    Sha256 sha256;
+    const bool complete = file.forEachBlock(FeatureExtractor::kBlockSize, [&](const uint8_t *block, size_t len, size_t) {
+        if (cancel && cancel->load(std::memory_order_relaxed)) return false;
+        sha256.update(block, len);
+        return true;
+    });
+    if (complete) hex = sha256.hexDigest();
+    return complete;
+}
+
+// server.py's allowlisted_details
+QJsonObject allowlistedDetails(const QString &path, const MappedFile &file, const std::string &sha256) {
+    static const QMimeDatabase mimeDb;
+    const QFileInfo info(path);
+    const QMimeType byName = mimeDb.mimeTypeForFile(info, QMimeDatabase::MatchExtension);
+    QJsonObject details;
+    details.insert("size", formatSize(qint64(file.size())));
+    details.insert("ext", info.suffix().isEmpty() ? QString() : "." + info.suffix().toLower());
+    details.insert("mime", byName.isDefault() ? QString("unknown") : byName.name());
+    details.insert("hash", QString::fromStdString(sha256));
+    details.insert("created_at", epochToIso(file.changeTime()));
+    details.insert("modified_at", epochToIso(file.modifyTime()));
+    details.insert("rule", "Known-good file: its SHA-256 is on the allowlist, so it was not analysed.");
+    details.insert("gemini", "Not needed for an allowlisted file.");
+    details.insert("allowlisted", true);
+    return details;
+}
+
+} // namespace
+
+FileAnalysis FileAnalyzer::analyze(const QString &path, const RuleSet &rules, const std::atomic<bool> *cancel,
+                                   const Allowlist *allowlist) {
+    FileAnalysis result;
+    const std::string nativePath = QFile::encodeName(path).toStdString();
+    MappedFile file;
+    if (!file.open(nativePath)) return result;
+
+    // Known-good content skips everything else. The hash is handed on, so
+    // an unlisted file is still hashed only once.
+    FileFeatures features;
+    if (allowlist) {
+        if (!hashFile(file, cancel, features.sha256)) {
+            result.cancelled = true;
+            return result;
+        }
+        if (allowlist->containsHex(features.sha256)) {
+            result.ok = true;
+            result.type = "safe";
+            result.details = allowlistedDetails(path, file, features.sha256);
+            return result;
+        }
+    }
+
+    // The rules see the MIME and content types too
+    const QFileInfo info(path);
+    static const QMimeDatabase mimeDb;
+    const QMimeType byName = mimeDb.mimeTypeForFile(info, QMimeDatabase::MatchExtension);
+    const QMimeType byContent = mimeDb.mimeTypeForFile(info, QMimeDatabase::MatchContent);
+    const QString mime = byName.isDefault() ? QString("unknown") : byName.name();
+    const QString magicType = byContent.isDefault() ? QString("unknown") : byContent.comment();
+
+    // One pass for hashes, histogram, header, strings, PE metadata and the
+    // rules' strings, in bounded memory at any file size
+    if (!FeatureExtractor::extract(file, nativePath, features, rules.patterns(), cancel)) {
+        result.cancelled = true;
+        return result;
+    }
+    const qint64 size = qint64(features.size);
+    const QString ext = QString::fromStdString(features.extension);
+
+    RuleSet::Externals externals;
+    externals.mime = mime.toStdString();
+    externals.magicType = magicType.toStdString();
+    const std::vector<RuleSet::Match> matches = rules.evaluate(features, externals);
+    bool suspicious = false;
+    QStringList matchedNames;
+    QStringList descriptions;
+    for (const RuleSet::Match &m : matches) {
+        suspicious = suspicious || m.suspicious;
+        matchedNames << QString::fromStdString(m.name);
+        if (!m.description.empty()) descriptions << QString::fromStdString(m.description);
+    }
+
+    QJsonArray suspiciousStrings;
+    for (const std::string &s : features.suspiciousStrings) suspiciousStrings.append(QString::fromStdString(s));
+    const double entropy = std::round(features.entropy * 10000.0) / 10000.0;
+
+    // Same wording as server.py's rule-based assessment
+    QString rule = QString("File is a %1 file. %2 based on initial checks.")
+                       .arg(mime, suspicious ? "Suspicious" : "Safe");
+    if (!matchedNames.isEmpty()) rule += QString(" Matched rules: %1.").arg(matchedNames.join(", "));
+    if (!descriptions.isEmpty()) rule += " " + descriptions.join(" ");
+
+    // analyze_pe_file only reports .exe / .dll
+    const bool pe = features.pe.valid && (ext == ".exe" || ext == ".dll");
+
+    QJsonObject details;
+    details.insert("size", formatSize(size));
+    details.insert("ext", ext);
+    details.insert("mime", mime);
+    details.insert("magic_type", magicType);
+    details.insert("hash", QString::fromStdString(features.sha256));
+    details.insert("entropy", QString::number(entropy));
+    details.insert("is_executable", features.isExecutable);
+    details.insert("has_digital_signature", features.hasDigitalSignature);
+    details.insert("suspicious_strings", suspiciousStrings);
+    details.insert("file_header", QString::fromStdString(features.fileHeader));
+    details.insert("created_at", epochToIso(features.changeTime));
+    details.insert("modified_at", epochToIso(features.modifyTime));
+    details.insert("strings_count", int(features.strings.size()));
+    details.insert("suspicious_count", suspiciousStrings.size());
+    details.insert("pe_sections", pe ? QJsonValue(features.pe.sections) : QJsonValue(""));
+    details.insert("pe_timestamp", pe ? QJsonValue(qint64(features.pe.timestamp)) : QJsonValue(""));
+    details.insert("is_dll", pe && (features.pe.characteristics & 0x2000));
+    details.insert("imphash", pe ? QString::fromStdString(features.pe.imphash) : QString());
+    details.insert("similarity_digest", QString::fromStdString(features.similarityDigest));
+    details.insert("rule", rule);
+    details.insert("matched_rules", QJsonArray::fromStringList(matchedNames));
+    details.insert("gemini", "Gemini AI analysis not available.");
+
+    result.ok = true;
+    result.type = suspicious ? "suspicious" : "safe";
+    result.details = details;
+    return result;
+}
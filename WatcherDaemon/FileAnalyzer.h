@@ -0,0 +1,30 @@
+#ifndef FILEANALYZER_H
+#define FILEANALYZER_H
+
+#include <QJsonObject>
+#include <QString>
+#include <atomic>
+
+class Allowlist;
+class RuleSet;
+
+struct FileAnalysis {
+    bool ok = false;
+    bool cancelled = false; // stopped early through the cancel flag
+    QString type;        // safe / suspicious, as server.py reports
+    QJsonObject details; // same keys server.py sends to the GUI
+};
+
+// Rule-based analysis matching ExecutableMonitor's extract_file_features +
+// its detection rules. Reentrant; runs on the daemon's worker pool. The
+// rules' strings are searched in the extraction pass. Raising cancel from
+// another thread stops the pass over the file at the next block.
+// With an allowlist the file is hashed first, and a listed file is reported
+// safe without the rest of the analysis.
+class FileAnalyzer {
+public:
+    static FileAnalysis analyze(const QString &path, const RuleSet &rules, const std::atomic<bool> *cancel = nullptr,
+                                const Allowlist *allowlist = nullptr);
+};
+
+#endif // FILEANALYZER_H
@@ -0,0 +1,231 @@
+#include "FileFeed.h"
+#include <QDateTime>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace {
+// Details a summary keeps: enough for the table row (history.py SUMMARY_DETAILS)
+const char *const kSummaryDetails[] = {"created_at", "ext", "hash", "cached", "allowlisted"};
+
+QJsonArray sortKey(const QJsonObject &record, const QString &sort) {
+    if (sort == QLatin1String("name")) return {record.value("name").toString().toLower(), record.value("id")};
+    return {record.value(sort)};
+}
+
+// Keys hold numbers and strings in matching positions
+int compareKeys(const QJsonArray &a, const QJsonArray &b) {
+    for (qsizetype i = 0; i < a.size() && i < b.size(); ++i) {
+        const QJsonValue x = a.at(i), y = b.at(i);
+        const int c = x.isString() ? x.toString().compare(y.toString())
+                                   : (x.toDouble() < y.toDouble() ? -1 : x.toDouble() > y.toDouble());
+        if (c) return c < 0 ? -1 : 1;
+    }
+    return a.size() < b.size() ? -1 : a.size() > b.size();
+}
+
+QString encodeCursor(const QJsonArray &key) {
+    return QString::fromLatin1(QJsonDocument(key).toJson(QJsonDocument::Compact)
+                                   .toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals));
+}
+
+bool decodeCursor(const QString &cursor, QJsonArray &key) {
+    const auto decoded = QByteArray::fromBase64Encoding(cursor.toLatin1(), QByteArray::Base64UrlEncoding
+                                                                               | QByteArray::AbortOnBase64DecodingErrors);
+    if (!decoded) return false;
+    const QJsonDocument doc = QJsonDocument::fromJson(*decoded);
+    key = doc.array();
+    return doc.isArray() && !key.isEmpty();
+}
+} // namespace
+
+FileFeed::FileFeed(QObject *parent)
+    : QObject(parent), runEpoch(QString::number(QDateTime::currentMSecsSinceEpoch())),
+      seq(0), nextId(1), maxRecords(kDefaultMaxRecords), maxAgeMs(qint64(kDefaultMaxDays) * 86400000),
+      evicted(0)
+{
+}
+
+void FileFeed::setRetention(int records, int days) {
+    maxRecords = qMax(1, records);
+    maxAgeMs = qint64(qMax(1, days)) * 86400000;
+    expire();
+}
+
+int FileFeed::track(const QString &path) {
+    const auto it = idByPath.constFind(path);
+    if (it != idByPath.constEnd()) return *it;
+
+    const int id = nextId++;
+    QJsonObject record;
+    record.insert("id", id);
+    record.insert("seq", 0);
+    record.insert("name", QFileInfo(path).fileName());
+    record.insert("path", path);
+    record.insert("type", "analyzing");
+    record.insert("details", QJsonValue::Null);
+    records.insert(id, record);
+    addedAt.insert(id, QDateTime::currentMSecsSinceEpoch());
+    idByPath.insert(path, id);
+    publish(id);
+    expire();
+    return id;
+}
+
+void FileFeed::expire() {
+    // Oldest first; a record still being analysed is kept until done
+    int excess = records.size() - maxRecords;
+    const qint64 cutoff = QDateTime::currentMSecsSinceEpoch() - maxAgeMs;
+    for (auto it = records.begin(); it != records.end();) {
+        if (excess <= 0 && addedAt.value(it.key()) >= cutoff) break;
+        if (it->value("type").toString() == QLatin1String("analyzing")) {
+            ++it;
+            continue;
+        }
+        const QString path = it->value("path").toString();
+        if (idByPath.value(path) == it.key()) idByPath.remove(path);
+        idBySeq.remove(quint64(it->value("seq").toInteger()));
+        addedAt.remove(it.key());
+        it = records.erase(it);
+        --excess;
+        ++evicted;
+    }
+}
+
+void FileFeed::update(int id, const QString &type, const QJsonObject &details) {
+    auto it = records.find(id);
+    if (it == records.end()) return;
+    it->insert("type", type);
+    it->insert("details", details);
+    publish(id);
+}
+
+void FileFeed::setType(int id, const QString &type) {
+    auto it = records.find(id);
+    if (it == records.end()) return;
+    it->insert("type", type);
+    publish(id);
+}
+
+void FileFeed::publish(int id) {
+    QJsonObject &record = records[id];
+    idBySeq.remove(quint64(record.value("seq").toInteger()));
+    ++seq;
+    record.insert("seq", qint64(seq));
+    idBySeq.insert(seq, id);
+    emit changed();
+}
+
+QJsonArray FileFeed::allFiles() const {
+    QJsonArray files;
+    for (const QJsonObject &record : records) files.append(record);
+    return files;
+}
+
+QList<QJsonObject> FileFeed::changedSince(quint64 since) const {
+    QList<QJsonObject> delta;
+    for (auto it = idBySeq.upperBound(since); it != idBySeq.constEnd(); ++it) {
+        delta.append(records.value(it.value()));
+    }
+    return delta;
+}
+
+int FileFeed::changedCountSince(quint64 since) const {
+    return int(std::distance(idBySeq.upperBound(since), idBySeq.constEnd()));
+}
+
+QJsonObject FileFeed::summarize(const QJsonObject &record) {
+    QJsonObject summary = record;
+    summary.insert("summary", true);
+    const QJsonValue details = record.value("details");
+    if (details.isObject()) {
+        const QJsonObject full = details.toObject();
+        QJsonObject kept;
+        for (const char *key : kSummaryDetails) {
+            const QJsonValue value = full.value(QLatin1String(key));
+            if (!value.isUndefined()) kept.insert(QLatin1String(key), value);
+        }
+        summary.insert("details", kept);
+    }
+    return summary;
+}
+
+bool FileFeed::page(const PageQuery &query, Page &out, QString *error) const {
+    const QString &sort = query.sort;
+    if (sort != QLatin1String("id") && sort != QLatin1String("seq") && sort != QLatin1String("name")) {
+        if (error) *error = QStringLiteral("sort must be one of id, seq, name");
+        return false;
+    }
+    QJsonArray after;
+    if (!query.cursor.isEmpty() && !decodeCursor(query.cursor, after)) {
+        if (error) *error = QStringLiteral("bad cursor");
+        return false;
+    }
+    const int limit = qBound(1, query.limit, kMaxPage);
+
+    // Records after the cursor, in order; id and seq start right at it
+    std::vector<const QJsonObject *> order;
+    if (sort == QLatin1String("name")) {
+        for (const QJsonObject &record : records) order.push_back(&record);
+        std::sort(order.begin(), order.end(), [&](const QJsonObject *a, const QJsonObject *b) {
+            return compareKeys(sortKey(*a, sort), sortKey(*b, sort)) < 0;
+        });
+        if (query.descending) std::reverse(order.begin(), order.end());
+        if (!after.isEmpty()) {
+            order.erase(std::remove_if(order.begin(), order.end(), [&](const QJsonObject *r) {
+                const int c = compareKeys(sortKey(*r, sort), after);
+                return query.descending ? c >= 0 : c <= 0;
+            }), order.end());
+        }
+    } else if (sort == QLatin1String("id")) {
+        const int afterId = after.isEmpty() ? 0 : after.at(0).toInt();
+        if (query.descending) {
+            auto it = after.isEmpty() ? records.constEnd() : records.lowerBound(afterId);
+            while (it != records.constBegin()) order.push_back(&*--it);
+        } else {
+            for (auto it = records.upperBound(afterId); it != records.constEnd(); ++it) order.push_back(&*it);
+        }
+    } else {
+        const quint64 afterSeq = after.isEmpty() ? 0 : quint64(after.at(0).toInteger());
+        if (query.descending) {
+            auto it = after.isEmpty() ? idBySeq.constEnd() : idBySeq.lowerBound(afterSeq);
+            while (it != idBySeq.constBegin()) order.push_back(&*records.constFind((--it).value()));
+        } else {
+            for (auto it = idBySeq.upperBound(afterSeq); it != idBySeq.constEnd(); ++it) {
+                order.push_back(&*records.constFind(it.value()));
+            }
+        }
+    }
+
+    out = Page();
+    const QJsonObject *last = nullptr;
+    for (const QJsonObject *record : order) {
+        if (!query.type.isEmpty() && record->value("type").toString() != query.type) continue;
+        if (out.files.size() == limit) {
+            out.next = encodeCursor(sortKey(*last, sort));
+            break;
+        }
+        out.files.append(query.summary ? summarize(*record) : *record);
+        last = record;
+    }
+    if (query.type.isEmpty()) {
+        out.total = records.size();
+    } else {
+        for (const QJsonObject &record : records) out.total += record.value("type").toString() == query.type;
+    }
+    return true;
+}
+
+QJsonObject FileFeed::stats() const {
+    QJsonObject stats;
+    stats.insert("records", records.size());
+    stats.insert("max_records", maxRecords);
+    stats.insert("max_days", double(maxAgeMs) / 86400000);
+    stats.insert("evicted", qint64(evicted));
+    stats.insert("oldest", records.isEmpty() ? QJsonValue()
+                                             : QDateTime::fromMSecsSinceEpoch(addedAt.value(records.firstKey()))
+                                                   .toString(Qt::ISODateWithMs));
+    return stats;
+}
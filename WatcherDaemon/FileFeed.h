@@ -0,0 +1,82 @@
+#ifndef FILEFEED_H
+#define FILEFEED_H
+
+#include <QObject>
+#include <QHash>
+#include <QMap>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+// In-memory file records plus the change feed behind /api/files?since=
+// and /api/events. Same contract as server.py: every change bumps a
+// global sequence number, and the epoch identifies this daemon run so
+// clients holding a cursor from an older run get a full reset. Records are
+// capped by count and age like history.py (the oldest go first, never one
+// still being analysed) and listed a page at a time by keyset cursor.
+class FileFeed : public QObject {
+    Q_OBJECT
+public:
+    struct PageQuery {
+        int limit = 100;
+        QString cursor; // from the previous page's next; empty = first page
+        QString sort = QStringLiteral("id"); // id | seq | name
+        bool descending = true;
+        QString type;   // only records with this verdict; empty = all
+        bool summary = true;
+    };
+
+    struct Page {
+        QJsonArray files;
+        QString next; // cursor of the following page; empty after the last
+        int total = 0;
+    };
+
+    static const int kDefaultMaxRecords = 10000;
+    static const int kDefaultMaxDays = 30;
+    static const int kMaxPage = 500;
+
+    explicit FileFeed(QObject *parent = nullptr);
+
+    QString epoch() const { return runEpoch; }
+    quint64 cursor() const { return seq; }
+    int fileCount() const { return records.size(); }
+    void setRetention(int maxRecords, int maxDays);
+
+    // Record id for path, creating an 'analyzing' record on first sight
+    int track(const QString &path);
+    int idForPath(const QString &path) const { return idByPath.value(path, 0); }
+    QJsonObject record(int id) const { return records.value(id); } // empty if unknown or evicted
+    void update(int id, const QString &type, const QJsonObject &details);
+    void setType(int id, const QString &type);
+
+    QJsonArray allFiles() const;                     // legacy full listing, by id
+    QList<QJsonObject> changedSince(quint64 since) const; // in seq order
+    int changedCountSince(quint64 since) const;
+    bool page(const PageQuery &query, Page &out, QString *error) const;
+    QJsonObject stats() const;
+
+    // record with only the table columns of its details, marked "summary"
+    static QJsonObject summarize(const QJsonObject &record);
+
+signals:
+    void changed(); // one or more records were published
+
+private:
+    void publish(int id);
+    void expire();
+
+    QString runEpoch;
+    quint64 seq;
+    int nextId;
+    int maxRecords;
+    qint64 maxAgeMs;
+    quint64 evicted;
+    QMap<int, QJsonObject> records; // by id, i.e. detection order
+    QHash<int, qint64> addedAt;     // id -> ms since epoch when detected
+    QHash<QString, int> idByPath;
+    QMap<quint64, int> idBySeq; // latest seq of each record -> id
+};
+
+#endif // FILEFEED_H
@@ -0,0 +1,222 @@
+#include "FsWatcher.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <QDebug>
+
+#include <sys/inotify.h>
+#include <sys/fanotify.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+const uint32_t kDirMask = IN_CREATE | IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+const size_t kReadBufferSize = 256 * 1024;
+const int kPartialPollMs = 500;
+// Written by the browser just before the rename, so the finished file's
+// mtime is within this of the temp file's last close
+const int kPartialSlackSecs = 2;
+}
+
+FsWatcher::FsWatcher(QObject *parent)
+    : QObject(parent), activeBackend(Inotify), fd(-1), notifier(nullptr), partialTimer(new QTimer(this))
+{
+    partialTimer->setInterval(kPartialPollMs);
+    connect(partialTimer, &QTimer::timeout, this, &FsWatcher::checkPartialDownloads);
+}
+
+bool FsWatcher::isPartialDownload(const QString &path) {
+    static const char *const suffixes[] = {".crdownload", ".part", ".partial", ".download", ".opdownload", ".tmp"};
+    for (const char *suffix : suffixes) {
+        if (path.endsWith(QLatin1String(suffix), Qt::CaseInsensitive)) return true;
+    }
+    return false;
+}
+
+FsWatcher::~FsWatcher() {
+    stop();
+}
+
+bool FsWatcher::start(const QString &rootDir, Backend preferred) {
+    stop();
+    root = QDir(rootDir).absolutePath();
+    if (preferred == Fanotify) {
+        if (startFanotify()) return true;
+        qWarning() << "FsWatcher: fanotify unavailable (" << strerror(errno) << "), using inotify";
+    }
+    return startInotify();
+}
+
+void FsWatcher::stop() {
+    delete notifier;
+    notifier = nullptr;
+    if (fd >= 0) ::close(fd); // drops every inotify watch / fanotify mark
+    fd = -1;
+    watchPaths.clear();
+    partialTimer->stop();
+    partialWrites.clear();
+}
+
+// ==============================
+// inotify
+// ==============================
+
+bool FsWatcher::startInotify() {
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        qWarning() << "FsWatcher: inotify_init1 failed:" << strerror(errno);
+        return false;
+    }
+    activeBackend = Inotify;
+    addWatchRecursive(root, nullptr);
+    notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, &FsWatcher::onInotifyReadable);
+    return !watchPaths.isEmpty();
+}
+
+void FsWatcher::addWatchRecursive(const QString &dir, QStringList *existingFiles) {
+    // Watch first, then list: anything created in between shows up twice at
+    // worst, never zero times.
+    const int wd = inotify_add_watch(fd, QFile::encodeName(dir).constData(), kDirMask);
+    if (wd < 0) {
+        // ENOSPC means fs.inotify.max_user_watches is exhausted
+        qWarning() << "FsWatcher: cannot watch" << dir << ":" << strerror(errno);
+        return;
+    }
+    watchPaths.insert(wd, dir);
+
+    QDirIterator it(dir, QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden | QDir::NoSymLinks);
+    while (it.hasNext()) {
+        const QString path = it.next();
+        if (it.fileInfo().isDir()) addWatchRecursive(path, existingFiles);
+        else if (existingFiles && !isPartialDownload(path)) existingFiles->append(path);
+    }
+}
+
+void FsWatcher::onInotifyReadable() {
+    alignas(inotify_event) static char buffer[kReadBufferSize];
+    QStringList detected;
+    QStringList written;
+
+    for (;;) {
+        const ssize_t len = ::read(fd, buffer, sizeof(buffer));
+        if (len <= 0) break; // EAGAIN: queue drained
+
+        for (char *p = buffer; p < buffer + len;) {
+            const auto *ev = reinterpret_cast<const inotify_event *>(p);
+            p += sizeof(inotify_event) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW) {
+                emit overflowed();
+                continue;
+            }
+            if (ev->mask & IN_IGNORED) {
+                watchPaths.remove(ev->wd);
+                continue;
+            }
+            const auto dir = watchPaths.constFind(ev->wd);
+            if (dir == watchPaths.constEnd() || ev->len == 0) continue;
+            const QString path = *dir + '/' + QFile::decodeName(ev->name);
+
+            if (ev->mask & IN_ISDIR) {
+                // New subtree: watch it and pick up files that beat the watch
+                if (ev->mask & (IN_CREATE | IN_MOVED_TO)) addWatchRecursive(path, &written);
+            } else if (isPartialDownload(path)) {
+                continue; // the rename to the final name follows as IN_MOVED_TO
+            } else if (ev->mask & IN_CREATE) {
+                detected.append(path);
+            } else if (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                written.append(path);
+            }
+        }
+    }
+
+    if (!detected.isEmpty()) emit filesDetected(detected);
+    if (!written.isEmpty()) emit filesWritten(written);
+}
+
+// ==============================
+// fanotify
+// ==============================
+
+bool FsWatcher::startFanotify() {
+    fd = fanotify_init(FAN_CLASS_NOTIF | FAN_CLOEXEC | FAN_NONBLOCK, O_RDONLY | O_LARGEFILE | O_CLOEXEC);
+    if (fd < 0) return false;
+    // One mark covers the whole mount, however deep the tree is; events
+    // outside root are filtered out below.
+    if (fanotify_mark(fd, FAN_MARK_ADD | FAN_MARK_MOUNT, FAN_CLOSE_WRITE, AT_FDCWD,
+                      QFile::encodeName(root).constData()) < 0) {
+        const int err = errno;
+        ::close(fd);
+        fd = -1;
+        errno = err;
+        return false;
+    }
+    activeBackend = Fanotify;
+    notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, &FsWatcher::onFanotifyReadable);
+    return true;
+}
+
+void FsWatcher::onFanotifyReadable() {
+    alignas(fanotify_event_metadata) static char buffer[kReadBufferSize];
+    const QString prefix = root + '/';
+    QStringList written;
+    char link[64];
+    char target[PATH_MAX];
+
+    for (;;) {
+        const ssize_t len = ::read(fd, buffer, sizeof(buffer));
+        if (len <= 0) break;
+
+        auto *meta = reinterpret_cast<fanotify_event_metadata *>(buffer);
+        ssize_t left = len;
+        for (; FAN_EVENT_OK(meta, left); meta = FAN_EVENT_NEXT(meta, left)) {
+            if (meta->mask & FAN_Q_OVERFLOW) {
+                emit overflowed();
+                continue;
+            }
+            if (meta->fd < 0) continue;
+            snprintf(link, sizeof(link), "/proc/self/fd/%d", meta->fd);
+            const ssize_t n = readlink(link, target, sizeof(target) - 1);
+            ::close(meta->fd);
+            if (n <= 0) continue;
+            const QString path = QFile::decodeName(QByteArray(target, int(n)));
+            if (!path.startsWith(prefix)) continue;
+            if (isPartialDownload(path)) partialWrites.insert(path, QDateTime::currentDateTimeUtc());
+            else written.append(path);
+        }
+    }
+
+    if (!partialWrites.isEmpty() && !partialTimer->isActive()) partialTimer->start();
+    if (!written.isEmpty()) emit filesWritten(written);
+}
+
+void FsWatcher::checkPartialDownloads() {
+    QStringList written;
+    for (auto it = partialWrites.begin(); it != partialWrites.end();) {
+        if (QFileInfo::exists(it.key())) {
+            ++it;
+            continue;
+        }
+        // Gone, so renamed (or cancelled): report its directory's files
+        // last written around the temp file's final close
+        const QDateTime after = it.value().addSecs(-kPartialSlackSecs);
+        QDirIterator dir(QFileInfo(it.key()).path(), QDir::Files | QDir::Hidden | QDir::NoSymLinks);
+        while (dir.hasNext()) {
+            const QString path = dir.next();
+            if (!isPartialDownload(path) && dir.fileInfo().lastModified().toUTC() >= after) written.append(path);
+        }
+        it = partialWrites.erase(it);
+    }
+    if (partialWrites.isEmpty()) partialTimer->stop();
+    written.removeDuplicates();
+    if (!written.isEmpty()) emit filesWritten(written);
+}
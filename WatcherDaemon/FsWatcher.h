@@ -0,0 +1,61 @@
+#ifndef FSWATCHER_H
+#define FSWATCHER_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+class QSocketNotifier;
+class QTimer;
+
+// Recursive directory watcher on top of inotify, or fanotify when asked
+// for and permitted (needs CAP_SYS_ADMIN). Events are read in large
+// batches and handed out as path lists, one signal per kernel read, so a
+// burst of thousands of files costs a handful of signal emissions.
+// Browser temp files (.crdownload, .part, ...) are never reported; the
+// finished download is reported when it is renamed into place.
+class FsWatcher : public QObject {
+    Q_OBJECT
+public:
+    enum Backend { Inotify, Fanotify };
+
+    explicit FsWatcher(QObject *parent = nullptr);
+    ~FsWatcher() override;
+
+    // Falls back to inotify if fanotify is requested but unavailable
+    bool start(const QString &rootDir, Backend preferred = Inotify);
+    void stop();
+    Backend backend() const { return activeBackend; }
+    QString backendName() const { return activeBackend == Fanotify ? "fanotify" : "inotify"; }
+    int watchCount() const { return watchPaths.size(); }
+    static bool isPartialDownload(const QString &path); // browser temp file
+
+signals:
+    void filesDetected(const QStringList &paths); // created, may still be written to
+    void filesWritten(const QStringList &paths);  // closed after writing or moved in
+    void overflowed(); // kernel queue overflowed; caller should rescan
+
+private slots:
+    void onInotifyReadable();
+    void onFanotifyReadable();
+    void checkPartialDownloads();
+
+private:
+    bool startInotify();
+    bool startFanotify();
+    void addWatchRecursive(const QString &dir, QStringList *existingFiles);
+
+    QString root;
+    Backend activeBackend;
+    int fd;
+    QSocketNotifier *notifier;
+    QHash<int, QString> watchPaths; // inotify wd -> directory
+    // fanotify reports no renames, so temp files it saw closed are polled
+    // until they vanish; the files that replaced them are then reported
+    QTimer *partialTimer;
+    QHash<QString, QDateTime> partialWrites; // temp path -> last close
+};
+
+#endif // FSWATCHER_H
@@ -0,0 +1,299 @@
+#include "WatcherDaemon.h"
+#include "FileFeed.h"
+#include "FeedHttpServer.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QJsonObject>
+#include <QTimer>
+#include <QDebug>
+
+namespace {
+// Same as ExecutableMonitor/similarity_index.py
+const int kSimilarTopK = 5;
+const int kSimilarMaxDistance = 100;
+const int kRulesSettleMs = 200; // editors write, truncate and rename in quick succession
+}
+
+WatcherDaemon::WatcherDaemon(const Options &options, FileFeed *feed, QObject *parent)
+    : QObject(parent), options(options), feed(feed), watcher(new FsWatcher(this)), http(nullptr),
+      coalesceTimer(new QTimer(this)), merged(0), cancelled(0), rulesWatcher(new QFileSystemWatcher(this)),
+      rulesTimer(new QTimer(this)), rulesReloads(0)
+{
+    if (options.workers > 0) pool.setMaxThreadCount(options.workers);
+    clock.start();
+    coalesceTimer->setSingleShot(true);
+    connect(coalesceTimer, &QTimer::timeout, this, &WatcherDaemon::onCoalesceTimeout);
+    connect(watcher, &FsWatcher::filesDetected, this, &WatcherDaemon::onFilesDetected);
+    connect(watcher, &FsWatcher::filesWritten, this, &WatcherDaemon::onFilesWritten);
+    connect(watcher, &FsWatcher::overflowed, this, &WatcherDaemon::onOverflow);
+    rulesTimer->setSingleShot(true);
+    rulesTimer->setInterval(kRulesSettleMs);
+    connect(rulesTimer, &QTimer::timeout, this, &WatcherDaemon::reloadRules);
+    connect(rulesWatcher, &QFileSystemWatcher::fileChanged, rulesTimer, qOverload<>(&QTimer::start));
+    connect(rulesWatcher, &QFileSystemWatcher::directoryChanged, rulesTimer, qOverload<>(&QTimer::start));
+}
+
+WatcherDaemon::~WatcherDaemon() {
+    // Members go in reverse order, so the allowlist, similarity index and
+    // rules would be destroyed before the pool waits for its jobs
+    pool.clear();
+    for (const auto &job : std::as_const(inFlight)) job->cancel.store(true);
+    pool.waitForDone();
+}
+
+bool WatcherDaemon::start() {
+    if (!QDir().mkpath(options.watchedDir)) {
+        qWarning() << "WatcherDaemon: cannot create" << options.watchedDir;
+    }
+    if (!options.allowlistPath.isEmpty()) {
+        std::string error;
+        if (allowlist.open(QFile::encodeName(options.allowlistPath).toStdString(), &error)) {
+            qInfo().noquote() << "Allowlist:" << allowlist.stats().entries << "known-good hashes";
+        } else {
+            qWarning().noquote() << "WatcherDaemon: allowlist disabled:" << QString::fromStdString(error);
+        }
+    }
+    if (!loadRules()) return false;
+    // The directory too: an editor that saves by renaming replaces the file
+    rulesWatcher->addPath(options.rulesPath);
+    rulesWatcher->addPath(QFileInfo(options.rulesPath).absolutePath());
+    if (!watcher->start(options.watchedDir, options.backend)) return false;
+    qInfo().noquote() << "Monitoring started on:" << options.watchedDir
+                      << "(" + watcher->backendName() + "," << pool.maxThreadCount() << "workers)";
+    return true;
+}
+
+void WatcherDaemon::attach(FeedHttpServer *server) {
+    http = server;
+    http->setStatusProvider([this]() {
+        QJsonObject status;
+        status.insert("watched_dir", options.watchedDir);
+        status.insert("backend", watcher->backendName());
+        status.insert("watches", watcher->watchCount());
+        status.insert("workers", pool.maxThreadCount());
+        status.insert("in_flight", inFlight.size());
+        const int active = qMin(int(inFlight.size()), pool.maxThreadCount());
+        QJsonObject queue;
+        queue.insert("queued", int(inFlight.size()) - active);
+        queue.insert("active", active);
+        status.insert("analysis_queue", queue);
+        QJsonObject coalescing;
+        coalescing.insert("window_ms", options.coalesceMs);
+        coalescing.insert("merged", qint64(merged));
+        coalescing.insert("cancelled", qint64(cancelled));
+        coalescing.insert("analyses_saved", qint64(merged + cancelled));
+        status.insert("coalescing", coalescing);
+        const SimilarityIndex::Stats index = similarity.stats();
+        QJsonObject similar;
+        similar.insert("entries", qint64(index.entries));
+        similar.insert("capacity", qint64(index.capacity));
+        similar.insert("additions", qint64(index.additions));
+        similar.insert("queries", qint64(index.queries));
+        status.insert("similarity", similar);
+        QJsonObject known;
+        known.insert("enabled", allowlist.isOpen());
+        if (allowlist.isOpen()) {
+            const Allowlist::Stats s = allowlist.stats();
+            known.insert("path", options.allowlistPath);
+            known.insert("entries", qint64(s.entries));
+            known.insert("bloom_bytes", qint64(s.bloomBytes));
+            known.insert("lookups", qint64(s.lookups));
+            known.insert("bloom_rejects", qint64(s.bloomRejects));
+            known.insert("hits", qint64(s.hits));
+        }
+        status.insert("allowlist", known);
+        QJsonObject ruleStatus;
+        ruleStatus.insert("enabled", bool(rules));
+        ruleStatus.insert("path", options.rulesPath);
+        ruleStatus.insert("rules", qint64(rules ? rules->ruleCount() : 0));
+        ruleStatus.insert("strings", qint64(rules ? rules->stringCount() : 0));
+        ruleStatus.insert("fingerprint", rules ? QString::fromStdString(rules->fingerprint()) : QString());
+        ruleStatus.insert("loaded_at", rulesLoadedAt);
+        ruleStatus.insert("reloads", rulesReloads);
+        ruleStatus.insert("error", rulesError.isEmpty() ? QJsonValue() : QJsonValue(rulesError));
+        status.insert("rules", ruleStatus);
+        return status;
+    });
+}
+
+bool WatcherDaemon::loadRules() {
+    std::string error;
+    std::shared_ptr<const RuleSet> loaded = RuleSet::load(QFile::encodeName(options.rulesPath).toStdString(), &error);
+    if (!loaded) {
+        rulesError = QString::fromStdString(error);
+        if (rules) {
+            qWarning().noquote() << "WatcherDaemon: rules not reloaded, keeping the previous ones:" << rulesError;
+        } else {
+            qCritical().noquote() << "WatcherDaemon: cannot load rules:" << rulesError;
+        }
+        return false;
+    }
+    if (rules) ++rulesReloads;
+    rules = loaded;
+    rulesError.clear();
+    rulesLoadedAt = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+    qInfo().noquote() << "Rules:" << rules->ruleCount() << "rules," << rules->stringCount() << "strings from"
+                      << options.rulesPath;
+    return true;
+}
+
+void WatcherDaemon::reloadRules() {
+    // A replaced file drops out of the watch list
+    if (QFileInfo::exists(options.rulesPath) && !rulesWatcher->files().contains(options.rulesPath)) {
+        rulesWatcher->addPath(options.rulesPath);
+    }
+    const QString before = rules ? QString::fromStdString(rules->fingerprint()) : QString();
+    std::string error;
+    QFile file(options.rulesPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        rulesError = "cannot read " + options.rulesPath;
+        qWarning().noquote() << "WatcherDaemon: rules not reloaded:" << rulesError;
+        return;
+    }
+    // Directory events fire for unrelated files; only recompile on a change
+    const QByteArray source = file.readAll();
+    std::shared_ptr<const RuleSet> loaded = RuleSet::compile(source.toStdString(), &error);
+    if (!loaded) {
+        rulesError = options.rulesPath + ": " + QString::fromStdString(error);
+        qWarning().noquote() << "WatcherDaemon: rules not reloaded, keeping the previous ones:" << rulesError;
+        return;
+    }
+    rulesError.clear();
+    if (QString::fromStdString(loaded->fingerprint()) == before) return;
+    ++rulesReloads;
+    rules = loaded;
+    rulesLoadedAt = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+    qInfo().noquote() << "Rules reloaded:" << rules->ruleCount() << "rules," << rules->stringCount() << "strings";
+}
+
+void WatcherDaemon::onFilesDetected(const QStringList &paths) {
+    // Show the file as 'analyzing' right away; analysis waits for the writer
+    for (const QString &path : paths) feed->track(path);
+}
+
+void WatcherDaemon::onFilesWritten(const QStringList &paths) {
+    for (const QString &path : paths) coalesce(path);
+}
+
+void WatcherDaemon::onOverflow() {
+    // Events were dropped; treat every file under the root as written
+    qWarning() << "WatcherDaemon: event queue overflowed, rescanning" << options.watchedDir;
+    QDirIterator it(options.watchedDir, QDir::Files | QDir::Hidden | QDir::NoSymLinks, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString path = it.next();
+        if (feed->idForPath(path) == 0 && !FsWatcher::isPartialDownload(path)) schedule(path);
+    }
+}
+
+void WatcherDaemon::coalesce(const QString &path) {
+    feed->track(path);
+    if (options.coalesceMs <= 0) {
+        schedule(path);
+        return;
+    }
+    // Each write restarts the path's window; only the last one is analysed
+    if (settling.contains(path)) ++merged;
+    settling.insert(path, clock.elapsed() + options.coalesceMs);
+    if (!coalesceTimer->isActive()) coalesceTimer->start(options.coalesceMs);
+}
+
+void WatcherDaemon::onCoalesceTimeout() {
+    const qint64 now = clock.elapsed();
+    qint64 next = -1;
+    for (auto it = settling.begin(); it != settling.end();) {
+        if (it.value() <= now) {
+            const QString path = it.key();
+            it = settling.erase(it);
+            schedule(path);
+        } else {
+            if (next < 0 || it.value() < next) next = it.value();
+            ++it;
+        }
+    }
+    if (next >= 0) coalesceTimer->start(int(next - now));
+}
+
+void WatcherDaemon::schedule(const QString &path) {
+    feed->track(path);
+    const auto it = inFlight.constFind(path);
+    if (it != inFlight.constEnd()) {
+        // Still queued: it has not read the file yet, so it sees this write.
+        // Running: its result would be stale, so stop it and go again.
+        if (!(*it)->started.load()) {
+            ++merged;
+        } else {
+            (*it)->cancel.store(true);
+            dirty.insert(path);
+        }
+        return;
+    }
+    const auto job = std::make_shared<Job>();
+    inFlight.insert(path, job);
+    pool.start([this, path, job, rules = rules]() {
+        job->started.store(true);
+        const FileAnalysis result = FileAnalyzer::analyze(path, *rules, &job->cancel,
+                                                          allowlist.isOpen() ? &allowlist : nullptr);
+        QMetaObject::invokeMethod(this, [this, path, result]() { onAnalyzed(path, result); }, Qt::QueuedConnection);
+    });
+    publishQueueDepth();
+}
+
+void WatcherDaemon::onAnalyzed(const QString &path, const FileAnalysis &result) {
+    inFlight.remove(path);
+    if (dirty.remove(path)) {
+        // Superseded by a newer write; its result is never shown
+        ++cancelled;
+        schedule(path);
+        return;
+    }
+    const int id = feed->idForPath(path);
+    if (result.ok) {
+        QJsonObject details = result.details;
+        details.insert("similar", similarTo(id, details));
+        feed->update(id, result.type, details);
+    } else {
+        feed->setType(id, "error");
+    }
+    publishQueueDepth();
+}
+
+QJsonArray WatcherDaemon::similarTo(int id, const QJsonObject &details) {
+    QJsonArray similar;
+    SimilarityDigest::Digest digest;
+    if (!SimilarityDigest::parseHex(details.value("similarity_digest").toString().toStdString(), digest)) {
+        return similar;
+    }
+    const QString imphash = details.value("imphash").toString();
+    // Extra candidates make room for older digests of re-analysed records;
+    // a record never matches itself and appears once
+    QSet<int> seen{id};
+    for (const SimilarityIndex::Match &m : similarity.query(digest, 2 * kSimilarTopK + 1, kSimilarMaxDistance)) {
+        const int other = int(m.id);
+        if (similar.size() == kSimilarTopK || seen.contains(other)) continue;
+        seen.insert(other);
+        const QJsonObject record = feed->record(other);
+        if (record.isEmpty()) continue;
+        QJsonObject match;
+        match.insert("id", other);
+        match.insert("name", record.value("name"));
+        match.insert("type", record.value("type"));
+        match.insert("distance", m.distance);
+        match.insert("same_imports", !imphash.isEmpty()
+                                         && record.value("details").toObject().value("imphash").toString() == imphash);
+        similar.append(match);
+    }
+    similarity.add(digest, id);
+    return similar;
+}
+
+void WatcherDaemon::publishQueueDepth() {
+    if (!http) return;
+    // The pool runs nothing but our jobs, so every in-flight path beyond
+    // its thread count is waiting in its queue
+    const int active = qMin(int(inFlight.size()), pool.maxThreadCount());
+    http->setQueueDepth(int(inFlight.size()) - active, active);
+}
@@ -0,0 +1,94 @@
+#ifndef WATCHERDAEMON_H
+#define WATCHERDAEMON_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+#include "Allowlist.h"
+#include "FsWatcher.h"
+#include "FileAnalyzer.h"
+#include "RuleSet.h"
+#include "SimilarityIndex.h"
+
+class FileFeed;
+class FeedHttpServer;
+class QFileSystemWatcher;
+class QTimer;
+
+// Wires the filesystem watcher to the analysis pool and the change feed.
+// Analysis runs on a fixed-size thread pool, so CPU use is capped at
+// `workers` cores however fast files arrive. Writes to one path are
+// coalesced: a burst within `coalesceMs` becomes one analysis, a write
+// while the analysis is still queued rides along with it, and a write
+// while it runs cancels it and starts over. The detection rules are
+// recompiled when their file changes; each analysis keeps the set it
+// started with, and a set that fails to compile leaves the old one in use.
+class WatcherDaemon : public QObject {
+    Q_OBJECT
+public:
+    struct Options {
+        QString watchedDir;
+        FsWatcher::Backend backend = FsWatcher::Inotify;
+        int workers = 0; // 0 = one per core
+        int coalesceMs = 100; // quiet time after a write before analysing; 0 = none
+        QString allowlistPath; // known-good hashes (tools/AllowlistBuilder); empty = none
+        QString rulesPath;     // detection rules (NativeAnalysis/RuleSet.h)
+    };
+
+    WatcherDaemon(const Options &options, FileFeed *feed, QObject *parent = nullptr);
+    ~WatcherDaemon() override; // stops the pool first: its jobs use this, the rules and the allowlist
+
+    bool start();
+    void attach(FeedHttpServer *server); // adds daemon state to /api/status and the queue depth to /api/events
+
+private slots:
+    void onFilesDetected(const QStringList &paths);
+    void onFilesWritten(const QStringList &paths);
+    void onOverflow();
+    void onCoalesceTimeout();
+    void reloadRules();
+
+private:
+    struct Job {
+        std::atomic<bool> started{false};
+        std::atomic<bool> cancel{false};
+    };
+
+    void coalesce(const QString &path);
+    void schedule(const QString &path);
+    void onAnalyzed(const QString &path, const FileAnalysis &result);
+    QJsonArray similarTo(int id, const QJsonObject &details); // then indexes this record
+    void publishQueueDepth();
+    bool loadRules();
+
+    Options options;
+    FileFeed *feed;
+    FsWatcher *watcher;
+    FeedHttpServer *http;
+    QThreadPool pool;
+    QHash<QString, std::shared_ptr<Job>> inFlight; // queued or running
+    QSet<QString> dirty;                           // written again while running
+    QHash<QString, qint64> settling;               // path -> when its window closes
+    QElapsedTimer clock;
+    QTimer *coalesceTimer;
+    quint64 merged;    // writes folded into a pending analysis
+    quint64 cancelled; // running analyses dropped for a newer write
+    SimilarityIndex similarity; // record ids by similarity digest
+    Allowlist allowlist;        // read-only once start() opened it
+    std::shared_ptr<const RuleSet> rules; // swapped on reload; workers hold their own reference
+    QFileSystemWatcher *rulesWatcher;
+    QTimer *rulesTimer; // debounces the editor's burst of change signals
+    QString rulesError;   // last failed reload
+    QString rulesLoadedAt;
+    int rulesReloads;
+};
+
+#endif // WATCHERDAEMON_H
@@ -0,0 +1,31 @@
+# Native replacement for ExecutableMonitor/server.py's watchdog loop.
+# Linux only (inotify / fanotify).
+QT = core network
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+TARGET = secureguard-watcherd
+TEMPLATE = app
+
+include(../NativeAnalysis/NativeAnalysis.pri)
+
+SOURCES += \
+    main.cpp \
+    WatcherDaemon.cpp \
+    FsWatcher.cpp \
+    FileFeed.cpp \
+    FileAnalyzer.cpp \
+    FeedHttpServer.cpp
+
+HEADERS += \
+    WatcherDaemon.h \
+    FsWatcher.h \
+    FileFeed.h \
+    FileAnalyzer.h \
+    FeedHttpServer.h \
+    ../ExecFeedKeys.h
+
+# The default rules, next to the binary, where --rules looks for them
+rules.files = ../ExecutableMonitor/rules/default.rules
+rules.path = $$OUT_PWD/rules
+COPIES += rules
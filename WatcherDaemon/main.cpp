@@ -0,0 +1,62 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFileInfo>
+#include <QHostAddress>
+#include <QDebug>
+#include "WatcherDaemon.h"
+#include "FileFeed.h"
+#include "FeedHttpServer.h"
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("secureguard-watcherd");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("SecureGuard file watcher daemon. Serves the same /api/files, "
+                                     "/api/events and /api/status endpoints as ExecutableMonitor/server.py.");
+    parser.addHelpOption();
+    QCommandLineOption dirOption({"d", "dir"}, "Directory to monitor (recursively).", "path",
+                                 QDir::homePath() + "/Downloads");
+    QCommandLineOption hostOption("host", "Address to listen on.", "address", "0.0.0.0");
+    QCommandLineOption portOption({"p", "port"}, "Port to listen on.", "port", "5000");
+    QCommandLineOption workersOption({"j", "workers"}, "Analysis threads (default: one per core).", "count", "0");
+    QCommandLineOption coalesceOption("coalesce-ms", "Quiet time after a write before analysing (0 = none).", "ms", "100");
+    QCommandLineOption fanotifyOption("fanotify", "Use fanotify (needs CAP_SYS_ADMIN); falls back to inotify.");
+    QCommandLineOption allowlistOption("allowlist", "Known-good SHA-256 list built by AllowlistBuilder; "
+                                       "listed files are not analysed.", "file");
+    QCommandLineOption rulesOption("rules", "Detection rules; reloaded when the file changes.", "file",
+                                   QCoreApplication::applicationDirPath() + "/rules/default.rules");
+    QCommandLineOption historyRecordsOption("history-records", "File records kept; the oldest go first.", "count",
+                                            QString::number(FileFeed::kDefaultMaxRecords));
+    QCommandLineOption historyDaysOption("history-days", "Days file records are kept.", "days",
+                                         QString::number(FileFeed::kDefaultMaxDays));
+    parser.addOptions({dirOption, hostOption, portOption, workersOption, coalesceOption, fanotifyOption,
+                       allowlistOption, rulesOption, historyRecordsOption, historyDaysOption});
+    parser.process(app);
+
+    WatcherDaemon::Options options;
+    options.watchedDir = QDir(parser.value(dirOption)).absolutePath();
+    options.workers = parser.value(workersOption).toInt();
+    options.coalesceMs = parser.value(coalesceOption).toInt();
+    options.backend = parser.isSet(fanotifyOption) ? FsWatcher::Fanotify : FsWatcher::Inotify;
+    options.allowlistPath = parser.value(allowlistOption);
+    options.rulesPath = QFileInfo(parser.value(rulesOption)).absoluteFilePath();
+
+    FileFeed feed;
+    feed.setRetention(parser.value(historyRecordsOption).toInt(), parser.value(historyDaysOption).toInt());
+    FeedHttpServer http(&feed);
+    WatcherDaemon daemon(options, &feed);
+    daemon.attach(&http);
+
+    const quint16 port = quint16(parser.value(portOption).toUInt());
+    if (!http.listen(QHostAddress(parser.value(hostOption)), port)) {
+        qCritical().noquote() << "Cannot listen on port" << port << ":" << http.errorString();
+        return 1;
+    }
+    if (!daemon.start()) {
+        qCritical().noquote() << "Cannot start watching" << options.watchedDir;
+        return 1;
+    }
+    return app.exec();
+}
@@ -0,0 +1,16 @@
+# Open time and lookup latency of NativeAnalysis/Allowlist
+TEMPLATE = app
+CONFIG -= qt app_bundle
+CONFIG += console c++17 release
+
+TARGET = AllowlistBench
+INCLUDEPATH += ../../NativeAnalysis
+
+SOURCES += \
+    main.cpp \
+    ../../NativeAnalysis/Allowlist.cpp \
+    ../../NativeAnalysis/MappedFile.cpp
+
+HEADERS += \
+    ../../NativeAnalysis/Allowlist.h \
+    ../../NativeAnalysis/MappedFile.h
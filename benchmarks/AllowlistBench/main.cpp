@@ -0,0 +1,145 @@
+// Usage: AllowlistBench [--entries N] [--lookups N] [--bits N] [--keep PATH]
+//
+// Builds an allowlist of --entries (default 10,000,000) random SHA-256
+// hashes in a temporary file (or PATH with --keep, reused if it exists),
+// then reports the time to open it and the latency of --lookups (default
+// 10,000,000) lookups of unknown hashes and of listed ones, plus the Bloom
+// filter's false-positive rate.
+
+#include "Allowlist.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+volatile size_t sink = 0;
+
+uint64_t rngState = 0x9e3779b97f4a7c15ull;
+
+uint64_t nextRandom() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return rngState;
+}
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void randomKey(uint8_t *key) {
+    for (size_t i = 0; i < Allowlist::kKeyBytes; i += 8) {
+        const uint64_t r = nextRandom();
+        memcpy(key + i, &r, 8);
+    }
+}
+
+// The listed keys are the first `entries` outputs of a separately seeded
+// generator, so they can be replayed without being kept in memory
+void listedKey(size_t i, uint8_t *key) {
+    uint64_t state = 0x2545f4914f6cdd1dull + i * 0x9e3779b97f4a7c15ull;
+    for (size_t b = 0; b < Allowlist::kKeyBytes; b += 8) {
+        state ^= state >> 33;
+        state *= 0xff51afd7ed558ccdull;
+        state ^= state >> 29;
+        memcpy(key + b, &state, 8);
+    }
+}
+
+bool writeInput(const std::string &path, size_t entries) {
+    FILE *f = fopen(path.c_str(), "w");
+    if (!f) return false;
+    static const char digits[] = "0123456789abcdef";
+    uint8_t key[Allowlist::kKeyBytes];
+    char line[2 * Allowlist::kKeyBytes + 1];
+    line[2 * Allowlist::kKeyBytes] = '\n';
+    for (size_t i = 0; i < entries; ++i) {
+        listedKey(i, key);
+        for (size_t b = 0; b < Allowlist::kKeyBytes; ++b) {
+            line[2 * b] = digits[key[b] >> 4];
+            line[2 * b + 1] = digits[key[b] & 15];
+        }
+        fwrite(line, 1, sizeof(line), f);
+    }
+    return fclose(f) == 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t entries = 10000000;
+    size_t lookups = 10000000;
+    Allowlist::BuildOptions options;
+    std::string keep;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--entries") == 0) entries = size_t(atoll(argv[i + 1]));
+        else if (strcmp(argv[i], "--lookups") == 0) lookups = size_t(atoll(argv[i + 1]));
+        else if (strcmp(argv[i], "--bits") == 0) options.bitsPerKey = unsigned(atoi(argv[i + 1]));
+        else if (strcmp(argv[i], "--keep") == 0) keep = argv[i + 1];
+    }
+    const std::string path = keep.empty() ? "AllowlistBench.allowlist" : keep;
+
+    Allowlist list;
+    std::string error;
+    if (keep.empty() || !list.open(path)) {
+        const std::string input = path + ".txt";
+        if (!writeInput(input, entries)) {
+            fprintf(stderr, "cannot write %s\n", input.c_str());
+            return 1;
+        }
+        const Clock::time_point start = Clock::now();
+        if (Allowlist::build({input}, path, options, &error) < 0) {
+            fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        printf("build: %zu hashes in %.2f s\n", entries, secondsSince(start));
+        remove(input.c_str());
+        list.close();
+    }
+
+    Clock::time_point start = Clock::now();
+    if (!list.open(path, &error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    const double openSeconds = secondsSince(start);
+    Allowlist::Stats stats = list.stats();
+    entries = size_t(stats.entries);
+    printf("open: %.1f us for %zu hashes (%.1f MB filter)\n", openSeconds * 1e6, entries, stats.bloomBytes / 1e6);
+
+    // Unknown hashes, generated up front so the loop times lookups alone
+    std::vector<uint8_t> probes(std::min<size_t>(lookups, 1 << 20) * Allowlist::kKeyBytes);
+    for (size_t i = 0; i < probes.size(); i += Allowlist::kKeyBytes) randomKey(&probes[i]);
+    const size_t probeCount = probes.size() / Allowlist::kKeyBytes;
+    start = Clock::now();
+    size_t found = 0;
+    for (size_t i = 0; i < lookups; ++i) found += list.contains(&probes[(i % probeCount) * Allowlist::kKeyBytes]);
+    const double missSeconds = secondsSince(start);
+    stats = list.stats();
+    printf("unknown: %.1f ns per lookup, %.3f%% passed the filter, %zu found\n", missSeconds * 1e9 / lookups,
+           100.0 * double(stats.lookups - stats.bloomRejects) / double(stats.lookups), found);
+
+    std::vector<uint8_t> listed(std::min(probeCount, entries) * Allowlist::kKeyBytes);
+    for (size_t i = 0; i < listed.size(); i += Allowlist::kKeyBytes) {
+        listedKey(size_t(nextRandom() % entries), &listed[i]);
+    }
+    const size_t listedCount = listed.size() / Allowlist::kKeyBytes;
+    start = Clock::now();
+    found = 0;
+    for (size_t i = 0; listedCount && i < lookups; ++i) {
+        found += list.contains(&listed[(i % listedCount) * Allowlist::kKeyBytes]);
+    }
+    const double hitSeconds = secondsSince(start);
+    printf("listed: %.1f ns per lookup, %zu of %zu found\n", hitSeconds * 1e9 / lookups, found, lookups);
+    sink = found;
+
+    if (keep.empty()) remove(path.c_str());
+    return found == (listedCount ? lookups : 0) ? 0 : 1;
+}
@@ -0,0 +1,20 @@
+# Time of DetectedFilesFilter::setQuery (index lookup plus proxy
+# invalidation) over a large detected-files model
+QT += core
+QT -= gui
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = FilterBench
+TEMPLATE = app
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../DetectedFilesModel.cpp \
+    ../../ExecSearchIndex.cpp
+
+HEADERS += \
+    ../../DetectedFilesModel.h \
+    ../../ExecSearchIndex.h
@@ -0,0 +1,78 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QTextStream>
+#include "DetectedFilesModel.h"
+
+// Usage: FilterBench [rows] [repeat]
+// Fills a DetectedFilesModel with rows files shaped like the backend's and
+// times DetectedFilesFilter::setQuery, as the filter box calls it, for
+// short and long queries: the whole call, and the index lookup alone (the
+// rest is the proxy's invalidation). Each is the best of `repeat` runs,
+// starting from an empty query. Exits 1 if any takes 16 ms or more.
+
+static ExecFileRow makeRow(int id) {
+    const QString name = QString("setup_%1.exe").arg(id, 7, 10, QChar('0'));
+    QJsonObject details;
+    details["created_at"] = "2025-01-01T12:00:00";
+    details["ext"] = id % 5 == 0 ? ".dll" : ".exe";
+    details["hash"] = QString("%1").arg(quint64(id) * 0x9E3779B97F4A7C15ull, 16, 16, QChar('0')).repeated(4);
+    QJsonObject obj;
+    obj["id"] = id;
+    obj["seq"] = id;
+    obj["name"] = name;
+    obj["path"] = QString("/home/user/Downloads/batch%1/").arg(id % 100) + name;
+    obj["type"] = id % 7 == 0 ? "suspicious" : "safe";
+    obj["details"] = details;
+    return ExecFileRow::fromRecord(obj);
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    const QStringList args = app.arguments();
+    const int rows = args.size() > 1 ? qMax(1, args.at(1).toInt()) : 100000;
+    const int repeat = args.size() > 2 ? qMax(1, args.at(2).toInt()) : 5;
+
+    DetectedFilesModel model;
+    QList<ExecFileRow> batch;
+    batch.reserve(rows);
+    for (int id = 1; id <= rows; ++id) batch.append(makeRow(id));
+    model.upsertRows(batch);
+    DetectedFilesFilter filter;
+    filter.setFilesModel(&model);
+
+    const QStringList queries = {
+        "e",                              // one character: straight scan
+        "se",                             // two characters: straight scan
+        "dll",                            // short, a fifth of the rows
+        "setup_00",                       // matches most rows
+        "batch42/",                       // a hundredth of the rows
+        "setup_0042424",                  // one row
+        "/home/user/downloads/batch7/setup_0000007.exe", // long, one row
+        "no-such-file",                   // no rows
+    };
+    double worst = 0;
+    for (const QString &query : queries) {
+        qint64 best = -1, bestIndex = -1;
+        for (int i = 0; i < repeat; ++i) {
+            filter.setQuery(QString());
+            QElapsedTimer t;
+            t.start();
+            filter.setQuery(query);
+            const qint64 ns = t.nsecsElapsed();
+            if (best < 0 || ns < best) best = ns;
+
+            t.restart();
+            model.searchIndex().search(ExecSearchIndex::fold(query));
+            const qint64 indexNs = t.nsecsElapsed();
+            if (bestIndex < 0 || indexNs < bestIndex) bestIndex = indexNs;
+        }
+        worst = qMax(worst, best / 1e6);
+        out << QString("%1").arg('"' + query + '"', -48) << QString::number(filter.rowCount()).rightJustified(7)
+            << " shown  setQuery " << QString::number(best / 1e6, 'f', 2).rightJustified(7) << " ms  (index "
+            << QString::number(bestIndex / 1e6, 'f', 2) << " ms)\n";
+    }
+    out << rows << " rows, worst setQuery " << QString::number(worst, 'f', 2) << " ms (frame: 16 ms)\n";
+    return worst < 16 ? 0 : 1;
+}
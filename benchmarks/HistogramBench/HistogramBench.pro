@@ -0,0 +1,14 @@
+# Throughput of the NativeAnalysis byte-histogram kernels, 1 MB - 2 GB
+TEMPLATE = app
+CONFIG -= qt app_bundle
+CONFIG += console c++17 release
+
+TARGET = HistogramBench
+INCLUDEPATH += ../../NativeAnalysis
+
+SOURCES += \
+    main.cpp \
+    ../../NativeAnalysis/ByteHistogram.cpp
+
+HEADERS += \
+    ../../NativeAnalysis/ByteHistogram.h
@@ -0,0 +1,121 @@
+// Usage: HistogramBench [--max-mb N] [--min-total-mb N]
+//
+// Reports GB/s of each histogram kernel the CPU supports, plus a naive
+// single-table loop for reference and the sliding entropy profile, on
+// random, text-like and zero-padded inputs from 1 MB up to --max-mb
+// (default 2048).
+
+#include "ByteHistogram.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace {
+
+uint64_t rngState = 0x9e3779b97f4a7c15ull;
+
+uint64_t nextRandom() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return rngState;
+}
+
+enum Shape { Random, Text, Padded };
+const char *shapeName(Shape s) {
+    return s == Random ? "random" : s == Text ? "text" : "padded";
+}
+
+void fill(std::vector<uint8_t> &buf, Shape shape) {
+    static const char alphabet[] = "etaoin shrdlu ETAOIN\n0123456789";
+    for (size_t i = 0; i < buf.size(); i += 8) {
+        const uint64_t r = nextRandom();
+        for (size_t j = 0; j < 8 && i + j < buf.size(); ++j) {
+            const uint8_t byte = uint8_t(r >> (8 * j));
+            switch (shape) {
+            case Random: buf[i + j] = byte; break;
+            case Text: buf[i + j] = uint8_t(alphabet[byte % (sizeof(alphabet) - 1)]); break;
+            // Executable-like: 4 KiB pages alternating code-ish bytes and zero padding
+            case Padded: buf[i + j] = ((i >> 12) & 1) ? 0 : byte; break;
+            }
+        }
+    }
+}
+
+void naiveHistogram(const uint8_t *data, size_t len, uint64_t counts[256]) {
+    for (size_t i = 0; i < len; ++i) ++counts[data[i]];
+}
+
+// Best-of-N GB/s, with enough repetitions to process at least minTotal bytes
+double measure(size_t len, size_t minTotal, const std::function<void()> &run) {
+    const int reps = int(minTotal / len) + 1;
+    double best = 0;
+    for (int r = 0; r < reps; ++r) {
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const double gbs = double(len) / s / 1e9;
+        if (gbs > best) best = gbs;
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t maxMb = 2048;
+    size_t minTotalMb = 512;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--max-mb") == 0) maxMb = size_t(atoll(argv[i + 1]));
+        else if (strcmp(argv[i], "--min-total-mb") == 0) minTotalMb = size_t(atoll(argv[i + 1]));
+    }
+
+    const ByteHistogram::Kernel kernels[] = {ByteHistogram::Scalar, ByteHistogram::Sse2, ByteHistogram::Avx2};
+    printf("dispatch picks: %s\n", ByteHistogram::kernelName(ByteHistogram::bestKernel()));
+    printf("%-8s %10s %9s", "input", "size", "naive");
+    for (ByteHistogram::Kernel k : kernels) {
+        if (ByteHistogram::kernelSupported(k)) printf(" %9s", ByteHistogram::kernelName(k));
+    }
+    printf(" %9s   (GB/s)\n", "profile");
+
+    volatile uint64_t sink = 0; // keeps the work observable
+    for (size_t mb = 1; mb <= maxMb; mb *= 4) {
+        const size_t len = mb << 20;
+        std::vector<uint8_t> buf;
+        try {
+            buf.resize(len);
+        } catch (const std::bad_alloc &) {
+            printf("%zu MB: out of memory, stopping\n", mb);
+            break;
+        }
+        for (Shape shape : {Random, Text, Padded}) {
+            fill(buf, shape);
+            const size_t minTotal = minTotalMb << 20;
+            printf("%-8s %7zu MB", shapeName(shape), mb);
+
+            printf(" %9.2f", measure(len, minTotal, [&] {
+                uint64_t counts[256] = {};
+                naiveHistogram(buf.data(), len, counts);
+                sink = sink + counts[0];
+            }));
+            for (ByteHistogram::Kernel k : kernels) {
+                if (!ByteHistogram::kernelSupported(k)) continue;
+                printf(" %9.2f", measure(len, minTotal, [&] {
+                    uint64_t counts[256] = {};
+                    ByteHistogram::accumulate(k, buf.data(), len, counts);
+                    sink = sink + counts[0];
+                }));
+            }
+            // 4 KiB windows every 1 KiB, as a packer/section locator would use
+            printf(" %9.2f\n", measure(len, minTotal, [&] {
+                sink = sink + ByteHistogram::entropyProfile(buf.data(), len, 4096, 1024).size();
+            }));
+            fflush(stdout);
+        }
+        if (mb < maxMb && mb * 4 > maxMb) mb = maxMb / 4; // always finish on maxMb
+    }
+    return 0;
+}
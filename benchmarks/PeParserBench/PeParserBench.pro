@@ -0,0 +1,21 @@
+# Throughput of NativeAnalysis/PeParser over a directory of PE files
+TEMPLATE = app
+CONFIG -= qt app_bundle
+CONFIG += console c++17 release
+
+TARGET = PeParserBench
+INCLUDEPATH += ../../NativeAnalysis
+
+SOURCES += \
+    main.cpp \
+    ../../NativeAnalysis/ByteHistogram.cpp \
+    ../../NativeAnalysis/MappedFile.cpp \
+    ../../NativeAnalysis/Md5.cpp \
+    ../../NativeAnalysis/PeParser.cpp
+
+HEADERS += \
+    ../../NativeAnalysis/ByteHistogram.h \
+    ../../NativeAnalysis/JsonText.h \
+    ../../NativeAnalysis/MappedFile.h \
+    ../../NativeAnalysis/Md5.h \
+    ../../NativeAnalysis/PeParser.h
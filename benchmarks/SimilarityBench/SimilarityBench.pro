@@ -0,0 +1,17 @@
+# SimilarityDigest throughput and SimilarityIndex top-k latency / recall
+TEMPLATE = app
+CONFIG -= qt app_bundle
+CONFIG += console c++17 release
+
+TARGET = SimilarityBench
+INCLUDEPATH += ../../NativeAnalysis
+
+SOURCES += \
+    main.cpp \
+    ../../NativeAnalysis/SimilarityDigest.cpp \
+    ../../NativeAnalysis/SimilarityIndex.cpp
+
+HEADERS += \
+    ../../NativeAnalysis/HexEncode.h \
+    ../../NativeAnalysis/SimilarityDigest.h \
+    ../../NativeAnalysis/SimilarityIndex.h
@@ -0,0 +1,118 @@
+// Usage: SimilarityBench [--entries N] [--queries N] [--k N] [--max-distance N]
+//
+// Reports SimilarityDigest throughput on random data, then fills a
+// SimilarityIndex with --entries (default 1,000,000) synthetic digests in
+// families of ten close variants and times --queries top-k lookups for new
+// variants of known families. Recall is checked against a brute-force scan
+// for the first 200 queries: "exact" counts results equal to the true top-k.
+
+#include "SimilarityDigest.h"
+#include "SimilarityIndex.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t rngState = 0x9e3779b97f4a7c15ull;
+
+uint64_t nextRandom() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return rngState;
+}
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+SimilarityDigest::Digest randomDigest() {
+    SimilarityDigest::Digest d;
+    for (uint8_t &b : d.bytes) b = uint8_t(nextRandom());
+    return d;
+}
+
+// A variant: up to maxChanges body codes moved to another quartile
+SimilarityDigest::Digest variant(const SimilarityDigest::Digest &base, int maxChanges) {
+    SimilarityDigest::Digest d = base;
+    const int changes = int(nextRandom() % uint64_t(maxChanges + 1));
+    for (int i = 0; i < changes; ++i) {
+        const size_t byte = 3 + size_t(nextRandom() % SimilarityDigest::kBodyBytes);
+        const int shift = 2 * int(nextRandom() % 4);
+        d.bytes[byte] = uint8_t((d.bytes[byte] & ~(3 << shift)) | ((nextRandom() & 3) << shift));
+    }
+    return d;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t entries = 1000000;
+    size_t queries = 1000;
+    size_t k = 5;
+    int maxDistance = 100;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--entries") == 0) entries = size_t(atoll(argv[i + 1]));
+        else if (strcmp(argv[i], "--queries") == 0) queries = size_t(atoll(argv[i + 1]));
+        else if (strcmp(argv[i], "--k") == 0) k = size_t(atoll(argv[i + 1]));
+        else if (strcmp(argv[i], "--max-distance") == 0) maxDistance = atoi(argv[i + 1]);
+    }
+
+    {
+        std::vector<uint8_t> buf(64 << 20);
+        for (uint8_t &b : buf) b = uint8_t(nextRandom());
+        const Clock::time_point start = Clock::now();
+        SimilarityDigest digest;
+        digest.update(buf.data(), buf.size());
+        const bool ok = !digest.hexDigest().empty();
+        printf("digest: %.0f MB/s%s\n", 64 / secondsSince(start), ok ? "" : " (no digest)");
+    }
+
+    const size_t familySize = 10;
+    std::vector<SimilarityDigest::Digest> families(std::max<size_t>(1, entries / familySize));
+    for (SimilarityDigest::Digest &f : families) f = randomDigest();
+    std::vector<SimilarityDigest::Digest> stored;
+    stored.reserve(entries);
+    for (size_t i = 0; i < entries; ++i) stored.push_back(variant(families[i % families.size()], 12));
+
+    SimilarityIndex index(entries);
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < entries; ++i) index.add(stored[i], int64_t(i));
+    const double addSeconds = secondsSince(start);
+    printf("index: %zu entries in %.2f s (%.0f adds/s)\n", entries, addSeconds, entries / addSeconds);
+
+    std::vector<double> latencies;
+    size_t found = 0, exact = 0, expected = 0;
+    for (size_t q = 0; q < queries; ++q) {
+        const SimilarityDigest::Digest probe = variant(families[nextRandom() % families.size()], 12);
+        start = Clock::now();
+        const std::vector<SimilarityIndex::Match> matches = index.query(probe, k, maxDistance);
+        latencies.push_back(secondsSince(start) * 1000);
+        found += matches.size();
+
+        if (q < 200) {
+            std::vector<int> truth;
+            for (const SimilarityDigest::Digest &d : stored) {
+                const int distance = SimilarityDigest::distance(probe, d);
+                if (distance <= maxDistance) truth.push_back(distance);
+            }
+            std::sort(truth.begin(), truth.end());
+            truth.resize(std::min(truth.size(), k));
+            expected += truth.size();
+            for (size_t i = 0; i < matches.size() && i < truth.size(); ++i) exact += matches[i].distance == truth[i];
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&](double p) { return latencies[size_t(p * (latencies.size() - 1))]; };
+    printf("query top-%zu within %d: p50 %.3f ms, p99 %.3f ms, max %.3f ms, %.1f matches per query\n", k, maxDistance,
+           percentile(0.5), percentile(0.99), latencies.back(), double(found) / queries);
+    printf("recall vs brute force: %zu of %zu exact (%.1f%%)\n", exact, expected,
+           expected ? 100.0 * exact / expected : 100.0);
+    return 0;
+}
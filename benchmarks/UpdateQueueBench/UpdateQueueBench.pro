@@ -0,0 +1,25 @@
+# Applies a large burst of file events through ExecUpdateQueue into the
+# table model and checks the worst GUI-thread slice against the budget
+QT += core concurrent
+QT -= gui
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = UpdateQueueBench
+TEMPLATE = app
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../ExecUpdateQueue.cpp \
+    ../../ExecFeedCodec.cpp \
+    ../../DetectedFilesModel.cpp \
+    ../../ExecSearchIndex.cpp
+
+HEADERS += \
+    ../../ExecUpdateQueue.h \
+    ../../ExecFeedCodec.h \
+    ../../ExecFeedKeys.h \
+    ../../DetectedFilesModel.h \
+    ../../ExecSearchIndex.h
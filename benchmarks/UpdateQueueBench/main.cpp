@@ -0,0 +1,73 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QTimer>
+#include "ExecUpdateQueue.h"
+#include "DetectedFilesModel.h"
+
+// Usage: UpdateQueueBench [rows] [per-read]
+// Feeds rows file events in batches of per-read payloads, as ExecEventStream
+// emits them, all at once. Rows go through a filtered model like the
+// Executable Monitor table's. Exits 1 if any GUI slice took more than twice
+// ExecUpdateQueue::kSliceBudgetMs, the threshold it warns at.
+
+static QByteArray record(int id) {
+    const QString name = QString("setup_%1.exe").arg(id, 7, 10, QChar('0'));
+    QJsonObject details;
+    details["created_at"] = "2025-01-01T12:00:00";
+    details["ext"] = ".exe";
+    details["hash"] = QString("%1").arg(quint64(id) * 0x9E3779B97F4A7C15ull, 64, 16, QChar('0'));
+    details["size"] = "1.25 MB";
+    details["rule"] = "File is a application/x-dosexec file. Safe based on initial checks.";
+    QJsonObject obj;
+    obj["id"] = id;
+    obj["seq"] = id;
+    obj["name"] = name;
+    obj["path"] = "/home/user/Downloads/" + name;
+    obj["type"] = id % 7 == 0 ? "suspicious" : "safe";
+    obj["details"] = details;
+    return QJsonDocument(obj).toJson(QJsonDocument::Compact);
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    const QStringList args = app.arguments();
+    const int rows = args.size() > 1 ? qMax(1, args.at(1).toInt()) : 100000;
+    const int perRead = args.size() > 2 ? qMax(1, args.at(2).toInt()) : 500;
+
+    DetectedFilesModel model;
+    DetectedFilesFilter filter;
+    filter.setFilesModel(&model);
+    filter.setQuery("setup_00"); // filtered, so inserts also go through the proxy
+
+    ExecUpdateQueue queue;
+    qsizetype applied = 0;
+    QObject::connect(&queue, &ExecUpdateQueue::rowsReady, &model, [&](const QList<ExecFileRow> &batch) {
+        model.upsertRows(batch);
+        applied += batch.size();
+        if (applied >= rows) app.quit();
+    });
+
+    QList<QList<QByteArray>> reads;
+    for (int id = 1; id <= rows; id += perRead) {
+        QList<QByteArray> payloads;
+        for (int i = id; i < id + perRead && i <= rows; ++i) payloads.append(record(i));
+        reads.append(payloads);
+    }
+
+    QElapsedTimer total;
+    QTimer::singleShot(0, &app, [&] {
+        total.start();
+        for (const QList<QByteArray> &payloads : std::as_const(reads)) queue.enqueue(payloads);
+    });
+    app.exec();
+
+    const qint64 worst = queue.worstSliceMs();
+    out << rows << " rows in " << reads.size() << " reads applied in " << total.elapsed() << " ms, "
+        << filter.rowCount() << " shown\n";
+    out << "worst GUI slice " << worst << " ms (budget " << ExecUpdateQueue::kSliceBudgetMs << " ms)\n";
+    return worst > ExecUpdateQueue::kSliceBudgetMs * 2 ? 1 : 0;
+}
@@ -0,0 +1,22 @@
+# Times the GUI's /api/files decoders on bodies dumped by
+# benchmarks/wire_format_bench.py --dump DIR
+QT += core
+QT -= gui
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = WireFormatBench
+TEMPLATE = app
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../ExecFeedCodec.cpp \
+    ../../DetectedFilesModel.cpp \
+    ../../ExecSearchIndex.cpp
+
+HEADERS += \
+    ../../ExecFeedCodec.h \
+    ../../DetectedFilesModel.h \
+    ../../ExecSearchIndex.h
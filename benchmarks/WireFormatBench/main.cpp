@@ -0,0 +1,58 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QDir>
+#include <QTextStream>
+#include <functional>
+#include "ExecFeedCodec.h"
+
+// Usage: WireFormatBench DIR [repeat]
+// DIR holds files.json and files.cbor from wire_format_bench.py --dump
+
+static QByteArray readBody(const QString &path) {
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return QByteArray();
+    return f.readAll();
+}
+
+// Best wall time of `repeat` runs, in milliseconds
+static double bestOf(int repeat, const std::function<qsizetype()> &decode, qsizetype *rows) {
+    qint64 best = -1;
+    for (int i = 0; i < repeat; ++i) {
+        QElapsedTimer t;
+        t.start();
+        *rows = decode();
+        const qint64 ns = t.nsecsElapsed();
+        if (best < 0 || ns < best) best = ns;
+    }
+    return best / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    const QStringList args = app.arguments();
+    if (args.size() < 2) {
+        out << "usage: WireFormatBench DIR [repeat]\n";
+        return 2;
+    }
+    const QDir dir(args.at(1));
+    const int repeat = args.size() > 2 ? qMax(1, args.at(2).toInt()) : 5;
+
+    const QByteArray json = readBody(dir.filePath("files.json"));
+    const QByteArray cbor = readBody(dir.filePath("files.cbor"));
+    if (json.isEmpty() || cbor.isEmpty()) {
+        out << "missing files.json / files.cbor in " << dir.path() << "\n";
+        return 1;
+    }
+
+    qsizetype jsonRows = 0, cborRows = 0;
+    const double jsonMs = bestOf(repeat, [&] { return ExecFeedCodec::decodeJsonSnapshot(json).size(); }, &jsonRows);
+    const double cborMs = bestOf(repeat, [&] { return ExecFeedCodec::decodeCborSnapshot(cbor).size(); }, &cborRows);
+
+    out << "json : " << json.size() << " bytes, " << jsonRows << " rows, "
+        << QString::number(jsonMs, 'f', 1) << " ms (QJsonDocument)\n";
+    out << "cbor : " << cbor.size() << " bytes, " << cborRows << " rows, "
+        << QString::number(cborMs, 'f', 1) << " ms (QCborStreamReader)\n";
+    return jsonRows == cborRows ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+"""Startup and query times of the persistent history (history.py).
+
+Fills a scratch database with N file records shaped like server.py's
+(once; reused while --records matches), then times what a restart does:
+opening FileHistory, the GUI's first page, a catch-up and a record lookup.
+Opening is meant to stay well under 100 ms at a million records.
+
+    python benchmarks/history_bench.py --records 1000000 --db /tmp/history_bench.sqlite
+"""
+import argparse
+import json
+import os
+import random
+import sys
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'ExecutableMonitor'))
+import scan_store  # noqa: E402
+from history import FileHistory, summary_details  # noqa: E402
+
+
+def make_details(rng):
+    return {
+        'size': f"{rng.uniform(0.1, 50):.2f} MB",
+        'ext': '.exe',
+        'mime': 'application/x-dosexec',
+        'hash': '%064x' % rng.getrandbits(256),
+        'entropy': str(round(rng.uniform(3.0, 8.0), 4)),
+        'created_at': '2025-01-01T12:00:00',
+        'suspicious_strings': rng.sample(['cmd.exe', 'powershell', 'keylogger', 'CreateRemoteThread'], 2),
+        'rule': "File is a application/x-dosexec file. Safe based on initial checks.",
+        'gemini': "Gemini AI analysis not available.",
+    }
+
+
+def fill(path, records):
+    db = scan_store.connect(path)
+    have = db.execute("SELECT count(*) FROM files").fetchone()[0]
+    if have == records:
+        return
+    db.execute("DELETE FROM files")
+    rng = random.Random(1)
+    now = time.time()
+    db.execute("BEGIN")
+    for i in range(records):
+        name = f"setup_{i:07d}.exe"
+        details = make_details(rng)
+        db.execute("INSERT INTO files (seq, path, name, name_key, type, hash, added, summary, details) "
+                   "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)",
+                   (i + 1, f"/home/user/Downloads/{name}", name, name.lower(),
+                    rng.choice(['safe', 'suspicious', 'error']), details['hash'], now - (records - i) * 0.1,
+                    json.dumps(summary_details(details)), json.dumps(details)))
+    db.execute("COMMIT")
+    db.close()
+
+
+def timed(label, fn):
+    start = time.perf_counter()
+    result = fn()
+    print(f"{label:<28} {(time.perf_counter() - start) * 1000:8.2f} ms")
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--records', type=int, default=1000000)
+    parser.add_argument('--db', default='/tmp/history_bench.sqlite')
+    args = parser.parse_args()
+
+    start = time.perf_counter()
+    fill(args.db, args.records)
+    print(f"{args.records} records in {args.db} ({time.perf_counter() - start:.1f} s to prepare)")
+
+    history = timed("open", lambda: FileHistory(args.db, max_records=args.records + 1, max_days=3650))
+    page = timed("first page (200 summaries)", lambda: history.page(200))
+    timed("next page", lambda: history.page(200, page['next']))
+    timed("page by name", lambda: history.page(200, sort='name'))
+    timed("catch-up (1000 changes)", lambda: history.since(history.cursor - 1000, 1000))
+    timed("get by id", lambda: history.get(args.records // 2))
+    timed("find by path", lambda: history.find(f"/home/user/Downloads/setup_{args.records // 3:07d}.exe"))
+    timed("count (first stats)", history.stats)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,73 @@
+"""Load test of the LLM queue (llm_queue.py) against the mock backend.
+
+Submits N requests from several producer threads, as the cpu stage would,
+and reports how long they took against the rate limit, how many were
+deferred because the queue was full, plus the queue's
+counters (retries, timeouts, time spent throttled, and with --stream the
+time to the first chunk). Offline: no key, no network, no quota.
+
+    python benchmarks/llm_queue_bench.py --requests 200 --rate 600 --latency 0.2 --errors 0.1
+"""
+import argparse
+import os
+import sys
+import threading
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'ExecutableMonitor'))
+import llm_queue  # noqa: E402
+from llm_queue import LlmQueue, MockBackend  # noqa: E402
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--requests', type=int, default=200)
+    parser.add_argument('--producers', type=int, default=4)
+    parser.add_argument('--workers', type=int, default=8)
+    parser.add_argument('--rate', type=float, default=600, help="calls per minute")
+    parser.add_argument('--burst', type=int, default=5)
+    parser.add_argument('--latency', type=float, default=0.2, help="mock seconds per call")
+    parser.add_argument('--errors', type=float, default=0.0, help="mock failure rate")
+    parser.add_argument('--timeout', type=float, default=30.0)
+    parser.add_argument('--retries', type=int, default=2)
+    parser.add_argument('--capacity', type=int, default=256, help="waiting requests before more are deferred")
+    parser.add_argument('--backoff', type=float, default=0.05, help="seconds before the first retry")
+    parser.add_argument('--stream', action='store_true', help="stream answers (reports mean_first_chunk)")
+    args = parser.parse_args()
+
+    llm_queue.BACKOFF = args.backoff
+    queue = LlmQueue(MockBackend(args.latency, args.errors), concurrency=args.workers, rate=args.rate,
+                     burst=args.burst, timeout=args.timeout, retries=args.retries, capacity=args.capacity)
+    finished = threading.Semaphore(0)
+    answered = []
+    deferred = []
+
+    def done(text, error):
+        answered.append(text is not None)
+        finished.release()
+
+    def produce(first):
+        for i in range(first, args.requests, args.producers):
+            if not queue.submit(f"file {i}", done, progress=(lambda text: None) if args.stream else None):
+                deferred.append(i)
+                finished.release()
+
+    start = time.perf_counter()
+    producers = [threading.Thread(target=produce, args=(p,)) for p in range(args.producers)]
+    for producer in producers:
+        producer.start()
+    for _ in range(args.requests):
+        finished.acquire()
+    elapsed = time.perf_counter() - start
+
+    # The bucket allows burst calls at once, then rate per minute
+    floor = max(0.0, (args.requests - args.burst) * 60.0 / args.rate)
+    print(f"{args.requests} requests in {elapsed:.2f} s "
+          f"({args.requests / elapsed:.1f}/s; rate limit alone needs >= {floor:.2f} s)")
+    print(f"answered {sum(answered)}, gave up on {len(answered) - sum(answered)}, deferred {len(deferred)}")
+    for key, value in queue.stats().items():
+        print(f"  {key:<18} {value}")
+
+
+if __name__ == '__main__':
+    main()
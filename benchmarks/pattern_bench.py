@@ -0,0 +1,153 @@
+"""Time the detection pattern scan and extract_file_features' keyword
+search, old loops against the one-pass matchers, on real binaries.
+
+Verdict: the first hit of any SUSPICIOUS_PATTERNS, as rule_engine's
+built-in Suspicious_Content check needs.
+All hits: every (pattern, offset), as the native matcher reports them.
+Keywords: first string containing each suspicious keyword.
+
+    python benchmarks/pattern_bench.py /usr/bin --max-files 200
+    python benchmarks/pattern_bench.py C:\\Windows\\System32 --max-mb 5
+
+Set SECUREGUARD_NATIVE_LIB to time a library outside NativeAnalysis/.
+"""
+import argparse
+import bisect
+import os
+import re
+import sys
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'ExecutableMonitor'))
+from native_features import NATIVE_AVAILABLE, native_matcher  # noqa: E402
+from rule_engine import SUSPICIOUS_PATTERNS  # noqa: E402
+
+KEYWORDS = [
+    "cmd.exe", "powershell", "http://", "https://",
+    "system32", "regedit", "taskkill", "netstat",
+    "password", "admin", "administrator", "root",
+    "exec", "eval", "execute", "shell", "spawn",
+    "download", "upload", "inject", "payload",
+    "malware", "virus", "trojan", "backdoor",
+    "keylogger", "ransomware", "botnet", "cryptocurrency",
+]
+STRING_PATTERN = re.compile(rb'[\x20-\x7E]{4,}')
+
+
+def collect(paths, max_files, max_bytes):
+    files = []
+    for root in paths:
+        entries = [root] if os.path.isfile(root) else sorted(
+            os.path.join(d, n) for d, _, names in os.walk(root) for n in names)
+        for path in entries:
+            if len(files) >= max_files:
+                return files
+            try:
+                if os.path.isfile(path) and not os.path.islink(path) and 0 < os.path.getsize(path) < max_bytes:
+                    with open(path, 'rb') as f:
+                        files.append((path, f.read()))
+            except OSError:
+                pass
+    return files
+
+
+def timed(fn, items, repeat):
+    best = float('inf')
+    for _ in range(repeat):
+        start = time.perf_counter()
+        results = [fn(item) for item in items]
+        best = min(best, time.perf_counter() - start)
+    return best, results
+
+
+def old_verdict(content):
+    for pattern in SUSPICIOUS_PATTERNS:
+        if re.search(pattern, content, re.IGNORECASE):
+            return True
+    return False
+
+
+def old_hits(content):
+    hits = []
+    for i, pattern in enumerate(SUSPICIOUS_PATTERNS):
+        hits.extend((i, m.start()) for m in re.finditer(b'(?=' + pattern + b')', content, re.IGNORECASE))
+    return sorted(hits, key=lambda hit: (hit[1], hit[0]))
+
+
+def old_keywords(strings):
+    found = []
+    for keyword in KEYWORDS:
+        for string in strings:
+            if keyword.lower() in string.lower():
+                found.append(f"{keyword}: {string}")
+                break
+    return found
+
+
+def joined_keywords(strings):
+    joined = "\n".join(strings).lower()
+    starts, position = [], 0
+    for string in strings:
+        starts.append(position)
+        position += len(string) + 1
+    found = []
+    for keyword in KEYWORDS:
+        at = joined.find(keyword)
+        if at >= 0:
+            found.append(f"{keyword}: {strings[bisect.bisect_right(starts, at) - 1]}")
+    return found
+
+
+def main():
+    default = [os.path.join(os.environ.get('SystemRoot', r'C:\Windows'), 'System32')] \
+        if sys.platform == 'win32' else ['/usr/bin']
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('paths', nargs='*', default=default)
+    parser.add_argument('--max-files', type=int, default=200)
+    parser.add_argument('--max-mb', type=float, default=5, help="skip larger files")
+    parser.add_argument('--repeat', type=int, default=3)
+    args = parser.parse_args()
+
+    files = collect(args.paths, args.max_files, int(args.max_mb * 1024 * 1024))
+    if not files:
+        sys.exit("no files to scan")
+    contents = [content for _, content in files]
+    total_mb = sum(map(len, contents)) / (1024 * 1024)
+    print(f"{len(files)} files, {total_mb:.1f} MB; native library: {'yes' if NATIVE_AVAILABLE else 'no'}")
+
+    def report(label, seconds, baseline):
+        print(f"  {label:<26} {seconds * 1000:9.1f} ms {total_mb / seconds:8.1f} MB/s {baseline / seconds:7.1f}x")
+
+    combined = re.compile(b'|'.join(SUSPICIOUS_PATTERNS), re.IGNORECASE)
+    native = native_matcher(SUSPICIOUS_PATTERNS)
+
+    print("verdict (first hit)")
+    base, expected = timed(old_verdict, contents, args.repeat)
+    report("per-pattern re.search", base, base)
+    t, got = timed(lambda c: combined.search(c) is not None, contents, args.repeat)
+    assert got == expected, "combined regex disagrees"
+    report("one alternation", t, base)
+    if native:
+        t, got = timed(lambda c: bool(native.scan(c, first_only=True)), contents, args.repeat)
+        assert got == expected, "native matcher disagrees"
+        report("native automaton", t, base)
+
+    print("all hits with offsets")
+    base, expected = timed(old_hits, contents, args.repeat)
+    report("per-pattern re.finditer", base, base)
+    if native:
+        t, got = timed(lambda c: sorted(native.scan(c), key=lambda hit: (hit[1], hit[0])), contents, args.repeat)
+        assert got == expected, "native matcher disagrees"
+        report("native automaton", t, base)
+
+    print("suspicious keywords over extracted strings")
+    strings = [[s.decode('ascii') for s in STRING_PATTERN.findall(c)[:100]] for c in contents]
+    base, expected = timed(old_keywords, strings, args.repeat)
+    report("keyword x string loop", base, base)
+    t, got = timed(joined_keywords, strings, args.repeat)
+    assert got == expected, "joined search disagrees"
+    report("joined-text find", t, base)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,136 @@
+"""Scan latency of URL feature extraction (URL/feature_extr.py).
+
+Times FeatureExtraction over N URLs and reports p50/p95/p99 against the
+2 s target, next to how often each lookup missed its deadline (each miss
+makes that lookup's features neutral). Offline by default: the network
+lookups are replaced by stubs with heavy-tailed (log-normal) latency that
+give up at the timeout they are passed, as the real libraries do, except
+--hang of them, which ignore it like a lookup that cannot be interrupted.
+--live scans the given URLs for real. Needs the URL app's dependencies
+(bs4, whois, googlesearch; dnspython for DNS with a timeout).
+
+    python benchmarks/url_features_bench.py --scans 200 --hang 0.05
+    python benchmarks/url_features_bench.py --live https://example.com https://python.org
+"""
+import argparse
+import math
+import os
+import random
+import socket
+import sys
+import threading
+import time
+from collections import Counter
+from datetime import datetime
+from types import SimpleNamespace
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'URL'))
+import feature_extr  # noqa: E402
+from feature_extr import FeatureExtraction  # noqa: E402
+
+PAGE = """<html><head><link rel="icon" href="/favicon.ico"></head><body>
+<a href="/about">About</a><a href="https://other.example/">Other</a>
+<img src="/logo.png"><script src="/app.js"></script><form action="/login"></form>
+</body></html>"""
+
+
+def stub_lookups(median, hang, rng):
+    lock = threading.Lock()
+
+    def wait(timeout):
+        with lock:
+            hangs = rng.random() < hang
+            delay = rng.lognormvariate(math.log(median), 1.0)
+        if hangs:
+            time.sleep(30.0)
+        elif delay > timeout:
+            time.sleep(timeout)
+            raise socket.timeout("stub timed out")
+        else:
+            time.sleep(delay)
+
+    def page(url, timeout):
+        wait(timeout)
+        return SimpleNamespace(url=url, text=PAGE, history=[])
+
+    def whois_record(domain, timeout):
+        wait(timeout)
+        return SimpleNamespace(domain_name=domain, creation_date=datetime(2010, 1, 1),
+                               expiration_date=datetime(2030, 1, 1))
+
+    def dns(domain, timeout):
+        wait(timeout)
+        return '93.184.216.34'
+
+    def rank(domain, timeout):
+        wait(timeout)
+        return SimpleNamespace(text="Global Rank: 1234")
+
+    def traffic(url, timeout):
+        wait(timeout)
+        return b"<ALEXA><SD><REACH RANK=\"1234\"/></SD></ALEXA>"
+
+    return {'page': page, 'whois': whois_record, 'dns': dns, 'rank': rank, 'traffic': traffic}
+
+
+def percentile(values, p):
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(math.ceil(p / 100 * len(ordered))) - 1)]
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--scans', type=int, default=200)
+    parser.add_argument('--concurrency', type=int, default=4, help="scans at once")
+    parser.add_argument('--median', type=float, default=0.3, help="stub seconds per lookup (median)")
+    parser.add_argument('--hang', type=float, default=0.02, help="share of stub lookups that hang")
+    parser.add_argument('--live', nargs='*', metavar='URL', help="scan these URLs over the network")
+    args = parser.parse_args()
+
+    if args.live:
+        urls = args.live
+    else:
+        feature_extr.LOOKUPS.update(stub_lookups(args.median, args.hang, random.Random(1)))
+        urls = [f"https://site{i}.example/login?id={i}" for i in range(args.scans)]
+
+    latencies = []
+    timed_out = Counter()
+    lock = threading.Lock()
+    pending = iter(urls)
+
+    def scan():
+        while True:
+            with lock:
+                url = next(pending, None)
+            if url is None:
+                return
+            start = time.perf_counter()
+            extraction = FeatureExtraction(url)
+            elapsed = time.perf_counter() - start
+            with lock:
+                latencies.append(elapsed)
+                timed_out.update(extraction.timed_out)
+
+    start = time.perf_counter()
+    workers = [threading.Thread(target=scan) for _ in range(args.concurrency)]
+    for worker in workers:
+        worker.start()
+    for worker in workers:
+        worker.join()
+    elapsed = time.perf_counter() - start
+
+    print(f"{len(latencies)} scans in {elapsed:.2f} s, {args.concurrency} at once")
+    for p in (50, 95, 99):
+        print(f"  p{p:<3} {percentile(latencies, p) * 1000:8.1f} ms")
+    print(f"  max  {max(latencies) * 1000:8.1f} ms (target p99 < 2000 ms)")
+    scans = len(latencies)
+    lookups = scans * len(feature_extr.LOOKUPS)
+    total = sum(timed_out.values())
+    print(f"lookups timed out: {total} of {lookups} ({100 * total / lookups:.1f}%)")
+    for name in feature_extr.LOOKUPS:
+        print(f"  {name:<8} {timed_out[name]:5d} of {scans} ({100 * timed_out[name] / scans:4.1f}%), "
+              f"deadline {feature_extr.DEADLINES[name]} s")
+
+
+if __name__ == '__main__':
+    main()
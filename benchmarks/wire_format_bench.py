@@ -0,0 +1,96 @@
+"""Compare JSON and compact CBOR bodies for the /api/files feed.
+
+Builds N synthetic file records shaped like server.py's, then reports the
+encoded size of each wire format and how long Python takes to decode it.
+Pass --dump DIR to write files.json / files.cbor for WireFormatBench (Qt).
+
+    python benchmarks/wire_format_bench.py --records 10000 --dump /tmp/wire
+"""
+import argparse
+import json
+import os
+import random
+import sys
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'ExecutableMonitor'))
+from wire_format import CBOR_AVAILABLE, compact  # noqa: E402
+
+if not CBOR_AVAILABLE:
+    sys.exit("cbor2 is not installed (pip install cbor2)")
+import cbor2  # noqa: E402
+
+
+def make_record(i, rng):
+    name = f"setup_{i:05d}.exe"
+    return {
+        'id': i + 1,
+        'seq': i + 1,
+        'name': name,
+        'path': f"C:\\Users\\user\\Downloads\\{name}",
+        'type': rng.choice(['safe', 'suspicious', 'error']),
+        'details': {
+            'size': rng.randint(10_000, 50_000_000),
+            'ext': '.exe',
+            'mime': 'application/x-dosexec',
+            'magic_type': 'PE32+ executable (GUI) x86-64, for MS Windows',
+            'hash': '%064x' % rng.getrandbits(256),
+            'entropy': round(rng.uniform(3.0, 8.0), 4),
+            'is_executable': True,
+            'has_digital_signature': rng.random() < 0.5,
+            'suspicious_strings': rng.sample(['cmd.exe', 'powershell', 'keylogger', 'CreateRemoteThread'], 2),
+            'file_header': '4d5a90000300000004000000ffff0000',
+            'created_at': '2025-01-01 12:00:00',
+            'modified_at': '2025-01-01 12:00:00',
+            'strings_count': rng.randint(0, 5000),
+            'suspicious_count': rng.randint(0, 20),
+            'pe_sections': ['.text', '.rdata', '.data', '.rsrc'],
+            'pe_timestamp': rng.randint(1_500_000_000, 1_700_000_000),
+            'is_dll': False,
+            'rule': 'Rule-based analysis: file appears safe',
+            'gemini': 'Safe: no malicious indicators found.',
+        },
+    }
+
+
+def best_of(fn, repeat):
+    best = float('inf')
+    for _ in range(repeat):
+        start = time.perf_counter()
+        fn()
+        best = min(best, time.perf_counter() - start)
+    return best
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--records', type=int, default=10000)
+    parser.add_argument('--repeat', type=int, default=5)
+    parser.add_argument('--dump', metavar='DIR', help='write files.json and files.cbor here')
+    args = parser.parse_args()
+
+    rng = random.Random(1234)
+    files = [make_record(i, rng) for i in range(args.records)]
+    # Same shapes /api/files?since=0 sends for each format
+    json_body = json.dumps({'epoch': 'bench', 'cursor': len(files), 'reset': True, 'files': files}).encode()
+    cbor_body = cbor2.dumps(compact(files))
+
+    json_s = best_of(lambda: json.loads(json_body), args.repeat)
+    cbor_s = best_of(lambda: cbor2.loads(cbor_body), args.repeat)
+
+    print(f"records: {args.records}")
+    print(f"json : {len(json_body):>10} bytes  decode {json_s * 1000:8.1f} ms")
+    print(f"cbor : {len(cbor_body):>10} bytes  decode {cbor_s * 1000:8.1f} ms")
+    print(f"cbor/json size: {len(cbor_body) / len(json_body):.2f}")
+
+    if args.dump:
+        os.makedirs(args.dump, exist_ok=True)
+        with open(os.path.join(args.dump, 'files.json'), 'wb') as f:
+            f.write(json_body)
+        with open(os.path.join(args.dump, 'files.cbor'), 'wb') as f:
+            f.write(cbor_body)
+        print(f"wrote bodies to {args.dump}")
+
+
+if __name__ == '__main__':
+    main()
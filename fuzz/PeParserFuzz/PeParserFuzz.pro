@@ -0,0 +1,32 @@
+# Fuzz harness for NativeAnalysis/PeParser, built with ASan and UBSan.
+#   qmake && make                  standalone mutator, any compiler
+#   qmake CONFIG+=libfuzzer && make  libFuzzer entry point, needs clang
+TEMPLATE = app
+CONFIG -= qt app_bundle
+CONFIG += console c++17 debug
+
+TARGET = PeParserFuzz
+INCLUDEPATH += ../../NativeAnalysis
+
+SANITIZERS = -fsanitize=address,undefined -fno-sanitize-recover=undefined -fno-omit-frame-pointer
+libfuzzer {
+    QMAKE_CC = clang
+    QMAKE_CXX = clang++
+    QMAKE_LINK = clang++
+    DEFINES += SG_LIBFUZZER
+    SANITIZERS = -fsanitize=fuzzer,address,undefined -fno-sanitize-recover=undefined -fno-omit-frame-pointer
+}
+QMAKE_CXXFLAGS += -O1 $$SANITIZERS
+QMAKE_LFLAGS += $$SANITIZERS
+
+SOURCES += \
+    main.cpp \
+    ../../NativeAnalysis/ByteHistogram.cpp \
+    ../../NativeAnalysis/Md5.cpp \
+    ../../NativeAnalysis/PeParser.cpp
+
+HEADERS += \
+    ../../NativeAnalysis/ByteHistogram.h \
+    ../../NativeAnalysis/JsonText.h \
+    ../../NativeAnalysis/Md5.h \
+    ../../NativeAnalysis/PeParser.h
@@ -0,0 +1,138 @@
+// Usage: PeParserFuzz [--iterations N] [--seed N] SEED_FILE...
+//
+// Feeds PeParser mutated copies of the seed files (real .exe / .dll files
+// work best) under ASan and UBSan. Every input is a heap buffer of exactly
+// its own size, so a read one byte past the image faults. Built with
+// CONFIG+=libfuzzer, only LLVMFuzzerTestOneInput is compiled and libFuzzer
+// drives it instead: ./PeParserFuzz corpus_dir/
+
+#include "PeParser.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace {
+
+// Whatever parse() returns, it must stay inside the buffer and toJson()
+// must terminate
+bool fuzzOne(const uint8_t *data, size_t size) {
+    PeImage pe;
+    if (!PeParser::parse(data, size, pe)) return false;
+
+    // Touch every view so ASan checks that it lies in the input
+    volatile unsigned sink = 0;
+    auto touch = [&](std::string_view s) {
+        for (char c : s) sink = sink + uint8_t(c);
+    };
+    for (const PeImage::Section &s : pe.sections) touch(s.name);
+    for (const PeImage::ImportModule &m : pe.imports) {
+        touch(m.dll);
+        for (const PeImage::Import &f : m.functions) touch(f.name);
+    }
+    touch(pe.exportName);
+    for (const PeImage::Export &e : pe.exports) touch(e.name);
+
+    sink = sink + unsigned(PeParser::toJson(pe).size()) + unsigned(PeParser::overlayPayload(pe));
+    return true;
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    fuzzOne(data, size);
+    return 0;
+}
+
+#ifndef SG_LIBFUZZER
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace {
+
+uint64_t rngState = 0x9e3779b97f4a7c15ull;
+
+uint64_t nextRandom() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return rngState;
+}
+
+bool readFile(const char *path, std::vector<uint8_t> &out) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    uint8_t buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) out.insert(out.end(), buffer, buffer + n);
+    fclose(f);
+    return true;
+}
+
+// Offsets, sizes and counts all live in the first pages, so most mutations
+// land there; values near the type limits break bounds arithmetic
+void mutate(std::vector<uint8_t> &buf) {
+    static const uint32_t interesting[] = {0, 1, 0x7f, 0x80, 0xff, 0x200, 0x1000, 0x7fff, 0x8000, 0xffff,
+                                           0x7fffffff, 0x80000000u, 0xfffffffe, 0xffffffff};
+    const int edits = 1 + int(nextRandom() % 8);
+    for (int i = 0; i < edits && !buf.empty(); ++i) {
+        const size_t span = (nextRandom() % 4) ? std::min<size_t>(buf.size(), 4096) : buf.size();
+        const size_t at = size_t(nextRandom() % span);
+        switch (nextRandom() % 5) {
+        case 0: buf[at] ^= uint8_t(1u << (nextRandom() % 8)); break;
+        case 1: buf[at] = uint8_t(nextRandom()); break;
+        case 2:
+        case 3:
+            if (at + 4 <= buf.size()) {
+                const uint32_t v = interesting[nextRandom() % (sizeof(interesting) / sizeof(interesting[0]))];
+                memcpy(buf.data() + at, &v, 4);
+            }
+            break;
+        case 4: buf.resize(at + 1); break; // truncate
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    long long iterations = 100000;
+    std::vector<std::vector<uint8_t>> seeds;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            rngState = strtoull(argv[++i], nullptr, 0) | 1;
+        } else {
+            std::vector<uint8_t> seed;
+            if (readFile(argv[i], seed)) seeds.push_back(std::move(seed));
+            else fprintf(stderr, "cannot read %s\n", argv[i]);
+        }
+    }
+    if (seeds.empty()) {
+        fprintf(stderr, "usage: %s [--iterations N] [--seed N] SEED_FILE...\n", argv[0]);
+        return 2;
+    }
+
+    long long valid = 0;
+    std::vector<uint8_t> work;
+    for (long long i = 0; i < iterations; ++i) {
+        work = seeds[size_t(nextRandom() % seeds.size())];
+        mutate(work);
+        // Exact-size copy: vector capacity would hide overreads from ASan
+        std::unique_ptr<uint8_t[]> input(new uint8_t[work.size() ? work.size() : 1]);
+        if (!work.empty()) memcpy(input.get(), work.data(), work.size());
+        valid += fuzzOne(input.get(), work.size());
+        if ((i + 1) % 10000 == 0) {
+            printf("%lld inputs, %lld parsed as PE\n", i + 1, valid);
+            fflush(stdout);
+        }
+    }
+    printf("done: %lld inputs, %lld parsed as PE, no faults\n", iterations, valid);
+    return 0;
+}
+
+#endif // SG_LIBFUZZER
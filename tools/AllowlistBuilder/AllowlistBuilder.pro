@@ -0,0 +1,16 @@
+# Builds the known-good hash file read by NativeAnalysis/Allowlist
+TEMPLATE = app
+CONFIG -= qt app_bundle
+CONFIG += console c++17 release
+
+TARGET = AllowlistBuilder
+INCLUDEPATH += ../../NativeAnalysis
+
+SOURCES += \
+    main.cpp \
+    ../../NativeAnalysis/Allowlist.cpp \
+    ../../NativeAnalysis/MappedFile.cpp
+
+HEADERS += \
+    ../../NativeAnalysis/Allowlist.h \
+    ../../NativeAnalysis/MappedFile.h
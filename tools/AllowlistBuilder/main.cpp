@@ -0,0 +1,54 @@
+// Usage: AllowlistBuilder [--bits N] [--run-keys N] [--temp DIR] -o OUTPUT INPUT...
+//
+// Writes an allowlist for NativeAnalysis/Allowlist from text files with one
+// SHA-256 per line (the first 64-hex-digit token on each line counts). For
+// the NSRL RDSv3 export the hashes first, e.g.
+//   sqlite3 RDS.db "SELECT DISTINCT sha256 FROM FILE" > nsrl.txt
+// --bits sets the Bloom filter size per hash (default 12, about 0.5% false
+// positives); --run-keys the hashes sorted in memory at a time (default
+// 16M, 512 MiB); --temp where the sorted runs go (default: next to OUTPUT).
+
+#include "Allowlist.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+int main(int argc, char *argv[]) {
+    Allowlist::BuildOptions options;
+    std::string output;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--bits") == 0 && hasValue) options.bitsPerKey = unsigned(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--run-keys") == 0 && hasValue) options.runKeys = size_t(atoll(argv[++i]));
+        else if (strcmp(argv[i], "--temp") == 0 && hasValue) options.tempDir = argv[++i];
+        else if (strcmp(argv[i], "-o") == 0 && hasValue) output = argv[++i];
+        else inputs.push_back(argv[i]);
+    }
+    if (output.empty() || inputs.empty()) {
+        fprintf(stderr, "usage: %s [--bits N] [--run-keys N] [--temp DIR] -o OUTPUT INPUT...\n", argv[0]);
+        return 2;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::string error;
+    const int64_t written = Allowlist::build(inputs, output, options, &error);
+    if (written < 0) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Allowlist list;
+    if (!list.open(output, &error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    const Allowlist::Stats stats = list.stats();
+    printf("%s: %lld hashes, %.1f MB filter, built in %.1f s\n", output.c_str(), (long long)written,
+           stats.bloomBytes / 1e6, seconds);
+    return 0;
+}